@@ -0,0 +1,181 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "caf/config.hpp"
+
+namespace caf::detail {
+
+/// An open-addressing hash map with linear probing that stores all entries in
+/// a single array. Lookups touch consecutive memory and never allocate.
+/// Erasing shifts subsequent entries back instead of leaving tombstones.
+///
+/// Pointers to values remain valid until the next `emplace` or `erase`.
+/// @pre `Key` and `Value` are default constructible and movable.
+template <class Key, class Value, class Hash = std::hash<Key>>
+class flat_hash_map {
+public:
+  // -- constants --------------------------------------------------------------
+
+  /// Number of slots in a map after the first insertion.
+  static constexpr size_t min_capacity = 16;
+
+  // -- properties -------------------------------------------------------------
+
+  bool empty() const noexcept {
+    return size_ == 0;
+  }
+
+  size_t size() const noexcept {
+    return size_;
+  }
+
+  /// Returns the number of slots. Always zero or a power of two.
+  size_t capacity() const noexcept {
+    return slots_.size();
+  }
+
+  // -- lookup -----------------------------------------------------------------
+
+  /// Returns a pointer to the value for `key` or `nullptr` if no such entry
+  /// exists.
+  Value* find(const Key& key) {
+    if (auto i = index_of(key); i != npos)
+      return &slots_[i].value;
+    return nullptr;
+  }
+
+  const Value* find(const Key& key) const {
+    if (auto i = index_of(key); i != npos)
+      return &slots_[i].value;
+    return nullptr;
+  }
+
+  bool contains(const Key& key) const {
+    return index_of(key) != npos;
+  }
+
+  // -- modifiers --------------------------------------------------------------
+
+  /// Inserts a new entry unless the map already contains `key`. Returns a
+  /// pointer to the value for `key` and whether the insertion took place.
+  std::pair<Value*, bool> emplace(Key key, Value value) {
+    if ((size_ + 1) * 4 > capacity() * 3)
+      grow();
+    auto mask = capacity() - 1;
+    for (auto i = home_of(key);; i = (i + 1) & mask) {
+      auto& x = slots_[i];
+      if (!x.used) {
+        x.used = true;
+        x.key = std::move(key);
+        x.value = std::move(value);
+        ++size_;
+        return {&x.value, true};
+      }
+      if (x.key == key)
+        return {&x.value, false};
+    }
+  }
+
+  /// Removes the entry for `key`. Returns whether the map contained `key`.
+  bool erase(const Key& key) {
+    auto i = index_of(key);
+    if (i == npos)
+      return false;
+    auto mask = capacity() - 1;
+    // Move entries back into the gap until reaching an empty slot or an entry
+    // that already sits at its home slot (or between its home and the gap).
+    for (auto j = (i + 1) & mask; slots_[j].used; j = (j + 1) & mask) {
+      auto home = home_of(slots_[j].key);
+      if (((j - home) & mask) >= ((j - i) & mask)) {
+        slots_[i] = std::move(slots_[j]);
+        i = j;
+      }
+    }
+    slots_[i] = slot{};
+    --size_;
+    return true;
+  }
+
+  void clear() {
+    slots_.clear();
+    size_ = 0;
+  }
+
+  // -- iteration --------------------------------------------------------------
+
+  /// Calls `f(key, value)` for each entry in unspecified order.
+  template <class F>
+  void for_each(F f) {
+    for (auto& x : slots_)
+      if (x.used)
+        f(x.key, x.value);
+  }
+
+private:
+  // -- member types -----------------------------------------------------------
+
+  struct slot {
+    bool used = false;
+    Key key;
+    Value value;
+  };
+
+  // -- constants --------------------------------------------------------------
+
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  // -- utility functions ------------------------------------------------------
+
+  /// Returns the preferred slot for `key`. Multiplies the hash with the golden
+  /// ratio to spread keys with poor hash values such as consecutive integers.
+  size_t home_of(const Key& key) const {
+    auto h = static_cast<uint64_t>(Hash{}(key)) * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(h >> shift_);
+  }
+
+  size_t index_of(const Key& key) const {
+    if (size_ == 0)
+      return npos;
+    auto mask = capacity() - 1;
+    for (auto i = home_of(key);; i = (i + 1) & mask) {
+      auto& x = slots_[i];
+      if (!x.used)
+        return npos;
+      if (x.key == key)
+        return i;
+    }
+  }
+
+  void grow() {
+    auto new_capacity = slots_.empty() ? min_capacity : capacity() * 2;
+    std::vector<slot> slots(new_capacity);
+    slots.swap(slots_);
+    size_ = 0;
+    shift_ = 64;
+    for (auto n = new_capacity; n > 1; n >>= 1)
+      --shift_;
+    for (auto& x : slots)
+      if (x.used)
+        emplace(std::move(x.key), std::move(x.value));
+  }
+
+  // -- member variables -------------------------------------------------------
+
+  std::vector<slot> slots_;
+
+  size_t size_ = 0;
+
+  /// Selects the upper bits of the hash value, i.e., `64 - log2(capacity)`.
+  int shift_ = 64;
+};
+
+} // namespace caf::detail
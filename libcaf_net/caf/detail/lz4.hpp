@@ -0,0 +1,71 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#pragma once
+
+#include "caf/byte.hpp"
+#include "caf/detail/net_export.hpp"
+#include "caf/fwd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace caf::detail {
+
+/// Implements the LZ4 block format with an optional dictionary. A dictionary
+/// is a prefix of the input that both sides know in advance, e.g., the most
+/// recent plaintext on a connection. Matches may refer into the dictionary,
+/// which enables compression of small messages that repeat previous traffic.
+struct CAF_NET_EXPORT lz4 {
+  // -- member types -----------------------------------------------------------
+
+  using binary_buffer = std::vector<byte>;
+
+  // -- constants --------------------------------------------------------------
+
+  /// Maximum distance of a match. Dictionaries beyond this size have no effect.
+  static constexpr size_t max_offset = 65535;
+
+  /// Minimum length of a match.
+  static constexpr size_t min_match = 4;
+
+  /// The last match must start at least this many Bytes before the end.
+  static constexpr size_t match_limit = 12;
+
+  /// The last sequence contains at least this many literals.
+  static constexpr size_t last_literals = 5;
+
+  /// Maximum number of Bytes that a single Byte of a valid block expands to.
+  /// Each additional length Byte of a match adds at most 255 Bytes.
+  static constexpr size_t max_ratio = 255;
+
+  // -- utility functions ------------------------------------------------------
+
+  /// Returns the maximum size of a compressed block for `input_size` Bytes.
+  static size_t compress_bound(size_t input_size) noexcept {
+    return input_size + input_size / 255 + 16;
+  }
+
+  /// Returns the maximum size of the output for a compressed block of
+  /// `input_size` Bytes.
+  static size_t decompress_bound(size_t input_size) noexcept {
+    return input_size * max_ratio;
+  }
+
+  /// Compresses `input` and appends the resulting block to `out`.
+  static void compress(span<const byte> dict, span<const byte> input,
+                       binary_buffer& out);
+
+  /// Decompresses the block in `input` and appends exactly `output_size` Bytes
+  /// to `out`.
+  /// @returns `false` if `input` is malformed or does not decompress to
+  ///          exactly `output_size` Bytes, `true` otherwise.
+  /// @note Rejects any `output_size` above `decompress_bound(input.size())`
+  ///       before allocating memory for the output.
+  static bool decompress(span<const byte> dict, span<const byte> input,
+                         size_t output_size, binary_buffer& out);
+};
+
+} // namespace caf::detail
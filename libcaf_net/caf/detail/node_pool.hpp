@@ -0,0 +1,183 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace caf::detail {
+
+/// Recycles memory blocks of `NodeSize` Bytes for short-lived objects that one
+/// thread allocates and another thread releases, e.g., queue elements.
+///
+/// Each thread keeps a local cache. Threads that release blocks pass them on
+/// to a global stash in batches of `batch_size` blocks and threads that run out
+/// of blocks take a whole batch from the stash. Hence, threads synchronize
+/// only once per `batch_size` operations. The stash keeps at most
+/// `max_stashed_batches` batches and returns surplus memory to the heap.
+///
+/// Objects with thread storage duration may allocate or release blocks after
+/// the thread destroyed its local cache. Such calls bypass the cache and use
+/// the heap directly.
+template <size_t NodeSize>
+class node_pool {
+public:
+  // -- constants --------------------------------------------------------------
+
+  static constexpr size_t batch_size = 64;
+
+  static constexpr size_t max_stashed_batches = 64;
+
+  // -- allocation -------------------------------------------------------------
+
+  /// Returns a memory block of `NodeSize` Bytes.
+  static void* allocate() {
+    if (auto cache = local()) {
+      if (auto result = cache->released.pop())
+        return result;
+      if (cache->reusable.empty())
+        cache->reusable = global().take();
+      if (auto result = cache->reusable.pop())
+        return result;
+    }
+    return ::operator new(node_size);
+  }
+
+  /// Releases a memory block that `allocate` returned.
+  static void deallocate(void* ptr) noexcept {
+    auto cache = local();
+    if (cache == nullptr) {
+      ::operator delete(ptr);
+      return;
+    }
+    cache->released.push(ptr);
+    if (cache->released.size == batch_size)
+      global().give(cache->released.release());
+  }
+
+private:
+  // -- member types -----------------------------------------------------------
+
+  struct node {
+    node* next;
+  };
+
+  static constexpr size_t node_size = std::max(NodeSize, sizeof(node));
+
+  /// A singly-linked list of free memory blocks.
+  struct batch {
+    node* head = nullptr;
+    size_t size = 0;
+
+    bool empty() const noexcept {
+      return head == nullptr;
+    }
+
+    void push(void* ptr) noexcept {
+      auto x = new (ptr) node;
+      x->next = head;
+      head = x;
+      ++size;
+    }
+
+    void* pop() noexcept {
+      if (head == nullptr)
+        return nullptr;
+      auto result = head;
+      head = head->next;
+      --size;
+      return result;
+    }
+
+    batch release() noexcept {
+      batch result = *this;
+      head = nullptr;
+      size = 0;
+      return result;
+    }
+
+    void clear() noexcept {
+      while (auto ptr = pop())
+        ::operator delete(ptr);
+    }
+  };
+
+  struct thread_cache {
+    /// Stores blocks released by this thread.
+    batch released;
+
+    /// Stores blocks taken from the global stash.
+    batch reusable;
+
+    ~thread_cache() {
+      destroyed() = true;
+      released.clear();
+      reusable.clear();
+    }
+  };
+
+  struct stash {
+    std::mutex mtx;
+    std::vector<batch> batches;
+
+    stash() {
+      // Allows `give` to run without allocating.
+      batches.reserve(max_stashed_batches);
+    }
+
+    batch take() {
+      std::unique_lock<std::mutex> guard{mtx};
+      if (batches.empty())
+        return {};
+      auto result = batches.back();
+      batches.pop_back();
+      return result;
+    }
+
+    void give(batch x) {
+      {
+        std::unique_lock<std::mutex> guard{mtx};
+        if (batches.size() < max_stashed_batches) {
+          batches.push_back(x);
+          return;
+        }
+      }
+      x.clear();
+    }
+
+    ~stash() {
+      for (auto& x : batches)
+        x.clear();
+    }
+  };
+
+  // -- utility functions ------------------------------------------------------
+
+  /// Returns the cache of the calling thread or `nullptr` if the thread
+  /// already destroyed its cache.
+  static thread_cache* local() noexcept {
+    if (destroyed())
+      return nullptr;
+    static thread_local thread_cache instance;
+    return &instance;
+  }
+
+  /// Signals whether the calling thread destroyed its cache. The flag has no
+  /// destructor and thus remains valid until the thread exits.
+  static bool& destroyed() noexcept {
+    static thread_local bool flag = false;
+    return flag;
+  }
+
+  static stash& global() {
+    static stash instance;
+    return instance;
+  }
+};
+
+} // namespace caf::detail
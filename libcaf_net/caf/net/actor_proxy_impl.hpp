@@ -6,6 +6,7 @@
 
 #include "caf/actor_proxy.hpp"
 #include "caf/net/endpoint_manager.hpp"
+#include "caf/net/stripe_set.hpp"
 
 namespace caf::net {
 
@@ -16,6 +17,11 @@ public:
 
   actor_proxy_impl(actor_config& cfg, endpoint_manager_ptr dst);
 
+  /// Spreads outgoing messages across multiple connections to the same node.
+  /// All messages from one sender to this proxy use the same connection (see
+  /// `stripe_set` for when messages may overtake each other).
+  actor_proxy_impl(actor_config& cfg, stripe_set_ptr dst);
+
   ~actor_proxy_impl() override;
 
   bool enqueue(mailbox_element_ptr what, execution_unit* context) override;
@@ -23,7 +29,11 @@ public:
   void kill_proxy(execution_unit* ctx, error rsn) override;
 
 private:
+  /// Stores the connection for a proxy without stripes.
   endpoint_manager_ptr dst_;
+
+  /// Stores all connections for a proxy with stripes.
+  stripe_set_ptr stripes_;
 };
 
 } // namespace caf::net
@@ -5,8 +5,11 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <mutex>
+#include <vector>
 
+#include "caf/callback.hpp"
 #include "caf/detail/net_export.hpp"
 #include "caf/error.hpp"
 #include "caf/expected.hpp"
@@ -17,17 +20,32 @@
 #include "caf/net/middleman_backend.hpp"
 #include "caf/net/multiplexer.hpp"
 #include "caf/net/stream_transport.hpp"
+#include "caf/net/stripe_set.hpp"
+#include "caf/net/tcp_connector.hpp"
 #include "caf/net/tcp_stream_socket.hpp"
 #include "caf/node_id.hpp"
 
 namespace caf::net::backend {
 
-/// Minimal backend for tcp communication.
+/// Minimal backend for tcp communication. Optionally stripes the traffic to
+/// each peer across multiple connections (see `caf.middleman.tcp-stripes`).
+///
+/// The peer table is copy-on-write: lookups load an immutable snapshot without
+/// locking, since peers come and go rarely compared to how often we look them
+/// up when creating proxies.
 class CAF_NET_EXPORT tcp : public middleman_backend {
 public:
-  using peer_map = std::map<node_id, endpoint_manager_ptr>;
+  using peer_map = std::map<node_id, stripe_set_ptr>;
 
-  using emplace_return_type = std::pair<peer_map::iterator, bool>;
+  using peer_map_ptr = std::shared_ptr<const peer_map>;
+
+  /// Receives the manager for a node once the backend connected to it or the
+  /// error of the failed connection attempt.
+  using pending_request
+    = unique_callback_ptr<void(const expected<endpoint_manager_ptr>&)>;
+
+  using pending_request_map
+    = std::map<node_id, std::vector<pending_request>>;
 
   // -- constructors, destructors, and assignment operators --------------------
 
@@ -41,10 +59,19 @@ public:
 
   void stop() override;
 
+  /// Returns the manager for the node of `locator`, connecting to it first if
+  /// necessary. Blocks the caller while connecting. The connection attempt
+  /// itself runs on the resolver threads and on the multiplexer. Hence, neither
+  /// of them may call this function.
   expected<endpoint_manager_ptr> get_or_connect(const uri& locator) override;
 
   endpoint_manager_ptr peer(const node_id& id) override;
 
+  /// Returns all connections to the peer `id` or `nullptr` if no such peer
+  /// exists. The first connection also carries control traffic such as
+  /// monitoring requests.
+  stripe_set_ptr stripes(const node_id& id);
+
   void resolve(const uri& locator, const actor& listener) override;
 
   strong_actor_ptr make_proxy(node_id nid, actor_id aid) override;
@@ -55,43 +82,132 @@ public:
 
   uint16_t port() const noexcept override;
 
+  /// Returns the configured number of connections per peer.
+  size_t num_stripes() const noexcept {
+    return num_stripes_;
+  }
+
+  /// Adds the first connection to a new peer. Closes `socket_handle` if the
+  /// peer already exists.
   template <class Handle>
   expected<endpoint_manager_ptr>
   emplace(const node_id& peer_id, Handle socket_handle) {
+    const std::lock_guard<std::mutex> lock(lock_);
+    if (peer_snapshot()->count(peer_id) > 0) {
+      close(socket_handle);
+      return make_error(sec::runtime_error, "peer_id already exists");
+    }
+    auto mgr = make_peer_manager(socket_handle);
+    if (!mgr)
+      return mgr.error();
+    update_peers([&](peer_map& peers) {
+      peers.emplace(peer_id,
+                    std::make_shared<stripe_set>(*mgr, num_stripes_));
+    });
+    return *mgr;
+  }
+
+  /// Adds an additional connection to an existing peer. Existing proxies for
+  /// the peer pick up the new connection immediately. Closes `socket_handle`
+  /// if the peer does not exist or already has all of its connections.
+  template <class Handle>
+  expected<endpoint_manager_ptr>
+  emplace_stripe(const node_id& peer_id, Handle socket_handle) {
+    const std::lock_guard<std::mutex> lock(lock_);
+    auto peers = peer_snapshot();
+    auto i = peers->find(peer_id);
+    if (i == peers->end()) {
+      close(socket_handle);
+      return make_error(sec::runtime_error, "unknown peer_id");
+    }
+    if (i->second->full()) {
+      close(socket_handle);
+      return make_error(sec::runtime_error, "all stripes in use");
+    }
+    auto mgr = make_peer_manager(socket_handle);
+    if (!mgr)
+      return mgr.error();
+    i->second->add(*mgr);
+    return *mgr;
+  }
+
+private:
+  /// Calls `f` with the manager for `id` if the peer exists. Otherwise, stores
+  /// `f` until the connection to `id` succeeds or fails and starts connecting
+  /// unless another request did so already.
+  void with_peer(const node_id& id, const uri::authority_type& auth,
+                 pending_request f);
+
+  /// Resolves the host of `auth` without blocking, connects to `id` on the
+  /// multiplexer, and calls all pending requests for this node once the
+  /// connection attempt completes.
+  void connect_async(const node_id& id, const uri::authority_type& auth);
+
+  /// Races connections to all `endpoints` of `id`.
+  void connect_async(const node_id& id, std::vector<ip_endpoint> endpoints);
+
+  /// Adds a connected socket to the peer table and calls all pending requests
+  /// for `id`. Runs on the multiplexer thread.
+  void connected(const node_id& id, std::vector<ip_endpoint> endpoints,
+                 expected<tcp_stream_socket> sock);
+
+  /// Creates a BASP manager for `socket_handle` without initializing it.
+  template <class Handle>
+  endpoint_manager_ptr new_peer_manager(Handle socket_handle) {
     using transport_type = stream_transport<basp::application>;
+    basp::application app{proxies_, &content_cache_};
+    return make_endpoint_manager(mm_.mpx(), mm_.system(),
+                                 transport_type{socket_handle, std::move(app)});
+  }
+
+  template <class Handle>
+  expected<endpoint_manager_ptr> make_peer_manager(Handle socket_handle) {
     if (auto err = nonblocking(socket_handle, true))
       return err;
-    auto mpx = mm_.mpx();
-    basp::application app{proxies_};
-    auto mgr = make_endpoint_manager(
-      mpx, mm_.system(), transport_type{socket_handle, std::move(app)});
+    auto mgr = new_peer_manager(socket_handle);
     if (auto err = mgr->init()) {
       CAF_LOG_ERROR("mgr->init() failed: " << err);
       return err;
     }
-    mpx->register_reading(mgr);
-    emplace_return_type res;
-    {
-      const std::lock_guard<std::mutex> lock(lock_);
-      res = peers_.emplace(peer_id, std::move(mgr));
-    }
-    if (res.second)
-      return res.first->second;
-    else
-      return make_error(sec::runtime_error, "peer_id already exists");
+    mm_.mpx().register_reading(mgr);
+    return mgr;
   }
 
-private:
   endpoint_manager_ptr get_peer(const node_id& id);
 
+  /// Returns the current state of the peer table.
+  peer_map_ptr peer_snapshot() const {
+    return std::atomic_load(&peers_);
+  }
+
+  /// Publishes a modified copy of the peer table.
+  /// @pre `lock_` is locked
+  template <class F>
+  void update_peers(F f) {
+    auto copy = std::make_shared<peer_map>(*peer_snapshot());
+    f(*copy);
+    std::atomic_store(&peers_, peer_map_ptr{std::move(copy)});
+  }
+
   middleman& mm_;
 
-  peer_map peers_;
+  /// Stores an immutable snapshot of all peers. Writers replace the snapshot
+  /// while holding `lock_`.
+  peer_map_ptr peers_;
+
+  /// Stores requests for nodes we are currently connecting to.
+  pending_request_map pending_requests_;
 
   proxy_registry proxies_;
 
+  basp::content_cache content_cache_;
+
   uint16_t listening_port_;
 
+  /// Configures how many connections we open to each peer.
+  size_t num_stripes_;
+
+  /// Serializes writers of `peers_` and guards `pending_requests_`.
   std::mutex lock_;
 };
 
@@ -7,6 +7,7 @@
 #include <map>
 
 #include "caf/detail/net_export.hpp"
+#include "caf/net/basp/content_cache.hpp"
 #include "caf/net/endpoint_manager.hpp"
 #include "caf/net/fwd.hpp"
 #include "caf/net/middleman_backend.hpp"
@@ -64,6 +65,8 @@ private:
   std::map<node_id, peer_entry> peers_;
 
   proxy_registry proxies_;
+
+  basp::content_cache content_cache_;
 };
 
 } // namespace caf::net::backend
@@ -4,14 +4,17 @@
 
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "caf/actor_addr.hpp"
+#include "caf/actor_control_block.hpp"
 #include "caf/actor_system.hpp"
 #include "caf/actor_system_config.hpp"
 #include "caf/byte.hpp"
@@ -19,22 +22,31 @@
 #include "caf/callback.hpp"
 #include "caf/defaults.hpp"
 #include "caf/detail/net_export.hpp"
-#include "caf/detail/worker_hub.hpp"
 #include "caf/error.hpp"
 #include "caf/fwd.hpp"
+#include "caf/net/basp/compact_envelope.hpp"
 #include "caf/net/basp/connection_state.hpp"
 #include "caf/net/basp/constants.hpp"
+#include "caf/net/basp/content_cache.hpp"
+#include "caf/net/basp/control_batch.hpp"
+#include "caf/net/basp/export_table.hpp"
+#include "caf/net/basp/features.hpp"
+#include "caf/net/basp/flow_control.hpp"
 #include "caf/net/basp/header.hpp"
-#include "caf/net/basp/message_queue.hpp"
+#include "caf/net/basp/heartbeat_monitor.hpp"
+#include "caf/net/basp/message_batch.hpp"
+#include "caf/net/basp/message_dispatcher.hpp"
 #include "caf/net/basp/message_type.hpp"
-#include "caf/net/basp/worker.hpp"
 #include "caf/net/endpoint_manager.hpp"
+#include "caf/net/network_socket.hpp"
 #include "caf/net/packet_writer.hpp"
 #include "caf/net/receive_policy.hpp"
 #include "caf/node_id.hpp"
 #include "caf/proxy_registry.hpp"
 #include "caf/response_promise.hpp"
 #include "caf/scoped_execution_unit.hpp"
+#include "caf/string_view.hpp"
+#include "caf/timespan.hpp"
 #include "caf/unit.hpp"
 
 namespace caf::net::basp {
@@ -44,13 +56,86 @@ class CAF_NET_EXPORT application {
 public:
   // -- member types -----------------------------------------------------------
 
-  using hub_type = detail::worker_hub<worker>;
-
   struct test_tag {};
 
+  /// Detaches the flow control from the endpoint manager before releasing it,
+  /// because delivered messages may outlive the application.
+  struct flow_control_deleter {
+    void operator()(flow_control* ptr) const noexcept {
+      ptr->detach();
+      ptr->deref();
+    }
+  };
+
+  // -- constants --------------------------------------------------------------
+
+  /// Names the handshake feature for `compact_actor_message` support.
+  static constexpr string_view compact_envelopes_feature
+    = basp::compact_envelopes_feature;
+
+  /// Names the handshake feature for `message_batch` support.
+  static constexpr string_view message_batches_feature
+    = basp::message_batches_feature;
+
+  /// Names the handshake feature for `monitor_batch` and `down_batch` support.
+  static constexpr string_view control_batches_feature
+    = basp::control_batches_feature;
+
+  /// Names the handshake feature for `compressed_message` support.
+  static constexpr string_view compression_feature = basp::compression_feature;
+
+  /// Estimated size of the envelope of an actor message for reserving buffer
+  /// space, i.e., a node ID, two actor IDs, and an empty forwarding stack.
+  static constexpr size_t envelope_size_hint = 64;
+
+  /// Default value for `caf.middleman.inline-deserialization-threshold`.
+  static constexpr size_t default_inline_deserialization_threshold = 256;
+
+  /// Default value for `caf.middleman.max-batch-size`.
+  static constexpr size_t default_max_batch_size = 32;
+
+  /// Default value for `caf.middleman.max-batch-bytes`.
+  static constexpr size_t default_max_batch_bytes = 64 * 1024;
+
+  /// Default value for `caf.middleman.compression.threshold`.
+  static constexpr size_t default_compression_threshold = 256;
+
+  /// Default value for `caf.middleman.compression.max-message-size`.
+  static constexpr size_t default_max_decompressed_size = INT32_MAX;
+
+  /// Size of the type and the size field that precede the compressed payload
+  /// of a `compressed_message`.
+  static constexpr size_t compressed_prefix_size = 1 + sizeof(uint32_t);
+
+  /// Default value for `caf.middleman.max-pending-messages`. Disables
+  /// read-side backpressure.
+  static constexpr size_t default_max_pending_messages = 0;
+
+  /// Tags the event for writing pending `monitor_batch` and `down_batch`
+  /// messages.
+  static constexpr string_view flush_control_tag = "basp-flush-control";
+
+  /// Tags the periodic event for sending heartbeats and detecting dead
+  /// connections.
+  static constexpr string_view heartbeat_tag = "basp-heartbeat";
+
+  /// Default value for `caf.middleman.heartbeat-interval`. Heartbeats are
+  /// disabled by default.
+  static constexpr timespan default_heartbeat_interval = timespan{0};
+
+  /// Default value for `caf.middleman.connection-timeout`. Takes effect only
+  /// if heartbeats are enabled.
+  static constexpr timespan default_connection_timeout
+    = std::chrono::seconds(60);
+
   // -- constructors, destructors, and assignment operators --------------------
 
-  explicit application(proxy_registry& proxies);
+  /// @param proxies Creates and stores proxies for remote actors.
+  /// @param cache Caches serialized message content for fan-out to multiple
+  ///              receivers. May be shared by all applications of a backend.
+  ///              Passing `nullptr` disables the cache.
+  explicit application(proxy_registry& proxies,
+                       content_cache* cache = nullptr);
 
   // -- static utility functions -----------------------------------------------
 
@@ -76,8 +161,41 @@ public:
       workers = *workers_cfg;
     else
       workers = std::min(3u, std::thread::hardware_concurrency() / 4u) + 1;
-    for (size_t i = 0; i < workers; ++i)
-      hub_->add_new_worker(*queue_, proxies_);
+    max_batch_size_ = get_or(system_->config(), "caf.middleman.max-batch-size",
+                             default_max_batch_size);
+    max_batch_bytes_ = get_or(system_->config(),
+                              "caf.middleman.max-batch-bytes",
+                              default_max_batch_bytes);
+    local_features_.compact_envelopes = get_or(
+      system_->config(), "caf.middleman.compact-envelopes", true);
+    local_features_.message_batches = max_batch_size_ > 1;
+    local_features_.control_batches = true;
+    local_features_.compression = get_or(
+      system_->config(), "caf.middleman.compression.enable", true);
+    compression_threshold_ = get_or(system_->config(),
+                                    "caf.middleman.compression.threshold",
+                                    default_compression_threshold);
+    max_decompressed_size_ = get_or(
+      system_->config(), "caf.middleman.compression.max-message-size",
+      default_max_decompressed_size);
+    auto max_pending = get_or(system_->config(),
+                              "caf.middleman.max-pending-messages",
+                              default_max_pending_messages);
+    if (max_pending > 0)
+      flow_control_.reset(new flow_control(make_resume_callback(),
+                                           max_pending, max_pending / 2));
+    auto threshold = get_or(system_->config(),
+                            "caf.middleman.inline-deserialization-threshold",
+                            default_inline_deserialization_threshold);
+    dispatcher_.reset(new message_dispatcher(proxies_, workers, threshold,
+                                             flow_control_.get()));
+    heartbeats_ = heartbeat_monitor{
+      get_or(system_->config(), "caf.middleman.heartbeat-interval",
+             default_heartbeat_interval),
+      get_or(system_->config(), "caf.middleman.connection-timeout",
+             default_connection_timeout)};
+    if (heartbeats_.enabled() && manager_ != nullptr)
+      manager_->set_timeout(heartbeats_.interval(), to_string(heartbeat_tag));
     // Write handshake.
     auto hdr = parent.next_header_buffer();
     auto payload = parent.next_payload_buffer();
@@ -99,21 +217,50 @@ public:
     static_assert(std::is_base_of<packet_writer, Parent>::value,
                   "parent must implement packet_writer");
     size_t next_read_size = header_size;
+    heartbeats_.received();
     if (auto err = handle(next_read_size, parent, bytes))
       return err;
+    if (flow_control_ != nullptr && flow_control_->pause()) {
+      CAF_LOG_DEBUG("too many pending messages, stop reading");
+      next_read_size_ = next_read_size;
+      parent.transport().configure_read(receive_policy::stop());
+      return none;
+    }
     parent.transport().configure_read(receive_policy::exactly(next_read_size));
     return none;
   }
 
   void resolve(packet_writer& writer, string_view path, const actor& listener);
 
-  static void new_proxy(packet_writer& writer, actor_id id);
+  /// Asks our peer to send a down message once the remote actor `id`
+  /// terminates. Sends multiple requests as single `monitor_batch` if
+  /// possible.
+  void new_proxy(packet_writer& writer, actor_id id);
 
+  /// Informs our peer that the local actor `id` terminated. Sends multiple
+  /// notifications as single `down_batch` if possible.
   void local_actor_down(packet_writer& writer, actor_id id, error reason);
 
   template <class Parent>
-  void timeout(Parent&, const std::string&, uint64_t) {
-    // nop
+  void timeout(Parent& parent, const std::string& tag, uint64_t) {
+    if (string_view{tag} == flow_control::resume_reading_tag) {
+      CAF_LOG_DEBUG("pending messages dropped below low watermark, resume");
+      parent.transport().configure_read(
+        receive_policy::exactly(next_read_size_));
+      parent.manager().register_reading();
+    } else if (string_view{tag} == flush_control_tag) {
+      flush_control_messages(parent);
+    } else if (string_view{tag} == heartbeat_tag) {
+      if (!heartbeat(parent)) {
+        // Closing the socket makes the transport fail on its next read event,
+        // which removes the manager from the multiplexer.
+        if constexpr (!std::is_base_of<test_tag, Parent>::value)
+          shutdown(parent.transport().handle());
+        return;
+      }
+      if (manager_ != nullptr)
+        manager_->set_timeout(heartbeats_.interval(), to_string(heartbeat_tag));
+    }
   }
 
   void handle_error(sec) {
@@ -130,6 +277,39 @@ public:
     return state_;
   }
 
+  /// Returns whether this application sends actor messages with compact
+  /// envelopes, i.e., whether both sides agreed on using them.
+  bool compact_envelopes() const noexcept {
+    return features_.compact_envelopes;
+  }
+
+  /// Returns the read-side flow control or `nullptr` if disabled.
+  flow_control* inbound_flow_control() const noexcept {
+    return flow_control_.get();
+  }
+
+  /// Returns whether this application packs pending actor messages into
+  /// batches, i.e., whether both sides agreed on using them.
+  bool message_batches() const noexcept {
+    return features_.message_batches;
+  }
+
+  /// Returns whether this application packs monitor requests and down
+  /// notifications into batches, i.e., whether both sides agreed on using
+  /// them.
+  bool control_batches() const noexcept {
+    return features_.control_batches;
+  }
+
+  /// Returns whether this application compresses large actor messages, i.e.,
+  /// whether both sides agreed on using compression.
+  bool compression() const noexcept {
+    return features_.compression;
+  }
+
+  /// Writes all pending monitor requests and down notifications.
+  void flush_control_messages(packet_writer& writer);
+
   actor_system& system() const noexcept {
     return *system_;
   }
@@ -146,6 +326,9 @@ private:
   error handle_actor_message(packet_writer& writer, header hdr,
                              byte_span payload);
 
+  error handle_message_batch(packet_writer& writer, header hdr,
+                             byte_span payload);
+
   error handle_resolve_request(packet_writer& writer, header rec_hdr,
                                byte_span received);
 
@@ -158,6 +341,66 @@ private:
   error handle_down_message(packet_writer& writer, header received_hdr,
                             byte_span received);
 
+  error handle_monitor_batch(packet_writer& writer, header received_hdr,
+                             byte_span received);
+
+  error handle_down_batch(packet_writer& writer, header received_hdr,
+                          byte_span received);
+
+  error handle_compressed_message(packet_writer& writer, header hdr,
+                                  byte_span payload);
+
+  /// Sends a down message for `aid` to our peer once the local actor `aid`
+  /// terminates or right away if no such actor exists.
+  void monitor_local_actor(packet_writer& writer, actor_id aid);
+
+  // -- heartbeats -------------------------------------------------------------
+
+  /// Sends a heartbeat if we did not send anything since the last call and
+  /// checks whether our peer is still alive. Returns `false` if the peer did
+  /// not send anything for `caf.middleman.connection-timeout`, after cleaning
+  /// up all proxies for the peer.
+  bool heartbeat(packet_writer& writer);
+
+  /// Kills all proxies for our peer and fails pending requests.
+  void connection_lost();
+
+  // -- handling of outgoing messages ------------------------------------------
+
+  /// Appends the payload of an actor message to `buf` and sets `type` to the
+  /// matching message type. Leaves the node table for compact envelopes
+  /// unchanged on error.
+  error serialize_actor_message(byte_buffer& buf,
+                                const endpoint_manager_queue::message& x,
+                                message_type& type);
+
+  /// Replaces the content of `buf` with its compressed form and sets `type` to
+  /// `compressed_message` if compression is enabled and pays off.
+  void compress_payload(message_type& type, byte_buffer& buf);
+
+  /// Adds a local actor to the registry unless we did so before, allowing our
+  /// peer to send messages to it.
+  void export_actor(const strong_actor_ptr& ptr);
+
+  /// Returns whether we may pack outgoing actor messages into batches.
+  bool batching_enabled() const noexcept {
+    return features_.message_batches && max_batch_size_ > 1
+           && manager_ != nullptr;
+  }
+
+  /// Returns whether we collect control messages until the next write event.
+  bool control_batching_enabled() const noexcept {
+    return features_.control_batches && manager_ != nullptr;
+  }
+
+  /// Makes sure that we write pending control messages on the next write
+  /// event.
+  void schedule_control_flush();
+
+  /// Returns a callback for the flow control that posts the event
+  /// `resume_reading_tag` to our endpoint manager.
+  flow_control::resume_callback make_resume_callback();
+
   /// Writes the handshake payload to `buf_`.
   error generate_handshake(byte_buffer& buf);
 
@@ -178,15 +421,63 @@ private:
   /// Tracks which local actors our peer monitors.
   std::unordered_set<actor_addr> monitored_actors_; // TODO: this is unused
 
+  /// Stores local actors that we have put into the registry on behalf of our
+  /// peer.
+  export_table exported_actors_;
+
   /// Caches actor handles obtained via `resolve`.
   std::unordered_map<uint64_t, actor> pending_resolves_;
 
+  /// Configures which optional features we announce to our peer.
+  features local_features_;
+
+  /// Stores the features both sides agreed on during the handshake.
+  features features_;
+
+  /// Configures how many actor messages we pack into a single batch at most.
+  /// Values below 2 disable batching.
+  size_t max_batch_size_ = default_max_batch_size;
+
+  /// Configures the payload size at which we stop adding actor messages to a
+  /// batch. Zero means unlimited.
+  size_t max_batch_bytes_ = default_max_batch_bytes;
+
+  /// Stores the messages of an incoming batch while handling them.
+  std::vector<batched_message> batch_buf_;
+
+  /// Configures the minimum payload size for compressing a message.
+  size_t compression_threshold_ = default_compression_threshold;
+
+  /// Configures the maximum size of a payload after decompressing.
+  size_t max_decompressed_size_ = default_max_decompressed_size;
+
+  /// Stores compressed payloads before swapping them with the payload buffer.
+  byte_buffer compression_buf_;
+
+  /// Stores decompressed payloads while handling them.
+  byte_buffer decompression_buf_;
+
+  /// Stores monitor requests and down notifications until the next flush.
+  control_batch control_batch_;
+
+  /// Maps node IDs to slots for compact envelopes of outgoing messages.
+  node_table outgoing_nodes_;
+
+  /// Maps slots to node IDs for compact envelopes of incoming messages.
+  node_table incoming_nodes_;
+
+  /// Stores how many bytes we need to read next after resuming.
+  size_t next_read_size_ = header_size;
+
   /// Ascending ID generator for requests to our peer.
   uint64_t next_request_id_ = 1;
 
   /// Points to the factory object for generating proxies.
   proxy_registry& proxies_;
 
+  /// Points to the shared cache for serialized message content (optional).
+  content_cache* content_cache_;
+
   /// Points to the endpoint manager that owns this applications.
   endpoint_manager* manager_ = nullptr;
 
@@ -194,9 +485,15 @@ private:
   /// serializers and deserializer.
   scoped_execution_unit executor_;
 
-  std::unique_ptr<message_queue> queue_;
+  /// Stops reading from the socket while local actors lag behind (optional).
+  std::unique_ptr<flow_control, flow_control_deleter> flow_control_;
+
+  /// Deserializes incoming actor messages in the I/O thread or in a worker.
+  /// Must go away before the flow control, since its workers point to it.
+  std::unique_ptr<message_dispatcher> dispatcher_;
 
-  std::unique_ptr<hub_type> hub_;
+  /// Decides when to send heartbeats and when to give up on our peer.
+  heartbeat_monitor heartbeats_;
 };
 
 } // namespace caf::net::basp
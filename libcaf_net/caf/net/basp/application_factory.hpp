@@ -17,7 +17,8 @@ class CAF_NET_EXPORT application_factory {
 public:
   using application_type = basp::application;
 
-  application_factory(proxy_registry& proxies) : proxies_(proxies) {
+  application_factory(proxy_registry& proxies, content_cache* cache = nullptr)
+    : proxies_(proxies), cache_(cache) {
     // nop
   }
 
@@ -27,11 +28,12 @@ public:
   }
 
   application_type make() const {
-    return application_type{proxies_};
+    return application_type{proxies_, cache_};
   }
 
 private:
   proxy_registry& proxies_;
+  content_cache* cache_;
 };
 
 } // namespace caf::net::basp
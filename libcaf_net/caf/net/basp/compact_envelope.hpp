@@ -0,0 +1,118 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "caf/detail/net_export.hpp"
+#include "caf/fwd.hpp"
+#include "caf/node_id.hpp"
+
+namespace caf::net::basp {
+
+/// @addtogroup BASP
+
+/// Caches recently used node IDs of a single connection for encoding
+/// `compact_actor_message` envelopes. Both ends of a connection store the same
+/// node IDs in the same slots: the sender assigns a slot when encountering a
+/// new node ID and transmits the slot index along with the node ID. Afterwards,
+/// both sides refer to the node ID by its slot index only.
+class CAF_NET_EXPORT node_table {
+public:
+  // -- constants --------------------------------------------------------------
+
+  /// Maximum number of cached node IDs per connection.
+  static constexpr size_t max_size = 16;
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  node_table();
+
+  // -- lookups ----------------------------------------------------------------
+
+  /// Returns the slot of `x` or `max_size` if `x` is not in the table.
+  size_t find(const node_id& x) const noexcept;
+
+  /// Returns the node ID at `slot` or `nullptr` if the slot is empty.
+  const node_id* get(size_t slot) const noexcept;
+
+  // -- modifiers --------------------------------------------------------------
+
+  /// Stores `x` in the next slot, evicting the least recently assigned entry
+  /// if the table is full.
+  /// @returns the slot for `x`.
+  size_t assign(node_id x);
+
+  /// Stores `x` in `slot`, as instructed by the peer.
+  /// @returns `false` if `slot >= max_size`, `true` otherwise.
+  bool store(size_t slot, node_id x);
+
+private:
+  std::vector<node_id> entries_;
+
+  size_t next_slot_ = 0;
+};
+
+/// Flags for the first Byte of an encoded `compact_envelope`.
+enum class compact_flags : uint8_t {
+  /// Signals that the message has a sender. Otherwise, the envelope omits the
+  /// node ID and actor ID of the sender.
+  has_sender = 0x01,
+  /// Signals that the node ID of the sender follows its slot index. Otherwise,
+  /// the receiver reads the node ID from its `node_table`.
+  node_literal = 0x02,
+  /// Signals that a forwarding stack follows the envelope. The envelope omits
+  /// empty forwarding stacks.
+  has_stages = 0x04,
+};
+
+/// Routing information of a `compact_actor_message` in decoded form. Actor IDs
+/// and slot indexes use a variable-length encoding on the wire.
+struct CAF_NET_EXPORT compact_envelope {
+  /// Stores the node of the sender or `none` if the message has no sender.
+  node_id source_node;
+
+  /// Stores the ID of the sender or 0 if the message has no sender.
+  actor_id source_id = 0;
+
+  /// Stores the ID of the receiver.
+  actor_id dest_id = 0;
+
+  /// Signals whether a forwarding stack follows the envelope.
+  bool has_stages = false;
+
+  /// Stores how many Bytes the envelope occupied in the payload.
+  size_t size = 0;
+};
+
+/// Writes `x` to `sink` using a variable-length encoding with 7 bits per Byte.
+/// @relates compact_envelope
+CAF_NET_EXPORT bool write_varint(binary_serializer& sink, uint64_t x);
+
+/// Reads a value from `source` that was written with `write_varint`.
+/// @relates compact_envelope
+CAF_NET_EXPORT bool read_varint(binary_deserializer& source, uint64_t& x);
+
+/// Encodes the envelope of an actor message in compact form and adds the node
+/// of the sender to `nodes` if necessary.
+/// @relates compact_envelope
+CAF_NET_EXPORT bool write_compact_envelope(binary_serializer& sink,
+                                           node_table& nodes,
+                                           const node_id& source_node,
+                                           actor_id source_id, actor_id dest_id,
+                                           bool has_stages);
+
+/// Decodes the envelope of an actor message in compact form and updates
+/// `nodes` if the envelope contains a node literal.
+/// @relates compact_envelope
+CAF_NET_EXPORT bool read_compact_envelope(binary_deserializer& source,
+                                          node_table& nodes,
+                                          compact_envelope& x);
+
+/// @}
+
+} // namespace caf::net::basp
@@ -0,0 +1,112 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "caf/byte_buffer.hpp"
+#include "caf/detail/net_export.hpp"
+#include "caf/error.hpp"
+#include "caf/fwd.hpp"
+#include "caf/message.hpp"
+
+namespace caf::net::basp {
+
+/// @addtogroup BASP
+
+/// Caches the serialized content of messages that travel to multiple remote
+/// receivers, e.g., when an actor publishes the same message to subscribers on
+/// other nodes. All copies of a `message` share the same data, so the cache
+/// serializes the content once and each connection only serializes the small
+/// per-receiver envelope. The cache is safe to share between connections.
+///
+/// The cache splits its entries into shards with one mutex each and selects
+/// the shard by the address of the message data. Each shard evicts its oldest
+/// entry when full and drops expired entries, i.e., entries for messages
+/// without copies outside of the cache, on every access.
+class CAF_NET_EXPORT content_cache {
+public:
+  // -- member types -----------------------------------------------------------
+
+  using buffer_ptr = std::shared_ptr<const byte_buffer>;
+
+  // -- constants --------------------------------------------------------------
+
+  /// Default number of cached messages.
+  static constexpr size_t default_capacity = 64;
+
+  /// Default number of shards.
+  static constexpr size_t default_shards = 8;
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  /// @param capacity Maximum number of cached messages, distributed evenly
+  ///                 among all shards.
+  /// @param shards Number of independently locked partitions.
+  explicit content_cache(size_t capacity = default_capacity,
+                         size_t shards = default_shards);
+
+  content_cache(const content_cache&) = delete;
+
+  content_cache& operator=(const content_cache&) = delete;
+
+  // -- serialization ----------------------------------------------------------
+
+  /// Appends the serialized form of `content` to `buf`. Serializes `content`
+  /// only once as long as other copies of `content` exist.
+  error serialize(actor_system& sys, const message& content, byte_buffer& buf);
+
+  // -- properties -------------------------------------------------------------
+
+  /// Returns the number of cached messages.
+  size_t size() const;
+
+private:
+  // -- member types -----------------------------------------------------------
+
+  using key_type = const detail::message_data*;
+
+  struct entry {
+    /// Keeps the message data alive while caching its serialized form.
+    message content;
+
+    /// Stores the serialized form of `content`.
+    buffer_ptr bytes;
+  };
+
+  struct shard {
+    mutable std::mutex mtx;
+
+    /// Maps message data to its serialized form.
+    std::unordered_map<key_type, entry> entries;
+
+    /// Stores the keys of `entries` in insertion order.
+    std::deque<key_type> order;
+  };
+
+  // -- utility functions ------------------------------------------------------
+
+  shard& shard_for(key_type key) noexcept;
+
+  /// Drops the oldest entries of `x` as long as they have expired.
+  /// @pre `x.mtx` is locked
+  static void expire(shard& x);
+
+  // -- member variables -------------------------------------------------------
+
+  /// Maximum number of entries per shard.
+  size_t shard_capacity_;
+
+  std::vector<shard> shards_;
+};
+
+/// @}
+
+} // namespace caf::net::basp
@@ -0,0 +1,80 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "caf/byte_span.hpp"
+#include "caf/detail/net_export.hpp"
+#include "caf/error.hpp"
+#include "caf/fwd.hpp"
+#include "caf/net/basp/header.hpp"
+#include "caf/net/fwd.hpp"
+
+namespace caf::net::basp {
+
+/// @addtogroup BASP
+
+/// Collects `monitor_message` and `down_message` packets for a BASP
+/// connection until the next flush. If both sides support the
+/// `control-batches` feature, a flush combines multiple pending messages of
+/// the same kind into a single `monitor_batch` or `down_batch`.
+class CAF_NET_EXPORT control_batch {
+public:
+  // -- member types -----------------------------------------------------------
+
+  using down_list = std::vector<std::pair<actor_id, error>>;
+
+  // -- properties -------------------------------------------------------------
+
+  /// Returns the number of pending messages.
+  size_t size() const noexcept {
+    return monitors_.size() + downs_.size();
+  }
+
+  /// Returns whether no message waits for the next flush.
+  bool empty() const noexcept {
+    return size() == 0;
+  }
+
+  // -- modifiers --------------------------------------------------------------
+
+  /// Asks the peer to send a down message once its actor `id` terminates.
+  /// @returns `true` if the batch was empty before, i.e., if the caller needs
+  ///          to schedule a flush.
+  bool add_monitor(actor_id id);
+
+  /// Informs the peer that the local actor `id` terminated.
+  /// @returns `true` if the batch was empty before, i.e., if the caller needs
+  ///          to schedule a flush.
+  bool add_down(actor_id id, error reason);
+
+  /// Writes all pending messages to `writer` and clears the batch.
+  /// @param use_batches Combines multiple pending messages of the same kind
+  ///                    into a single packet if `true`.
+  /// @returns the number of written packets.
+  size_t flush(actor_system& sys, packet_writer& writer, bool use_batches);
+
+  // -- decoding ---------------------------------------------------------------
+
+  /// Reads the actor IDs from the payload of a `monitor_batch`.
+  static error read_monitors(execution_unit* ctx, header hdr,
+                             byte_span payload, std::vector<actor_id>& result);
+
+  /// Reads the down notifications from the payload of a `down_batch`.
+  static error read_downs(execution_unit* ctx, header hdr, byte_span payload,
+                          down_list& result);
+
+private:
+  std::vector<actor_id> monitors_;
+
+  down_list downs_;
+};
+
+/// @}
+
+} // namespace caf::net::basp
@@ -0,0 +1,60 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+
+#include "caf/actor_control_block.hpp"
+#include "caf/detail/net_export.hpp"
+#include "caf/fwd.hpp"
+
+namespace caf::net::basp {
+
+/// @addtogroup BASP
+
+/// Remembers which local actors a connection has put into the registry on
+/// behalf of its peer. Local actors stay in the registry until they terminate.
+/// Hence, each connection only needs to put an actor once instead of once per
+/// outgoing message. Entries of terminated actors expire and get pruned
+/// whenever the table doubles in size.
+/// @note Not thread-safe. Each connection owns its table.
+class CAF_NET_EXPORT export_table {
+public:
+  // -- constants --------------------------------------------------------------
+
+  /// Minimum number of entries before the table scans for terminated actors.
+  static constexpr size_t prune_threshold = 64;
+
+  // -- properties -------------------------------------------------------------
+
+  /// Returns the number of entries, including expired ones.
+  size_t size() const noexcept {
+    return entries_.size();
+  }
+
+  /// Returns whether the table has an entry for the actor `aid`.
+  bool contains(actor_id aid) const noexcept {
+    return entries_.count(aid) != 0;
+  }
+
+  // -- modifiers --------------------------------------------------------------
+
+  /// Puts `ptr` into `registry` unless the table already has an entry for it.
+  /// @returns `true` if `ptr` was new to the table, `false` otherwise.
+  bool add(actor_registry& registry, const strong_actor_ptr& ptr);
+
+private:
+  /// Removes all entries of terminated actors.
+  void prune();
+
+  std::unordered_map<actor_id, weak_actor_ptr> entries_;
+
+  size_t prune_at_ = prune_threshold;
+};
+
+/// @}
+
+} // namespace caf::net::basp
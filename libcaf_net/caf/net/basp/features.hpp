@@ -0,0 +1,66 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "caf/detail/net_export.hpp"
+#include "caf/net/basp/message_type.hpp"
+#include "caf/string_view.hpp"
+
+namespace caf::net::basp {
+
+/// @addtogroup BASP
+
+/// Names the handshake feature for `compact_actor_message` support.
+constexpr string_view compact_envelopes_feature = "compact-envelopes";
+
+/// Names the handshake feature for `message_batch` support.
+constexpr string_view message_batches_feature = "message-batches";
+
+/// Names the handshake feature for `monitor_batch` and `down_batch` support.
+constexpr string_view control_batches_feature = "control-batches";
+
+/// Names the handshake feature for `compressed_message` support.
+constexpr string_view compression_feature = "lz4-compression";
+
+/// Lists the optional protocol features of a BASP connection. Each side
+/// announces its supported features in the handshake and both sides use a
+/// feature only if both sides announced it.
+struct features {
+  /// Enables `compact_actor_message`.
+  bool compact_envelopes = false;
+
+  /// Enables `message_batch`.
+  bool message_batches = false;
+
+  /// Enables `monitor_batch` and `down_batch`.
+  bool control_batches = false;
+
+  /// Enables `compressed_message`.
+  bool compression = false;
+};
+
+/// Returns the names of all features in `xs` for announcing them in the
+/// handshake.
+/// @relates features
+CAF_NET_EXPORT std::vector<std::string> to_names(const features& xs);
+
+/// Returns the features of `local` that our peer announced in `names`.
+/// Ignores unknown names, since newer peers may support more features.
+/// @relates features
+CAF_NET_EXPORT features negotiate(const features& local,
+                                  const std::vector<std::string>& names);
+
+/// Returns whether our peer may send messages of type `x` on a connection with
+/// the negotiated features `xs`. A peer that sends a message type without
+/// agreeing on its feature first violates the protocol.
+/// @relates features
+CAF_NET_EXPORT bool permits(const features& xs, message_type x) noexcept;
+
+/// @}
+
+} // namespace caf::net::basp
@@ -0,0 +1,126 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+#include "caf/callback.hpp"
+#include "caf/detail/net_export.hpp"
+#include "caf/fwd.hpp"
+#include "caf/intrusive_ptr.hpp"
+#include "caf/mailbox_element.hpp"
+#include "caf/net/fwd.hpp"
+#include "caf/ref_counted.hpp"
+#include "caf/string_view.hpp"
+
+namespace caf::net::basp {
+
+/// @addtogroup BASP
+
+/// Tracks how many messages a BASP connection has delivered to local actors
+/// that the actors did not process yet. Each delivered message keeps a
+/// reference to this object and decrements the counter on destruction, i.e.,
+/// after the receiver has processed the message.
+///
+/// The application stops reading from its socket once the number of pending
+/// messages reaches the high watermark. When actors catch up and the number of
+/// pending messages drops to the low watermark, the flow control calls the
+/// resume callback of its owner, which then resumes reading on the I/O thread.
+/// The callback runs on whichever thread processed the message.
+class CAF_NET_EXPORT flow_control : public ref_counted {
+public:
+  // -- member types -----------------------------------------------------------
+
+  using resume_callback = unique_callback_ptr<void()>;
+
+  // -- constants --------------------------------------------------------------
+
+  /// Tags the event for resuming to read from the socket.
+  static constexpr string_view resume_reading_tag = "basp-resume-reading";
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  /// @param on_resume Resumes reading on the I/O thread. May be `nullptr`.
+  flow_control(resume_callback on_resume, size_t high_watermark,
+               size_t low_watermark);
+
+  ~flow_control() override;
+
+  // -- properties -------------------------------------------------------------
+
+  /// Returns the number of delivered messages that wait for processing.
+  size_t pending() const noexcept {
+    return pending_.load();
+  }
+
+  /// Returns whether the application stopped reading from its socket.
+  bool paused() const noexcept {
+    return paused_.load();
+  }
+
+  size_t high_watermark() const noexcept {
+    return high_watermark_;
+  }
+
+  size_t low_watermark() const noexcept {
+    return low_watermark_;
+  }
+
+  // -- tracking ---------------------------------------------------------------
+
+  /// Creates a mailbox element that counts as pending until destroyed.
+  mailbox_element_ptr make_element(strong_actor_ptr sender, message_id id,
+                                   mailbox_element::forwarding_stack stages,
+                                   message content);
+
+  /// Returns whether the application must stop reading from its socket. On
+  /// `true`, the flow control calls the resume callback once actors catch up.
+  bool pause();
+
+  /// Destroys the resume callback. Afterwards, catching up has no effect.
+  void detach();
+
+  // -- callbacks for tracked elements -----------------------------------------
+
+  /// Increments the number of pending messages.
+  void delivered() noexcept;
+
+  /// Decrements the number of pending messages and calls the resume callback
+  /// if necessary.
+  void processed();
+
+private:
+  /// Guards `on_resume_`.
+  std::mutex mtx_;
+
+  /// Resumes reading on the I/O thread.
+  resume_callback on_resume_;
+
+  std::atomic<size_t> pending_;
+
+  std::atomic<bool> paused_;
+
+  size_t high_watermark_;
+
+  size_t low_watermark_;
+};
+
+/// @relates flow_control
+using flow_control_ptr = intrusive_ptr<flow_control>;
+
+/// Creates a mailbox element that `fc` tracks or an untracked mailbox element
+/// if `fc == nullptr`.
+/// @relates flow_control
+CAF_NET_EXPORT mailbox_element_ptr
+make_tracked_mailbox_element(flow_control* fc, strong_actor_ptr sender,
+                             message_id id,
+                             mailbox_element::forwarding_stack stages,
+                             message content);
+
+/// @}
+
+} // namespace caf::net::basp
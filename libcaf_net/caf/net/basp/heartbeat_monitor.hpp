@@ -0,0 +1,96 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#pragma once
+
+#include <cstddef>
+
+#include "caf/detail/net_export.hpp"
+#include "caf/timespan.hpp"
+
+namespace caf::net::basp {
+
+/// @addtogroup BASP
+
+/// Decides once per heartbeat interval whether a BASP connection needs to
+/// send a heartbeat or has timed out. Regular traffic doubles as heartbeat in
+/// both directions, i.e., the monitor only asks for explicit heartbeats on
+/// connections that did not send anything during the last interval and only
+/// counts intervals without any inbound data toward the timeout.
+class CAF_NET_EXPORT heartbeat_monitor {
+public:
+  // -- member types -----------------------------------------------------------
+
+  /// Tells the application what to do at the end of an interval.
+  enum class action {
+    /// The connection is alive and sent data during the last interval.
+    none,
+    /// The connection is alive but idle on our side.
+    send_heartbeat,
+    /// The peer did not send anything for the configured connection timeout.
+    disconnect,
+  };
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  heartbeat_monitor() noexcept = default;
+
+  /// @param interval Time between two calls to `tick`. Zero disables
+  ///                 heartbeats.
+  /// @param connection_timeout Maximum time without inbound data before the
+  ///                           monitor considers the peer dead. Zero disables
+  ///                           the timeout. Rounds up to full intervals.
+  heartbeat_monitor(timespan interval, timespan connection_timeout) noexcept;
+
+  // -- properties -------------------------------------------------------------
+
+  /// Returns whether the application needs to call `tick` periodically.
+  bool enabled() const noexcept {
+    return interval_.count() > 0;
+  }
+
+  timespan interval() const noexcept {
+    return interval_;
+  }
+
+  /// Returns after how many intervals without inbound data the monitor
+  /// considers the peer dead or 0 if the timeout is disabled.
+  size_t max_idle_ticks() const noexcept {
+    return max_idle_ticks_;
+  }
+
+  // -- event handlers ---------------------------------------------------------
+
+  /// Marks that the application wrote data to the socket.
+  void sent() noexcept {
+    sent_since_tick_ = true;
+  }
+
+  /// Marks that the application received data from the socket.
+  void received() noexcept {
+    received_since_tick_ = true;
+  }
+
+  /// Ends the current interval.
+  /// @param paused Signals that the application stopped reading from the
+  ///               socket. The lack of inbound data says nothing about the
+  ///               peer in this case.
+  action tick(bool paused) noexcept;
+
+private:
+  timespan interval_{0};
+
+  size_t max_idle_ticks_ = 0;
+
+  /// Counts intervals without inbound data.
+  size_t idle_ticks_ = 0;
+
+  bool sent_since_tick_ = false;
+
+  bool received_since_tick_ = false;
+};
+
+/// @}
+
+} // namespace caf::net::basp
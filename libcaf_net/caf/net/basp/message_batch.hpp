@@ -0,0 +1,97 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "caf/byte_buffer.hpp"
+#include "caf/byte_span.hpp"
+#include "caf/detail/net_export.hpp"
+#include "caf/fwd.hpp"
+#include "caf/net/basp/header.hpp"
+#include "caf/net/basp/message_type.hpp"
+
+namespace caf::net::basp {
+
+/// @addtogroup BASP
+
+/// Packs multiple actor messages into the payload of a `message_batch`. Each
+/// message in the batch consists of its regular header followed by its
+/// payload.
+///
+/// The batch is full once it contains `max_messages` messages or at least
+/// `max_bytes` Bytes. Since the size of a message is unknown before
+/// serializing it, the last message of a batch may exceed `max_bytes`.
+class CAF_NET_EXPORT batch_writer {
+public:
+  // -- constructors, destructors, and assignment operators --------------------
+
+  /// @param buf Stores the payload of the batch.
+  /// @param max_messages Maximum number of messages in the batch.
+  /// @param max_bytes Maximum payload size before declaring the batch full.
+  ///                  Zero means unlimited.
+  batch_writer(byte_buffer& buf, size_t max_messages, size_t max_bytes);
+
+  // -- properties -------------------------------------------------------------
+
+  /// Returns the number of messages in the batch.
+  size_t size() const noexcept {
+    return size_;
+  }
+
+  /// Returns whether the batch contains no message.
+  bool empty() const noexcept {
+    return size_ == 0;
+  }
+
+  /// Returns whether the batch may not take any more messages.
+  bool full() const noexcept;
+
+  // -- modifiers --------------------------------------------------------------
+
+  /// Reserves space for the header of the next message. The caller appends
+  /// the payload of the message to the buffer and then calls either `commit`
+  /// or `rollback`.
+  /// @param size_hint Estimated size of the payload.
+  byte_buffer& begin(size_t size_hint = 0);
+
+  /// Writes the header for the message since the last call to `begin`.
+  void commit(message_type type, uint64_t operation_data);
+
+  /// Removes everything since the last call to `begin` from the buffer.
+  void rollback();
+
+private:
+  byte_buffer& buf_;
+
+  size_t max_messages_;
+
+  size_t max_bytes_;
+
+  size_t size_ = 0;
+
+  size_t offset_ = 0;
+};
+
+/// A single message of a `message_batch`.
+struct batched_message {
+  header hdr;
+  byte_span payload;
+};
+
+/// Splits the payload of a `message_batch` into its messages. Clears `out`
+/// before adding the messages.
+/// @param payload The payload of the batch.
+/// @param num_messages The number of messages according to the batch header.
+/// @returns `false` if `payload` does not contain exactly `num_messages`
+///          actor messages, `true` otherwise.
+CAF_NET_EXPORT bool read_batch(byte_span payload, uint64_t num_messages,
+                               std::vector<batched_message>& out);
+
+/// @}
+
+} // namespace caf::net::basp
@@ -0,0 +1,105 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "caf/byte_span.hpp"
+#include "caf/detail/net_export.hpp"
+#include "caf/detail/worker_hub.hpp"
+#include "caf/fwd.hpp"
+#include "caf/net/basp/compact_envelope.hpp"
+#include "caf/net/basp/flow_control.hpp"
+#include "caf/net/basp/header.hpp"
+#include "caf/net/basp/message_queue.hpp"
+#include "caf/net/basp/proxy_cache.hpp"
+#include "caf/net/basp/remote_message_handler.hpp"
+#include "caf/net/basp/worker.hpp"
+#include "caf/node_id.hpp"
+
+namespace caf::net::basp {
+
+/// @addtogroup BASP
+
+/// Deserializes the incoming actor messages of a connection. Payloads up to
+/// `threshold` Bytes are cheaper to deserialize in the I/O thread than to copy
+/// and schedule a worker for. Larger payloads go to a pool of BASP workers,
+/// unless all workers are busy. Either way, messages pass through the same
+/// `message_queue` and thus arrive in order.
+class CAF_NET_EXPORT message_dispatcher
+  : public remote_message_handler<message_dispatcher> {
+public:
+  // -- friends ----------------------------------------------------------------
+
+  friend remote_message_handler<message_dispatcher>;
+
+  // -- member types -----------------------------------------------------------
+
+  using hub_type = detail::worker_hub<worker>;
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  /// @param proxies Creates proxies for the senders of incoming messages.
+  /// @param num_workers Size of the worker pool.
+  /// @param threshold Maximum payload size for deserializing in the I/O
+  ///                  thread.
+  /// @param fc Tracks delivered messages for read-side backpressure. May be
+  ///           `nullptr`.
+  message_dispatcher(proxy_registry& proxies, size_t num_workers,
+                     size_t threshold, flow_control* fc = nullptr);
+
+  ~message_dispatcher();
+
+  // -- properties -------------------------------------------------------------
+
+  size_t threshold() const noexcept {
+    return threshold_;
+  }
+
+  // -- dispatching ------------------------------------------------------------
+
+  /// Deserializes the actor message with header `hdr` and `payload` and
+  /// delivers it to its receiver. The `envelope` must hold the decoded
+  /// envelope if `hdr` denotes a `compact_actor_message`.
+  /// @returns `true` if the message was deserialized in the calling thread,
+  ///          `false` if it was handed to a worker.
+  bool dispatch(execution_unit* ctx, const header& hdr, byte_span payload,
+                compact_envelope envelope = {});
+
+private:
+  // -- member variables -------------------------------------------------------
+
+  size_t threshold_;
+
+  /// Establishes strict ordering between the I/O thread and all workers.
+  std::unique_ptr<message_queue> queue_;
+
+  /// Must go away before the queue, since the workers point to it.
+  std::unique_ptr<hub_type> hub_;
+
+  // -- state for deserializing in the I/O thread ------------------------------
+
+  proxy_registry* proxies_;
+
+  actor_system* system_;
+
+  flow_control* flow_control_;
+
+  uint64_t msg_id_ = 0;
+
+  header hdr_;
+
+  byte_span payload_;
+
+  compact_envelope envelope_;
+
+  proxy_cache proxy_cache_;
+};
+
+/// @}
+
+} // namespace caf::net::basp
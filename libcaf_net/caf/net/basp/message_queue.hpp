@@ -4,9 +4,11 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <cstdint>
+#include <map>
 #include <mutex>
-#include <vector>
 
 #include "caf/actor_control_block.hpp"
 #include "caf/fwd.hpp"
@@ -16,13 +18,37 @@ namespace caf::net::basp {
 
 /// Enforces strict order of message delivery, i.e., deliver messages in the
 /// same order as if they were deserialized by a single thread.
+///
+/// The queue stores out-of-order messages in a fixed ring of slots, indexed by
+/// their ID relative to `next_undelivered`. Producers never block each other:
+/// whoever finds the message for `next_undelivered` ready delivers all
+/// consecutive messages, while concurrent producers only mark their slot as
+/// ready. A producer that runs `window_size` or more messages ahead stores its
+/// message in a mutex-protected overflow map instead, i.e., producers never
+/// wait for each other.
 class message_queue {
 public:
+  // -- constants --------------------------------------------------------------
+
+  /// Maximum distance between `next_undelivered` and any pushed ID. Must be a
+  /// power of two.
+  static constexpr size_t window_size = 1024;
+
+  static_assert((window_size & (window_size - 1)) == 0,
+                "window_size must be a power of two");
+
   // -- member types -----------------------------------------------------------
 
+  /// Stores a message that did not fit into the ring.
+  struct overflow_msg {
+    strong_actor_ptr receiver;
+    mailbox_element_ptr content;
+  };
+
   /// Request for sending a message to an actor at a later time.
   struct actor_msg {
-    uint64_t id;
+    /// Signals that the producer has stored `receiver` and `content`.
+    std::atomic<bool> ready{false};
     strong_actor_ptr receiver;
     mailbox_element_ptr content;
   };
@@ -31,6 +57,10 @@ public:
 
   message_queue();
 
+  message_queue(const message_queue&) = delete;
+
+  message_queue& operator=(const message_queue&) = delete;
+
   // -- mutators ---------------------------------------------------------------
 
   /// Adds a new message to the queue or deliver it immediately if possible.
@@ -45,19 +75,46 @@ public:
 
   // -- member variables -------------------------------------------------------
 
-  /// Protects all other properties.
-  std::mutex lock;
-
   /// The next available ascending ID. The counter is large enough to overflow
   /// after roughly 600 years if we dispatch a message every microsecond.
-  uint64_t next_id;
+  std::atomic<uint64_t> next_id;
 
   /// The next ID that we can ship.
-  uint64_t next_undelivered;
+  std::atomic<uint64_t> next_undelivered;
+
+private:
+  // -- utility functions ------------------------------------------------------
+
+  actor_msg& slot(uint64_t id) noexcept {
+    return pending_[static_cast<size_t>(id) & (window_size - 1)];
+  }
+
+  /// Delivers all consecutive messages starting at `next_undelivered` unless
+  /// another thread already does so.
+  void deliver(execution_unit* ctx);
+
+  /// Moves the message for `id` out of the overflow map if present.
+  bool take_overflow(uint64_t id, overflow_msg& result);
+
+  /// Checks whether the overflow map contains a message for `id`.
+  bool has_overflow(uint64_t id);
+
+  // -- member variables -------------------------------------------------------
+
+  /// Grants exclusive access for advancing `next_undelivered`.
+  std::atomic<bool> delivering_;
+
+  /// Keeps messages that got ready before `next_undelivered`.
+  std::array<actor_msg, window_size> pending_;
+
+  /// Counts the entries of `overflow_` for checking it without locking.
+  std::atomic<size_t> overflow_size_;
+
+  /// Protects `overflow_`.
+  std::mutex overflow_mtx_;
 
-  /// Keeps messages in sorted order in case a message other than
-  /// `next_undelivered` gets ready first.
-  std::vector<actor_msg> pending;
+  /// Keeps messages whose ID is too far ahead of `next_undelivered`.
+  std::map<uint64_t, overflow_msg> overflow_;
 };
 
 } // namespace caf::net::basp
@@ -58,6 +58,37 @@ enum class message_type : uint8_t {
   ///
   /// ![](heartbeat.png)
   heartbeat = 6,
+
+  /// Transmits an actor-to-actor message with a compact envelope. Peers only
+  /// send this message type after both sides announced support for compact
+  /// envelopes in their handshake.
+  compact_actor_message = 7,
+
+  /// Transmits multiple actor-to-actor messages in a single frame. The payload
+  /// consists of the header and payload of each message, while the operation
+  /// data denotes the number of messages. Peers only send this message type
+  /// after both sides announced support for batches in their handshake.
+  message_batch = 8,
+
+  /// Requests down messages for multiple local actors at once. The payload
+  /// consists of the actor IDs, while the operation data denotes the number of
+  /// IDs. Peers only send this message type after both sides announced support
+  /// for control batches in their handshake.
+  monitor_batch = 9,
+
+  /// Informs the receiving node that multiple actors have terminated. The
+  /// payload consists of pairs of actor ID and exit reason, while the
+  /// operation data denotes the number of pairs. Peers only send this message
+  /// type after both sides announced support for control batches in their
+  /// handshake.
+  down_batch = 10,
+
+  /// Wraps another message with an LZ4-compressed payload. The operation data
+  /// is the operation data of the wrapped message. The payload consists of the
+  /// type of the wrapped message, its payload size as 32-bit integer in network
+  /// Byte order, and the compressed payload. Peers only send this message type
+  /// after both sides announced support for compression in their handshake.
+  compressed_message = 11,
 };
 
 /// @relates message_type
@@ -0,0 +1,75 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "caf/actor_control_block.hpp"
+#include "caf/detail/net_export.hpp"
+#include "caf/fwd.hpp"
+#include "caf/node_id.hpp"
+
+namespace caf::net::basp {
+
+/// @addtogroup BASP
+
+/// Remembers recently used proxies in front of a shared `proxy_registry`.
+/// Looking up a proxy in the registry requires a lock that all connections and
+/// deserialization workers compete for. Since most traffic originates from a
+/// small set of remote actors, each worker keeps a small direct-mapped cache
+/// and only falls back to the registry on a miss.
+/// @note Not thread-safe. Each worker owns its cache.
+class CAF_NET_EXPORT proxy_cache {
+public:
+  // -- constants --------------------------------------------------------------
+
+  /// Number of cached proxies. Must be a power of two.
+  static constexpr size_t capacity = 64;
+
+  static_assert((capacity & (capacity - 1)) == 0,
+                "capacity must be a power of two");
+
+  // -- lookups ----------------------------------------------------------------
+
+  /// Returns the proxy for the remote actor `aid` on `nid`, querying
+  /// `proxies` on a cache miss or if the cached proxy has been killed.
+  strong_actor_ptr get_or_put(proxy_registry& proxies, const node_id& nid,
+                              actor_id aid);
+
+  // -- properties -------------------------------------------------------------
+
+  /// Returns how many lookups the cache answered without the registry.
+  size_t hits() const noexcept {
+    return hits_;
+  }
+
+  /// Returns how many lookups required the registry.
+  size_t misses() const noexcept {
+    return misses_;
+  }
+
+  // -- modifiers --------------------------------------------------------------
+
+  /// Drops all cached proxies.
+  void clear();
+
+private:
+  struct entry {
+    node_id nid;
+    actor_id aid = 0;
+    strong_actor_ptr proxy;
+  };
+
+  std::array<entry, capacity> entries_;
+
+  size_t hits_ = 0;
+
+  size_t misses_ = 0;
+};
+
+/// @}
+
+} // namespace caf::net::basp
@@ -16,7 +16,11 @@
 #include "caf/logger.hpp"
 #include "caf/message.hpp"
 #include "caf/message_id.hpp"
+#include "caf/net/basp/compact_envelope.hpp"
+#include "caf/net/basp/flow_control.hpp"
 #include "caf/net/basp/header.hpp"
+#include "caf/net/basp/message_type.hpp"
+#include "caf/net/basp/proxy_cache.hpp"
 #include "caf/node_id.hpp"
 
 namespace caf::net::basp {
@@ -39,29 +43,54 @@ public:
     std::vector<strong_actor_ptr> fwd_stack;
     message content;
     binary_deserializer source{ctx, payload};
-    if (!(source.apply(src_node) && source.apply(src_id) && source.apply(dst_id)
-          && source.apply(fwd_stack) && source.apply(content))) {
+    if (hdr.type == message_type::compact_actor_message) {
+      // The I/O thread has decoded the envelope for us already.
+      auto& envelope = dref.envelope_;
+      src_node = envelope.source_node;
+      src_id = envelope.source_id;
+      dst_id = envelope.dest_id;
+      source.skip(envelope.size);
+      if (envelope.has_stages && !source.apply(fwd_stack)) {
+        CAF_LOG_ERROR(
+          "failed to deserialize stages:" << CAF_ARG(source.get_error()));
+        dref.queue_->drop(ctx, dref.msg_id_);
+        return;
+      }
+    } else if (!(source.apply(src_node) && source.apply(src_id)
+                 && source.apply(dst_id) && source.apply(fwd_stack))) {
+      CAF_LOG_ERROR(
+        "failed to deserialize envelope:" << CAF_ARG(source.get_error()));
+      dref.queue_->drop(ctx, dref.msg_id_);
+      return;
+    }
+    if (!source.apply(content)) {
       CAF_LOG_ERROR(
         "failed to deserialize payload:" << CAF_ARG(source.get_error()));
+      dref.queue_->drop(ctx, dref.msg_id_);
       return;
     }
     // Sanity checks.
-    if (dst_id == 0)
+    if (dst_id == 0) {
+      dref.queue_->drop(ctx, dref.msg_id_);
       return;
+    }
     // Try to fetch the receiver.
     auto dst_hdl = registry.get(dst_id);
     if (dst_hdl == nullptr) {
       CAF_LOG_DEBUG("no actor found for given ID, drop message");
+      dref.queue_->drop(ctx, dref.msg_id_);
       return;
     }
     // Try to fetch the sender.
     strong_actor_ptr src_hdl;
     if (src_node != none && src_id != 0)
-      src_hdl = proxies.get_or_put(src_node, src_id);
+      src_hdl = dref.proxy_cache_.get_or_put(proxies, src_node, src_id);
     // Ship the message.
-    auto ptr = make_mailbox_element(std::move(src_hdl),
-                                    make_message_id(hdr.operation_data),
-                                    std::move(fwd_stack), std::move(content));
+    auto ptr = make_tracked_mailbox_element(dref.flow_control_,
+                                            std::move(src_hdl),
+                                            make_message_id(hdr.operation_data),
+                                            std::move(fwd_stack),
+                                            std::move(content));
     dref.queue_->push(ctx, dref.msg_id_, std::move(dst_hdl), std::move(ptr));
   }
 };
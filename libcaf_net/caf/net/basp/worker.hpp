@@ -13,8 +13,11 @@
 #include "caf/detail/net_export.hpp"
 #include "caf/detail/worker_hub.hpp"
 #include "caf/fwd.hpp"
+#include "caf/net/basp/compact_envelope.hpp"
+#include "caf/net/basp/flow_control.hpp"
 #include "caf/net/basp/header.hpp"
 #include "caf/net/basp/message_queue.hpp"
+#include "caf/net/basp/proxy_cache.hpp"
 #include "caf/net/basp/remote_message_handler.hpp"
 #include "caf/net/fwd.hpp"
 #include "caf/node_id.hpp"
@@ -41,14 +44,15 @@ public:
   // -- constructors, destructors, and assignment operators --------------------
 
   /// Only the ::worker_hub has access to the construtor.
-  worker(hub_type& hub, message_queue& queue, proxy_registry& proxies);
+  worker(hub_type& hub, message_queue& queue, proxy_registry& proxies,
+         flow_control* fc = nullptr);
 
   ~worker() override;
 
   // -- management -------------------------------------------------------------
 
   void launch(const node_id& last_hop, const basp::header& hdr,
-              span<const byte> payload);
+              span<const byte> payload, compact_envelope envelope = {});
 
   // -- implementation of resumable --------------------------------------------
 
@@ -60,7 +64,7 @@ private:
   /// Stores how many bytes the "first half" of this object requires.
   static constexpr size_t pointer_members_size
     = sizeof(hub_type*) + sizeof(message_queue*) + sizeof(proxy_registry*)
-      + sizeof(actor_system*);
+      + sizeof(actor_system*) + sizeof(flow_control*);
 
   static_assert(CAF_CACHE_LINE_SIZE > pointer_members_size,
                 "invalid cache line size");
@@ -79,6 +83,9 @@ private:
   /// Points to the parent system.
   actor_system* system_;
 
+  /// Tracks delivered messages for read-side backpressure (optional).
+  flow_control* flow_control_;
+
   /// Prevents false sharing when writing to `next`.
   char pad_[CAF_CACHE_LINE_SIZE - pointer_members_size];
 
@@ -94,6 +101,13 @@ private:
 
   /// Contains whatever this worker deserializes next.
   byte_buffer payload_;
+
+  /// Stores the pre-decoded routing information if `hdr_` denotes a
+  /// `compact_actor_message`.
+  compact_envelope envelope_;
+
+  /// Remembers recently used proxies to bypass the shared registry.
+  proxy_cache proxy_cache_;
 };
 
 } // namespace caf::net::basp
@@ -0,0 +1,142 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "caf/byte_buffer.hpp"
+#include "caf/detail/net_export.hpp"
+#include "caf/ip_endpoint.hpp"
+#include "caf/span.hpp"
+
+namespace caf::net {
+
+/// A ring of outgoing datagrams plus a pool of recycled buffers. Each slot in
+/// the ring stores up to `max_buffers` buffers inline, and popping a datagram
+/// returns its buffers (with their capacity) to the pool. Once the ring and
+/// the pool have warmed up, pushing and popping datagrams never allocates
+/// memory. The ring doubles its capacity when it runs full.
+class CAF_NET_EXPORT datagram_queue {
+public:
+  // -- constants --------------------------------------------------------------
+
+  /// Maximum number of buffers per datagram.
+  static constexpr size_t max_buffers = 10;
+
+  /// Number of slots for new queues. Must be a power of two.
+  static constexpr size_t default_capacity = 64;
+
+  // -- member types -----------------------------------------------------------
+
+  /// Stores a single datagram.
+  class entry {
+  public:
+    const ip_endpoint& receiver() const noexcept {
+      return receiver_;
+    }
+
+    /// Returns the size of the datagram in bytes.
+    size_t size() const noexcept {
+      return size_;
+    }
+
+    size_t num_buffers() const noexcept {
+      return num_buffers_;
+    }
+
+    /// Returns pointers to the buffers that make up the datagram.
+    span<byte_buffer*> buffers() noexcept {
+      for (size_t i = 0; i < num_buffers_; ++i)
+        ptrs_[i] = &bufs_[i];
+      return make_span(ptrs_.data(), num_buffers_);
+    }
+
+  private:
+    friend class datagram_queue;
+
+    ip_endpoint receiver_;
+
+    size_t size_ = 0;
+
+    size_t num_buffers_ = 0;
+
+    std::array<byte_buffer, max_buffers> bufs_;
+
+    std::array<byte_buffer*, max_buffers> ptrs_;
+  };
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  /// @param capacity Number of slots, rounded up to the next power of two.
+  explicit datagram_queue(size_t capacity = default_capacity);
+
+  // -- properties -------------------------------------------------------------
+
+  bool empty() const noexcept {
+    return size_ == 0;
+  }
+
+  /// Returns the number of queued datagrams.
+  size_t size() const noexcept {
+    return size_;
+  }
+
+  /// Returns the number of slots in the ring.
+  size_t capacity() const noexcept {
+    return entries_.size();
+  }
+
+  /// Returns the number of buffers in the pool.
+  size_t pooled() const noexcept {
+    return pool_.size();
+  }
+
+  // -- element access ---------------------------------------------------------
+
+  entry& front() noexcept {
+    return entries_[head_];
+  }
+
+  /// Returns the datagram at position `index`, counting from the front.
+  /// @pre `index < size()`
+  entry& operator[](size_t index) noexcept {
+    return entries_[(head_ + index) & (capacity() - 1)];
+  }
+
+  // -- modifiers --------------------------------------------------------------
+
+  /// Returns a buffer from the pool or a new buffer if the pool is empty.
+  byte_buffer next_buffer();
+
+  /// Appends a datagram that consists of `bufs`. Takes ownership of the
+  /// buffers, i.e., moves their content into the queue.
+  /// @pre `bufs.size() <= max_buffers`
+  void push(const ip_endpoint& receiver, span<byte_buffer*> bufs);
+
+  /// Removes the first datagram and returns its buffers to the pool.
+  /// @pre `!empty()`
+  void pop();
+
+private:
+  // -- utility functions ------------------------------------------------------
+
+  void grow();
+
+  // -- member variables -------------------------------------------------------
+
+  std::vector<entry> entries_;
+
+  size_t head_ = 0;
+
+  size_t size_ = 0;
+
+  /// Stores cleared buffers for reuse. Never grows beyond its reserved
+  /// capacity.
+  std::vector<byte_buffer> pool_;
+};
+
+} // namespace caf::net
@@ -4,14 +4,18 @@
 
 #pragma once
 
-#include <deque>
+#include <algorithm>
+#include <limits>
 #include <vector>
 
 #include "caf/byte_buffer.hpp"
 #include "caf/error.hpp"
 #include "caf/fwd.hpp"
+#include "caf/ip_address.hpp"
 #include "caf/ip_endpoint.hpp"
 #include "caf/logger.hpp"
+#include "caf/net/datagram_queue.hpp"
+#include "caf/net/defaults.hpp"
 #include "caf/net/endpoint_manager.hpp"
 #include "caf/net/fwd.hpp"
 #include "caf/net/transport_base.hpp"
@@ -21,15 +25,17 @@
 
 namespace caf::net {
 
-template <class Factory>
+template <class Factory, class Manager>
 using datagram_transport_base
-  = transport_base<datagram_transport<Factory>,
+  = transport_base<datagram_transport<Factory, Manager>,
                    transport_worker_dispatcher<Factory, ip_endpoint>,
-                   udp_datagram_socket, Factory, ip_endpoint>;
+                   udp_datagram_socket, Factory, ip_endpoint, Manager>;
 
 /// Implements a udp_transport policy that manages a datagram socket.
-template <class Factory>
-class datagram_transport : public datagram_transport_base<Factory> {
+/// @tparam Manager Provides `system`, `register_writing` and `next_message`.
+///                 The `endpoint_manager` in production.
+template <class Factory, class Manager = endpoint_manager>
+class datagram_transport : public datagram_transport_base<Factory, Manager> {
 public:
   // Maximal UDP-packet size
   static constexpr size_t max_datagram_size
@@ -43,7 +49,9 @@ public:
 
   using application_type = typename factory_type::application_type;
 
-  using super = datagram_transport_base<factory_type>;
+  using manager_type = Manager;
+
+  using super = datagram_transport_base<factory_type, manager_type>;
 
   using buffer_cache_type = typename super::buffer_cache_type;
 
@@ -56,28 +64,45 @@ public:
 
   // -- public member functions ------------------------------------------------
 
-  error init(endpoint_manager& manager) override {
+  error init(manager_type& manager) override {
     CAF_LOG_TRACE("");
     if (auto err = super::init(manager))
       return err;
-    prepare_next_read();
+    batch_size_ = std::clamp(get_or(this->system().config(),
+                                    "caf.middleman.datagram-batch-size",
+                                    defaults::middleman::datagram_batch_size),
+                             size_t{1}, max_udp_batch_size);
+    // Allocate all slots once. Reading never resizes their buffers.
+    read_slots_.resize(batch_size_);
+    for (auto& slot : read_slots_)
+      slot.buf.resize(max_datagram_size);
+    write_views_.reserve(batch_size_);
+    gso_bufs_.reserve(max_udp_gso_segments * datagram_queue::max_buffers);
+    if (get_or(this->system().config(), "caf.middleman.udp-offload", true))
+      offload_ = enable_udp_offload(this->handle_);
     return none;
   }
 
-  bool handle_read_event(endpoint_manager&) override {
+  bool handle_read_event(manager_type&) override {
     CAF_LOG_TRACE(CAF_ARG(this->handle_.id));
     for (size_t reads = 0; reads < this->max_consecutive_reads_; ++reads) {
-      auto ret = read(this->handle_, this->read_buf_);
-      if (auto res = get_if<std::pair<size_t, ip_endpoint>>(&ret)) {
-        auto& [num_bytes, ep] = *res;
-        CAF_LOG_DEBUG("received " << num_bytes << " bytes");
-        this->read_buf_.resize(num_bytes);
-        if (auto err = this->next_layer_.handle_data(*this, this->read_buf_,
-                                                     std::move(ep))) {
-          CAF_LOG_ERROR("handle_data failed: " << err);
-          return false;
+      auto ret = read_batch(this->handle_, make_span(read_slots_));
+      if (auto num_datagrams = get_if<size_t>(&ret)) {
+        CAF_LOG_DEBUG("received " << *num_datagrams << " datagrams");
+        for (size_t i = 0; i < *num_datagrams; ++i) {
+          auto& slot = read_slots_[i];
+          auto f = [this, &slot](span<byte> bytes) {
+            span<const byte> datagram{bytes.data(), bytes.size()};
+            return this->next_layer_.handle_data(*this, datagram, slot.ep);
+          };
+          if (auto err = for_each_datagram(slot, f)) {
+            CAF_LOG_ERROR("handle_data failed: " << err);
+            return false;
+          }
         }
-        prepare_next_read();
+        // A partial batch means that the socket has no more datagrams.
+        if (*num_datagrams < read_slots_.size())
+          break;
       } else {
         auto err = get<sec>(ret);
         if (err == sec::unavailable_or_would_block) {
@@ -92,7 +117,7 @@ public:
     return true;
   }
 
-  bool handle_write_event(endpoint_manager& manager) override {
+  bool handle_write_event(manager_type& manager) override {
     CAF_LOG_TRACE(CAF_ARG2("handle", this->handle_.id)
                   << CAF_ARG2("queue-size", packet_queue_.size()));
     auto fetch_next_message = [&] {
@@ -122,68 +147,111 @@ public:
     CAF_ASSERT(!buffers.empty());
     if (packet_queue_.empty())
       this->manager().register_writing();
-    // By convention, the first buffer is a header buffer. Every other buffer is
-    // a payload buffer.
-    packet_queue_.emplace_back(id, buffers);
+    packet_queue_.push(id, buffers);
   }
 
-  /// Helper struct for managing outgoing packets
-  struct packet {
-    id_type id;
-    buffer_cache_type bytes;
-    size_t size;
-
-    packet(id_type id, span<byte_buffer*> bufs) : id(id) {
-      size = 0;
-      for (auto buf : bufs) {
-        size += buf->size();
-        bytes.emplace_back(std::move(*buf));
-      }
-    }
+  // -- multicast --------------------------------------------------------------
 
-    std::vector<byte_buffer*> get_buffer_ptrs() {
-      std::vector<byte_buffer*> ptrs;
-      for (auto& buf : bytes)
-        ptrs.emplace_back(&buf);
-      return ptrs;
+  /// Joins the multicast group `group`. The socket must be bound to the
+  /// wildcard address and to the port that senders use for the group. Received
+  /// datagrams reach the worker for their sender as usual.
+  error join_group(const ip_address& group) {
+    CAF_LOG_TRACE(CAF_ARG(group));
+    return join_multicast_group(this->handle_, group);
+  }
+
+  /// Leaves a group that this transport joined via `join_group`.
+  error leave_group(const ip_address& group) {
+    CAF_LOG_TRACE(CAF_ARG(group));
+    return leave_multicast_group(this->handle_, group);
+  }
+
+  /// Adds a worker that sends each message for `node` once to the multicast
+  /// group `group`, i.e., the cost for sending a message does not depend on
+  /// the number of group members. Sets the multicast options for the family
+  /// of the socket, i.e., for both families on dual-stack sockets.
+  /// @pre `is_handshake_free_v<application_type>`
+  error add_group_worker(node_id node, ip_endpoint group) {
+    CAF_LOG_TRACE(CAF_ARG(node) << CAF_ARG(group));
+    if (!multicast_configured_) {
+      auto& cfg = this->system().config();
+      auto ttl = get_or(cfg, "caf.middleman.multicast-ttl",
+                        defaults::middleman::multicast_ttl);
+      auto hops = static_cast<uint8_t>(std::min(ttl, size_t{255}));
+      if (auto err = multicast_ttl(this->handle_, hops))
+        return err;
+      auto loopback = get_or(cfg, "caf.middleman.multicast-loopback", true);
+      if (auto err = multicast_loopback(this->handle_, loopback))
+        return err;
+      multicast_configured_ = true;
     }
-  };
+    auto worker = this->next_layer_.add_group_worker(*this, std::move(node),
+                                                     std::move(group));
+    if (!worker)
+      return worker.error();
+    return none;
+  }
 
-private:
-  // -- utility functions ------------------------------------------------------
+  // -- buffer management ------------------------------------------------------
 
-  void prepare_next_read() {
-    this->read_buf_.resize(max_datagram_size);
+  // Sent buffers go back to the pool of the packet queue, which replaces the
+  // header and payload caches of the base class.
+
+  byte_buffer next_header_buffer() {
+    return packet_queue_.next_buffer();
   }
 
+  byte_buffer next_payload_buffer() {
+    return packet_queue_.next_buffer();
+  }
+
+private:
+  // -- utility functions ------------------------------------------------------
+
   error write_some() {
-    // Helper function to sort empty buffers back into the right caches.
-    auto recycle = [&]() {
-      auto& front = packet_queue_.front();
-      auto& bufs = front.bytes;
-      auto it = bufs.begin();
-      if (this->header_bufs_.size() < this->header_bufs_.capacity()) {
-        it->clear();
-        this->header_bufs_.emplace_back(std::move(*it++));
+    // Write as many datagrams as possible, up to `batch_size_` per call.
+    while (!packet_queue_.empty()) {
+      if (auto n = gso_run_length(); n > 1) {
+        auto& front = packet_queue_.front();
+        gso_bufs_.clear();
+        for (size_t i = 0; i < n; ++i)
+          for (auto ptr : packet_queue_[i].buffers())
+            gso_bufs_.emplace_back(ptr);
+        auto write_ret = write_segmented(this->handle_, make_span(gso_bufs_),
+                                         front.size(), front.receiver());
+        if (auto num_bytes = get_if<size_t>(&write_ret)) {
+          CAF_LOG_DEBUG(CAF_ARG(this->handle_.id) << CAF_ARG(*num_bytes)
+                                                  << CAF_ARG2("segments", n));
+          for (size_t i = 0; i < n; ++i)
+            packet_queue_.pop();
+          continue;
+        }
+        auto err = get<sec>(write_ret);
+        if (err == sec::unavailable_or_would_block)
+          return err;
+        // The kernel may still reject GSO for a route, e.g., if segments
+        // exceed the MTU of the outgoing interface. Fall back to regular
+        // writes in this case.
+        CAF_LOG_WARNING("disable GSO after failed write:" << CAF_ARG(err));
+        offload_.gso = false;
       }
-      for (; it != bufs.end()
-             && this->payload_bufs_.size() < this->payload_bufs_.capacity();
-           ++it) {
-        it->clear();
-        this->payload_bufs_.emplace_back(std::move(*it));
+      auto n = std::min(packet_queue_.size(), batch_size_);
+      write_views_.clear();
+      for (size_t i = 0; i < n; ++i) {
+        auto& packet = packet_queue_[i];
+        write_views_.emplace_back(
+          udp_datagram_view{packet.buffers(), packet.receiver()});
       }
-      packet_queue_.pop_front();
-    };
-    // Write as many bytes as possible.
-    while (!packet_queue_.empty()) {
-      auto& packet = packet_queue_.front();
-      auto ptrs = packet.get_buffer_ptrs();
-      auto write_ret = write(this->handle_, ptrs, packet.id);
-      if (auto num_bytes = get_if<size_t>(&write_ret)) {
-        CAF_LOG_DEBUG(CAF_ARG(this->handle_.id) << CAF_ARG(*num_bytes));
-        CAF_LOG_WARNING_IF(*num_bytes < packet.size,
-                           "packet was not sent completely");
-        recycle();
+      auto write_ret = write_batch(this->handle_,
+                                   span<const udp_datagram_view>{
+                                     write_views_.data(), write_views_.size()});
+      if (auto num_datagrams = get_if<size_t>(&write_ret)) {
+        CAF_LOG_DEBUG(CAF_ARG(this->handle_.id) << CAF_ARG(*num_datagrams));
+        for (size_t i = 0; i < *num_datagrams; ++i)
+          packet_queue_.pop();
+        // The socket buffer is full if the kernel took only part of the batch.
+        if (*num_datagrams < n)
+          return sec::unavailable_or_would_block;
       } else {
         auto err = get<sec>(write_ret);
         if (err != sec::unavailable_or_would_block) {
@@ -196,7 +264,56 @@ private:
     return none;
   }
 
-  std::deque<packet> packet_queue_;
+  /// Returns how many packets at the front of the queue qualify for a single
+  /// GSO write: all packets have the same receiver and the same size, except
+  /// for the last packet that may be shorter.
+  size_t gso_run_length() {
+    if (!offload_.gso || packet_queue_.size() < 2)
+      return 0;
+    auto& front = packet_queue_.front();
+    auto segment_size = front.size();
+    if (segment_size == 0 || segment_size > max_udp_gso_bytes)
+      return 0;
+    size_t result = 1;
+    auto num_bytes = segment_size;
+    auto num_bufs = front.num_buffers();
+    for (size_t i = 1;
+         i < packet_queue_.size() && result < max_udp_gso_segments; ++i) {
+      auto& x = packet_queue_[i];
+      if (x.receiver() != front.receiver() || x.size() == 0
+          || x.size() > segment_size
+          || num_bytes + x.size() > max_udp_gso_bytes
+          || num_bufs + x.num_buffers() > max_udp_gso_buffers)
+        break;
+      ++result;
+      num_bytes += x.size();
+      num_bufs += x.num_buffers();
+      if (x.size() < segment_size)
+        break;
+    }
+    return result;
+  }
+
+  /// Stores outgoing datagrams and recycles their buffers.
+  datagram_queue packet_queue_;
+
+  /// Number of datagrams per system call.
+  size_t batch_size_ = 1;
+
+  /// Receives datagrams from the socket.
+  std::vector<udp_datagram_slot> read_slots_;
+
+  /// Refers to the packets of the next `write_batch` call.
+  std::vector<udp_datagram_view> write_views_;
+
+  /// Refers to the buffers of the next `write_segmented` call.
+  std::vector<byte_buffer*> gso_bufs_;
+
+  /// Lists the offloads that the kernel provides for our socket.
+  udp_offload_support offload_;
+
+  /// Signals whether `add_group_worker` has applied the multicast options.
+  bool multicast_configured_ = false;
 };
 
 } // namespace caf::net
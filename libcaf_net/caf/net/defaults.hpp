@@ -27,4 +27,11 @@ CAF_NET_EXPORT extern const uint16_t tcp_port;
 /// least on Linux).
 constexpr auto stream_output_buf_cap = size_t{32768};
 
+/// Number of datagrams a datagram transport reads or writes per system call.
+constexpr auto datagram_batch_size = size_t{32};
+
+/// Number of hops that datagrams to a multicast group may pass. The default
+/// restricts multicast traffic to the local network.
+constexpr auto multicast_ttl = size_t{1};
+
 } // namespace caf::defaults::middleman
@@ -4,9 +4,11 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <string>
 
 #include "caf/actor.hpp"
 #include "caf/actor_clock.hpp"
@@ -17,7 +19,11 @@
 #include "caf/intrusive/singly_linked.hpp"
 #include "caf/mailbox_element.hpp"
 #include "caf/net/endpoint_manager_queue.hpp"
+#include "caf/net/overflow_strategy.hpp"
+#include "caf/net/queue_capacity.hpp"
 #include "caf/net/socket_manager.hpp"
+#include "caf/telemetry/gauge.hpp"
+#include "caf/timespan.hpp"
 #include "caf/variant.hpp"
 
 namespace caf::net {
@@ -29,6 +35,11 @@ public:
 
   using super = socket_manager;
 
+  // -- constants --------------------------------------------------------------
+
+  /// Default value for `caf.middleman.urgent-weight`.
+  static constexpr size_t default_urgent_weight = 4;
+
   // -- constructors, destructors, and assignment operators --------------------
 
   endpoint_manager(socket handle, const multiplexer_ptr& parent,
@@ -44,6 +55,22 @@ public:
 
   const actor_system_config& config() const noexcept;
 
+  /// Returns the number of outbound messages that wait in the queue.
+  size_t queued_messages() const noexcept {
+    return capacity_.messages();
+  }
+
+  /// Returns the estimated size of all outbound messages in the queue.
+  size_t queued_bytes() const noexcept {
+    return capacity_.bytes();
+  }
+
+  /// Returns whether the socket of this manager reported an error. Safe to
+  /// call from any thread.
+  bool disconnected() const noexcept {
+    return disconnected_.load();
+  }
+
   // -- queue access -----------------------------------------------------------
 
   bool at_end_of_message_queue();
@@ -55,8 +82,18 @@ public:
   /// Resolves a path to a remote actor.
   void resolve(uri locator, actor listener);
 
-  /// Enqueues a message to the endpoint.
-  void enqueue(mailbox_element_ptr msg, strong_actor_ptr receiver);
+  /// Enqueues a message to the endpoint. Applies the configured overflow
+  /// strategy if the queue exceeds `caf.middleman.max-queued-messages` or
+  /// `caf.middleman.max-queued-bytes`. With `drop_oldest`, the queue holds up
+  /// to twice the capacity until the I/O thread drops the oldest messages and
+  /// rejects new messages beyond that.
+  /// @returns `true` if the message entered the queue, `false` otherwise.
+  bool enqueue(mailbox_element_ptr msg, strong_actor_ptr receiver);
+
+  /// Enqueues a message that the caller already wrapped for the queue, e.g.,
+  /// for inspecting its size hint first.
+  /// @returns `true` if the message entered the queue, `false` otherwise.
+  bool enqueue(endpoint_manager_queue::message_ptr msg);
 
   /// Enqueues an event to the endpoint.
   template <class... Ts>
@@ -64,21 +101,55 @@ public:
     enqueue(new endpoint_manager_queue::event(std::forward<Ts>(xs)...));
   }
 
+  /// Enqueues a timeout event with `tag` and `id` after `delay`. The
+  /// transport passes the event to the `timeout` member function of its
+  /// application.
+  void set_timeout(timespan delay, std::string tag, uint64_t id = 0);
+
+  /// Enqueues a timeout event with `tag` and `id` to the manager of `target`
+  /// unless the manager no longer exists.
+  /// @thread-safe
+  static void post_event(const event_target_ptr& target, std::string tag,
+                         uint64_t id = 0);
+
   // -- pure virtual member functions ------------------------------------------
 
   /// Initializes the manager before adding it to the multiplexer's event loop.
   // virtual error init() = 0;
 
 protected:
+  // -- member types -----------------------------------------------------------
+
+  // -- utility functions ------------------------------------------------------
+
   bool enqueue(endpoint_manager_queue::element* ptr);
 
+  /// Updates the bookkeeping for a message that left the queue.
+  void remove_queued(size_t size_hint) noexcept;
+
   /// Points to the hosting actor system.
   actor_system& sys_;
 
+  /// Counts the messages in `queue_` and applies the configured capacity.
+  queue_capacity capacity_;
+
+  /// Picks messages from the urgent and the regular lane of `queue_`.
+  endpoint_manager_queue::lane_selector lanes_;
+
+  /// Signals whether the socket reported an error.
+  std::atomic<bool> disconnected_;
+
+  /// Tracks the number of queued messages of all endpoint managers.
+  telemetry::int_gauge* queued_messages_gauge_;
+
+  /// Tracks the number of queued bytes of all endpoint managers.
+  telemetry::int_gauge* queued_bytes_gauge_;
+
   /// Stores control events and outbound messages.
   endpoint_manager_queue::type queue_;
 
-  /// Stores a proxy for interacting with the actor clock.
+  /// Stores a proxy for interacting with the actor clock. The proxy turns
+  /// delayed messages into timeout events.
   actor timeout_proxy_;
 };
 
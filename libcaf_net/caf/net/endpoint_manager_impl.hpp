@@ -52,6 +52,10 @@ public:
     return transport_.init(*this);
   }
 
+  error init(const settings&) override {
+    return init();
+  }
+
   bool handle_read_event() override {
     return transport_.handle_read_event(*this);
   }
@@ -90,6 +94,7 @@ public:
   }
 
   void handle_error(sec code) override {
+    this->disconnected_ = true;
     transport_.handle_error(code);
   }
 
@@ -8,7 +8,6 @@
 
 #include "caf/actor.hpp"
 #include "caf/detail/net_export.hpp"
-#include "caf/detail/serialized_size.hpp"
 #include "caf/fwd.hpp"
 #include "caf/intrusive/drr_queue.hpp"
 #include "caf/intrusive/fifo_inbox.hpp"
@@ -22,7 +21,9 @@ namespace caf::net {
 
 class CAF_NET_EXPORT endpoint_manager_queue {
 public:
-  enum class element_type { event, message };
+  /// Selects the sub-queue of an element. Actor messages with
+  /// `message_priority::high` use the urgent lane.
+  enum class element_type { event, urgent_message, message };
 
   class element : public intrusive::singly_linked<element> {
   public:
@@ -79,6 +80,12 @@ public:
 
     size_t task_size() const noexcept override;
 
+    /// Recycles memory via a node pool.
+    static void* operator new(size_t size);
+
+    /// Returns memory to the node pool.
+    static void operator delete(void* ptr, size_t size) noexcept;
+
     /// Holds the event data.
     variant<resolve_request, new_proxy, local_actor_down, timeout> value;
   };
@@ -113,11 +120,24 @@ public:
     /// ID of the receiving actor.
     strong_actor_ptr receiver;
 
+    /// Estimates the size of the serialized content. The constructor computes
+    /// this value once from the types of the content plus the actual size of
+    /// strings and containers, which allows the queue to schedule messages and
+    /// the writer to reserve buffer space without serializing the content
+    /// twice.
+    size_t size_hint;
+
     message(mailbox_element_ptr msg, strong_actor_ptr receiver);
 
     ~message() override;
 
     size_t task_size() const noexcept override;
+
+    /// Recycles memory via a node pool.
+    static void* operator new(size_t size);
+
+    /// Returns memory to the node pool.
+    static void operator delete(void* ptr, size_t size) noexcept;
   };
 
   using message_ptr = std::unique_ptr<message>;
@@ -138,7 +158,15 @@ public:
     }
 
     static task_size_type task_size(const message& msg) noexcept {
-      return detail::serialized_size(msg.msg->content());
+      return msg.size_hint;
+    }
+  };
+
+  struct urgent_message_policy : message_policy {
+    using queue_type = intrusive::drr_queue<urgent_message_policy>;
+
+    constexpr urgent_message_policy(unit_t x) : message_policy(x) {
+      // nop
     }
   };
 
@@ -175,7 +203,8 @@ public:
     using unique_pointer = std::unique_ptr<element>;
 
     using queue_type = intrusive::wdrr_fixed_multiplexed_queue<
-      categorized, event_policy::queue_type, message_policy::queue_type>;
+      categorized, event_policy::queue_type, urgent_message_policy::queue_type,
+      message_policy::queue_type>;
 
     task_size_type task_size(const message& x) const noexcept {
       return x.task_size();
@@ -183,6 +212,35 @@ public:
   };
 
   using type = intrusive::fifo_inbox<policy>;
+
+  /// Picks the next actor message from the urgent and the regular lane of a
+  /// queue. Serves up to `urgent_weight` urgent messages per regular message.
+  /// The urgent lane only yields to the regular lane if both have pending
+  /// messages, i.e., a steady stream of urgent messages cannot starve regular
+  /// messages and an idle regular lane never delays urgent messages.
+  class CAF_NET_EXPORT lane_selector {
+  public:
+    explicit lane_selector(size_t urgent_weight) noexcept
+      : urgent_weight_(urgent_weight), urgent_streak_(0) {
+      // nop
+    }
+
+    /// Removes the next message from `queue` or returns `nullptr` if both
+    /// lanes are empty.
+    message_ptr next(policy::queue_type& queue);
+
+    size_t urgent_weight() const noexcept {
+      return urgent_weight_;
+    }
+
+  private:
+    /// Configures how many urgent messages `next` returns at most before
+    /// returning a regular message.
+    size_t urgent_weight_;
+
+    /// Counts how many urgent messages `next` returned in a row.
+    size_t urgent_streak_;
+  };
 };
 
 } // namespace caf::net
@@ -16,7 +16,7 @@ namespace caf::net {
 template <class Application>
 class stream_transport;
 
-template <class Factory>
+template <class Factory, class Manager>
 class datagram_transport;
 
 template <class Application, class IdType = unit_t>
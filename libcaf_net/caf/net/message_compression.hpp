@@ -0,0 +1,416 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+#include "caf/actor_system.hpp"
+#include "caf/byte.hpp"
+#include "caf/byte_buffer.hpp"
+#include "caf/byte_span.hpp"
+#include "caf/detail/lz4.hpp"
+#include "caf/detail/network_order.hpp"
+#include "caf/error.hpp"
+#include "caf/net/message_oriented_layer_ptr.hpp"
+#include "caf/net/socket_manager.hpp"
+#include "caf/sec.hpp"
+#include "caf/settings.hpp"
+#include "caf/span.hpp"
+#include "caf/tag/message_oriented.hpp"
+#include "caf/telemetry/counter.hpp"
+#include "caf/telemetry/metric_registry.hpp"
+
+namespace caf::net {
+
+/// Compresses messages of the upper layer with LZ4 if the peer runs a
+/// `message_compression` layer as well and accepts compressed messages. Both
+/// sides announce what they accept in a *hello* message when initializing the
+/// layer. Until receiving the hello of the peer, the layer sends messages
+/// uncompressed.
+///
+/// The layer compresses messages that reach a configurable threshold. If both
+/// sides agree on using a dictionary, the layer uses the most recent 64 KiB of
+/// plaintext as dictionary for compressing subsequent messages. This allows
+/// the layer to compress small messages that repeat patterns of previous
+/// messages, e.g., type names or node IDs.
+///
+/// Each message starts with a flags Byte. Compressed messages add the size of
+/// the plaintext as 32-bit integer in network Byte order.
+template <class UpperLayer>
+class message_compression {
+public:
+  // -- member types -----------------------------------------------------------
+
+  using input_tag = tag::message_oriented;
+
+  using output_tag = tag::message_oriented;
+
+  using clock_type = std::chrono::steady_clock;
+
+  // -- constants --------------------------------------------------------------
+
+  /// Marks a message that carries the accepted encodings of the peer.
+  static constexpr uint8_t hello_flag = 0x80;
+
+  /// Marks a message whose plaintext extends the shared dictionary.
+  static constexpr uint8_t remember_flag = 0x20;
+
+  /// Marks a compressed message that refers to the shared dictionary.
+  static constexpr uint8_t dictionary_flag = 0x10;
+
+  /// Encoding for uncompressed messages.
+  static constexpr uint8_t raw_encoding = 0x00;
+
+  /// Encoding for LZ4-compressed messages.
+  static constexpr uint8_t lz4_encoding = 0x01;
+
+  /// Signals in a hello message that the sender accepts LZ4 messages.
+  static constexpr uint8_t accept_lz4 = 0x01;
+
+  /// Signals in a hello message that the sender accepts dictionaries.
+  static constexpr uint8_t accept_dictionary = 0x02;
+
+  /// Size of the flags Byte plus the size field of compressed messages.
+  static constexpr size_t compressed_header_size = 1 + sizeof(uint32_t);
+
+  /// Default minimum size for compressing a message.
+  static constexpr size_t default_threshold = 256;
+
+  /// Default minimum size for compressing a message with a dictionary.
+  static constexpr size_t default_dictionary_threshold = 32;
+
+  /// Maximum size of a decompressed message.
+  static constexpr size_t max_message_length = INT32_MAX;
+
+  /// Default maximum ratio between the decompressed and the compressed size
+  /// of a message.
+  static constexpr size_t default_max_ratio = detail::lz4::max_ratio;
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  template <class... Ts>
+  explicit message_compression(Ts&&... xs)
+    : upper_layer_(std::forward<Ts>(xs)...) {
+    // nop
+  }
+
+  // -- initialization ---------------------------------------------------------
+
+  template <class LowerLayerPtr>
+  error init(socket_manager* owner, LowerLayerPtr down, const settings& cfg) {
+    enabled_ = get_or(cfg, "caf.middleman.compression.enable", true);
+    use_dictionary_ = get_or(cfg, "caf.middleman.compression.dictionary",
+                             true);
+    threshold_ = get_or(cfg, "caf.middleman.compression.threshold",
+                        default_threshold);
+    dictionary_threshold_ = get_or(
+      cfg, "caf.middleman.compression.dictionary-threshold",
+      default_dictionary_threshold);
+    max_ratio_ = get_or(cfg, "caf.middleman.compression.max-ratio",
+                        default_max_ratio);
+    max_message_size_ = std::min(
+      get_or(cfg, "caf.middleman.compression.max-message-size",
+             max_message_length),
+      max_message_length);
+    if (owner != nullptr)
+      init_metrics(owner->system().metrics());
+    uint8_t accepted = 0;
+    if (enabled_) {
+      accepted |= accept_lz4;
+      if (use_dictionary_)
+        accepted |= accept_dictionary;
+    }
+    down->begin_message();
+    auto& buf = down->message_buffer();
+    buf.push_back(static_cast<byte>(hello_flag));
+    buf.push_back(static_cast<byte>(accepted));
+    if (!down->end_message())
+      return down->abort_reason();
+    return upper_layer_.init(owner, this_layer_ptr(down), cfg);
+  }
+
+  // -- properties -------------------------------------------------------------
+
+  auto& upper_layer() noexcept {
+    return upper_layer_;
+  }
+
+  const auto& upper_layer() const noexcept {
+    return upper_layer_;
+  }
+
+  /// Returns whether the peer accepts compressed messages.
+  bool peer_accepts_compression() const noexcept {
+    return enabled_ && (peer_accepts_ & accept_lz4) != 0;
+  }
+
+  /// Returns whether the peer accepts messages that refer to the dictionary.
+  bool peer_accepts_dictionary() const noexcept {
+    return peer_accepts_compression() && use_dictionary_
+           && (peer_accepts_ & accept_dictionary) != 0;
+  }
+
+  // -- interface for the upper layer ------------------------------------------
+
+  template <class LowerLayerPtr>
+  static bool can_send_more(LowerLayerPtr down) noexcept {
+    return down->can_send_more();
+  }
+
+  template <class LowerLayerPtr>
+  static auto handle(LowerLayerPtr down) noexcept {
+    return down->handle();
+  }
+
+  template <class LowerLayerPtr>
+  void begin_message(LowerLayerPtr down) {
+    down->begin_message();
+    auto& buf = down->message_buffer();
+    message_offset_ = buf.size();
+    buf.push_back(static_cast<byte>(raw_encoding));
+  }
+
+  template <class LowerLayerPtr>
+  byte_buffer& message_buffer(LowerLayerPtr down) {
+    return down->message_buffer();
+  }
+
+  template <class LowerLayerPtr>
+  [[nodiscard]] bool end_message(LowerLayerPtr down) {
+    auto& buf = down->message_buffer();
+    CAF_ASSERT(message_offset_ < buf.size());
+    auto input_size = buf.size() - message_offset_ - 1;
+    auto payload = const_byte_span{buf.data() + message_offset_ + 1,
+                                   input_size};
+    uint8_t flags = raw_encoding;
+    auto with_dictionary = peer_accepts_dictionary();
+    if (with_dictionary)
+      flags |= remember_flag;
+    auto threshold = with_dictionary ? dictionary_threshold_ : threshold_;
+    if (peer_accepts_compression() && input_size >= threshold) {
+      scratch_.clear();
+      auto t0 = clock_type::now();
+      detail::lz4::compress(with_dictionary ? dictionary(out_history_)
+                                            : const_byte_span{},
+                            payload, scratch_);
+      add_time(compression_time_, t0);
+      if (scratch_.size() + compressed_header_size < input_size + 1) {
+        flags |= lz4_encoding;
+        if (with_dictionary) {
+          flags |= dictionary_flag;
+          remember(out_history_, payload);
+        }
+        buf.resize(message_offset_);
+        buf.push_back(static_cast<byte>(flags));
+        auto u32_size = detail::to_network_order(
+          static_cast<uint32_t>(input_size));
+        auto size_bytes = as_bytes(make_span(&u32_size, 1));
+        buf.insert(buf.end(), size_bytes.begin(), size_bytes.end());
+        buf.insert(buf.end(), scratch_.begin(), scratch_.end());
+        add_bytes(input_size, scratch_.size() + compressed_header_size);
+        return down->end_message();
+      }
+    }
+    if (with_dictionary)
+      remember(out_history_, payload);
+    buf[message_offset_] = static_cast<byte>(flags);
+    add_bytes(input_size, input_size + 1);
+    return down->end_message();
+  }
+
+  template <class LowerLayerPtr>
+  static void abort_reason(LowerLayerPtr down, error reason) {
+    return down->abort_reason(std::move(reason));
+  }
+
+  template <class LowerLayerPtr>
+  static const error& abort_reason(LowerLayerPtr down) {
+    return down->abort_reason();
+  }
+
+  // -- interface for the lower layer ------------------------------------------
+
+  template <class LowerLayerPtr>
+  bool prepare_send(LowerLayerPtr down) {
+    return upper_layer_.prepare_send(this_layer_ptr(down));
+  }
+
+  template <class LowerLayerPtr>
+  bool done_sending(LowerLayerPtr down) {
+    return upper_layer_.done_sending(this_layer_ptr(down));
+  }
+
+  template <class LowerLayerPtr>
+  void abort(LowerLayerPtr down, const error& reason) {
+    upper_layer_.abort(this_layer_ptr(down), reason);
+  }
+
+  template <class LowerLayerPtr>
+  ptrdiff_t consume(LowerLayerPtr down, byte_span buffer) {
+    auto fail = [&down](const char* reason) {
+      down->abort_reason(make_error(sec::runtime_error, reason));
+      return ptrdiff_t{-1};
+    };
+    if (buffer.empty())
+      return fail("received empty message");
+    auto flags = static_cast<uint8_t>(buffer[0]);
+    if (!received_hello_) {
+      if (flags != hello_flag || buffer.size() != 2)
+        return fail("expected hello message from peer");
+      received_hello_ = true;
+      peer_accepts_ = static_cast<uint8_t>(buffer[1]);
+      return static_cast<ptrdiff_t>(buffer.size());
+    }
+    if ((flags & (remember_flag | dictionary_flag)) != 0
+        && (!enabled_ || !use_dictionary_))
+      return fail("received dictionary message without accepting them");
+    byte_span payload;
+    switch (flags & ~(remember_flag | dictionary_flag)) {
+      case raw_encoding:
+        if ((flags & dictionary_flag) != 0)
+          return fail("received raw message with dictionary flag");
+        payload = buffer.subspan(1);
+        break;
+      case lz4_encoding: {
+        if (!enabled_)
+          return fail("received compressed message without accepting them");
+        if (buffer.size() < compressed_header_size)
+          return fail("received truncated compressed message");
+        uint32_t u32_size = 0;
+        memcpy(&u32_size, buffer.data() + 1, sizeof(uint32_t));
+        auto size = static_cast<size_t>(detail::from_network_order(u32_size));
+        // Check the claimed size before allocating memory for it. Otherwise,
+        // a few Bytes could make us allocate up to 4 GiB.
+        if (size > max_message_size_)
+          return fail("maximum message size exceeded");
+        auto block_size = buffer.size() - compressed_header_size;
+        if (size > block_size * max_ratio_)
+          return fail("maximum compression ratio exceeded");
+        in_buf_.clear();
+        auto t0 = clock_type::now();
+        auto ok = detail::lz4::decompress(
+          (flags & dictionary_flag) != 0 ? dictionary(in_history_)
+                                         : const_byte_span{},
+          buffer.subspan(compressed_header_size), size, in_buf_);
+        add_time(decompression_time_, t0);
+        if (!ok)
+          return fail("received malformed compressed message");
+        payload = make_span(in_buf_);
+        break;
+      }
+      default:
+        return fail("received message with unknown encoding");
+    }
+    if ((flags & remember_flag) != 0)
+      remember(in_history_, payload);
+    if (upper_layer_.consume(this_layer_ptr(down), payload) < 0)
+      return -1;
+    return static_cast<ptrdiff_t>(buffer.size());
+  }
+
+private:
+  // -- implementation details -------------------------------------------------
+
+  template <class LowerLayerPtr>
+  auto this_layer_ptr(LowerLayerPtr down) {
+    return make_message_oriented_layer_ptr(this, down);
+  }
+
+  static const_byte_span dictionary(const byte_buffer& history) {
+    auto n = std::min(history.size(), detail::lz4::max_offset);
+    return make_span(history).subspan(history.size() - n);
+  }
+
+  static void remember(byte_buffer& history, const_byte_span bytes) {
+    // Trimming only when exceeding twice the dictionary size amortizes the
+    // cost of moving the remaining Bytes to the front.
+    history.insert(history.end(), bytes.begin(), bytes.end());
+    if (history.size() > 2 * detail::lz4::max_offset) {
+      auto excess = history.size() - detail::lz4::max_offset;
+      history.erase(history.begin(), history.begin() + excess);
+    }
+  }
+
+  void init_metrics(telemetry::metric_registry& reg) {
+    input_bytes_ = reg.counter_singleton(
+      "caf.middleman", "compression-input-bytes",
+      "Number of Bytes passed to the compression layer.", "bytes", true);
+    output_bytes_ = reg.counter_singleton(
+      "caf.middleman", "compression-output-bytes",
+      "Number of Bytes produced by the compression layer.", "bytes", true);
+    compression_time_ = reg.counter_singleton(
+      "caf.middleman", "compression-time",
+      "Total CPU time spent on compressing messages.", "nanoseconds", true);
+    decompression_time_ = reg.counter_singleton(
+      "caf.middleman", "decompression-time",
+      "Total CPU time spent on decompressing messages.", "nanoseconds", true);
+  }
+
+  void add_bytes(size_t input_size, size_t output_size) {
+    if (input_bytes_ != nullptr) {
+      input_bytes_->inc(static_cast<int64_t>(input_size));
+      output_bytes_->inc(static_cast<int64_t>(output_size));
+    }
+  }
+
+  void add_time(telemetry::int_counter* counter, clock_type::time_point t0) {
+    if (counter != nullptr) {
+      auto delta = clock_type::now() - t0;
+      using std::chrono::duration_cast;
+      using std::chrono::nanoseconds;
+      counter->inc(duration_cast<nanoseconds>(delta).count());
+    }
+  }
+
+  // -- member variables -------------------------------------------------------
+
+  UpperLayer upper_layer_;
+
+  size_t message_offset_ = 0;
+
+  bool enabled_ = true;
+
+  bool use_dictionary_ = true;
+
+  bool received_hello_ = false;
+
+  uint8_t peer_accepts_ = 0;
+
+  size_t threshold_ = default_threshold;
+
+  size_t dictionary_threshold_ = default_dictionary_threshold;
+
+  /// Configures the maximum ratio between the decompressed and the compressed
+  /// size of incoming messages.
+  size_t max_ratio_ = default_max_ratio;
+
+  /// Configures the maximum size of incoming messages after decompressing.
+  size_t max_message_size_ = max_message_length;
+
+  /// Stores the plaintext of outgoing messages for the dictionary.
+  byte_buffer out_history_;
+
+  /// Stores the plaintext of incoming messages for the dictionary.
+  byte_buffer in_history_;
+
+  /// Stores compressed Bytes before copying them to the message buffer.
+  byte_buffer scratch_;
+
+  /// Stores decompressed Bytes before passing them to the upper layer.
+  byte_buffer in_buf_;
+
+  telemetry::int_counter* input_bytes_ = nullptr;
+
+  telemetry::int_counter* output_bytes_ = nullptr;
+
+  telemetry::int_counter* compression_time_ = nullptr;
+
+  telemetry::int_counter* decompression_time_ = nullptr;
+};
+
+} // namespace caf::net
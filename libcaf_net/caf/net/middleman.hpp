@@ -4,21 +4,28 @@
 
 #pragma once
 
+#include <algorithm>
 #include <chrono>
+#include <memory>
 #include <set>
 #include <string>
 #include <thread>
 
 #include "caf/actor_system.hpp"
+#include "caf/after.hpp"
 #include "caf/detail/net_export.hpp"
 #include "caf/detail/type_list.hpp"
+#include "caf/event_based_actor.hpp"
 #include "caf/fwd.hpp"
 #include "caf/net/connection_acceptor.hpp"
 #include "caf/net/fwd.hpp"
 #include "caf/net/middleman_backend.hpp"
 #include "caf/net/multiplexer.hpp"
+#include "caf/net/remote_actor_cache.hpp"
+#include "caf/net/resolver.hpp"
 #include "caf/net/socket_manager.hpp"
 #include "caf/scoped_actor.hpp"
+#include "caf/timespan.hpp"
 
 namespace caf::net {
 
@@ -32,6 +39,11 @@ public:
 
   using middleman_backend_list = std::vector<middleman_backend_ptr>;
 
+  // -- constants --------------------------------------------------------------
+
+  /// Default value for `caf.middleman.resolve-timeout`.
+  static constexpr timespan default_resolve_timeout = std::chrono::seconds(30);
+
   // -- static utility functions -----------------------------------------------
 
   static void init_global_meta_objects();
@@ -103,32 +115,67 @@ public:
     system().registry().put(path, whom);
   }
 
-  /// Resolves a path to a remote actor.
+  /// Resolves a path to a remote actor. Sends the proxy plus its messaging
+  /// interface or an error to `listener`. Answers from the cache if possible.
+  /// Sends `sec::request_timeout` to `listener` if the backend does not answer
+  /// within `caf.middleman.resolve-timeout`.
   void resolve(const uri& locator, const actor& listener);
 
+  /// Resolves a path to a remote actor asynchronously and calls `f` with
+  /// either the handle or an error. Calls `f` immediately on a cache hit.
+  /// Otherwise, calls `f` from an actor context. Fails with
+  /// `sec::unexpected_actor_messaging_interface` if the peer reports a
+  /// messaging interface for the remote actor that does not include the
+  /// interface of `Handle`.
+  template <class Handle = actor, class F>
+  void remote_actor_async(const uri& locator, F f,
+                          timespan timeout = std::chrono::seconds(5)) {
+    if (auto hit = remote_actors_->get(locator)) {
+      f(to_handle<Handle>(std::move(hit->proxy), hit->ifs));
+      return;
+    }
+    auto helper = [this, locator, f{std::move(f)},
+                   timeout](event_based_actor* self) mutable -> behavior {
+      auto done = [self, f](expected<Handle> result) mutable {
+        f(std::move(result));
+        self->quit();
+      };
+      self->set_error_handler(
+        [done](scheduled_actor*, error& err) mutable { done(std::move(err)); });
+      resolve(locator, actor{self});
+      return {
+        [this, done](strong_actor_ptr& ptr,
+                     std::set<std::string>& ifs) mutable {
+          done(to_handle<Handle>(std::move(ptr), ifs));
+        },
+        [done](sec code) mutable { done(make_error(code)); },
+        after(timeout) >>
+          [done]() mutable {
+            done(make_error(sec::runtime_error,
+                            "manager did not respond with a proxy."));
+          },
+      };
+    };
+    sys_.spawn(std::move(helper));
+  }
+
   template <class Handle = actor, class Duration = std::chrono::seconds>
   expected<Handle>
   remote_actor(const uri& locator, Duration timeout = std::chrono::seconds(5)) {
     scoped_actor self{sys_};
     resolve(locator, self);
-    Handle handle;
-    error err;
+    expected<Handle> result{Handle{}};
     self->receive(
-      [&handle](strong_actor_ptr& ptr, const std::set<std::string>&) {
-        // TODO: This cast is not type-safe.
-        handle = actor_cast<Handle>(std::move(ptr));
+      [&](strong_actor_ptr& ptr, const std::set<std::string>& ifs) {
+        result = to_handle<Handle>(std::move(ptr), ifs);
       },
-      [&err](const error& e) { err = e; },
+      [&result](const error& e) { result = e; },
       after(timeout) >>
-        [&err] {
-          err = make_error(sec::runtime_error,
-                           "manager did not respond with a proxy.");
+        [&result] {
+          result = make_error(sec::runtime_error,
+                              "manager did not respond with a proxy.");
         });
-    if (err)
-      return err;
-    if (handle)
-      return handle;
-    return make_error(sec::runtime_error, "cast to handle-type failed");
+    return result;
   }
 
   // -- properties -------------------------------------------------------------
@@ -159,11 +206,39 @@ public:
 
   middleman_backend* backend(string_view scheme) const noexcept;
 
+  /// Returns the cache for resolved remote actors.
+  remote_actor_cache& remote_actors() noexcept {
+    return *remote_actors_;
+  }
+
+  /// Returns the resolver for host names.
+  resolver& dns() noexcept {
+    return dns_;
+  }
+
   expected<uint16_t> port(string_view scheme) const;
 
 private:
   // -- utility functions ------------------------------------------------------
 
+  /// Converts the result of `resolve` to a handle of type `Handle` after
+  /// checking that `ifs` includes the messaging interface of `Handle`. Peers
+  /// that do not report the interface of their actors send an empty set, in
+  /// which case we skip the check.
+  template <class Handle>
+  expected<Handle> to_handle(strong_actor_ptr ptr,
+                             const std::set<std::string>& ifs) const {
+    if (ptr == nullptr)
+      return make_error(sec::remote_lookup_failed);
+    if (ifs.empty())
+      return actor_cast<Handle>(std::move(ptr));
+    auto expected_ifs = sys_.message_types(detail::type_list<Handle>{});
+    if (!std::includes(ifs.begin(), ifs.end(), expected_ifs.begin(),
+                       expected_ifs.end()))
+      return make_error(sec::unexpected_actor_messaging_interface);
+    return actor_cast<Handle>(std::move(ptr));
+  }
+
   static void create_backends(middleman&, detail::type_list<>) {
     // End of recursion.
   }
@@ -185,6 +260,12 @@ private:
   /// Stores all available backends for managing peers.
   middleman_backend_list backends_;
 
+  /// Caches proxies for recently resolved URIs.
+  std::shared_ptr<remote_actor_cache> remote_actors_;
+
+  /// Resolves host names without blocking the caller.
+  resolver dns_;
+
   /// Runs the multiplexer's event loop
   std::thread mpx_thread_;
 };
@@ -7,7 +7,10 @@
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <utility>
+#include <vector>
 
+#include "caf/callback.hpp"
 #include "caf/detail/net_export.hpp"
 #include "caf/net/fwd.hpp"
 #include "caf/net/operation.hpp"
@@ -32,6 +35,9 @@ public:
 
   using manager_list = std::vector<socket_manager_ptr>;
 
+  /// Receives the manager for a socket in the multiplexer's thread.
+  using manager_callback = unique_callback_ptr<void(socket_manager&)>;
+
   // -- constructors, destructors, and assignment operators --------------------
 
   /// @param parent Points to the owning middleman instance. May be `nullptr`
@@ -74,6 +80,19 @@ public:
   /// @thread-safe
   void init(const socket_manager_ptr& mgr);
 
+  /// Calls `f` with the manager for `handle` in the multiplexer's thread
+  /// unless the multiplexer no longer manages `handle` by then. Allows other
+  /// threads to reach a manager without holding a reference to it.
+  /// @thread-safe
+  void dispatch(socket handle, manager_callback f);
+
+  /// Convenience function for calling `dispatch` with a function object.
+  /// @thread-safe
+  template <class F>
+  void dispatch(socket handle, F f) {
+    dispatch(handle, manager_callback{make_type_erased_callback(std::move(f))});
+  }
+
   /// Closes the pipe for signaling updates to the multiplexer. After closing
   /// the pipe, calls to `update` no longer have any effect.
   /// @thread-safe
@@ -95,6 +114,9 @@ public:
   /// @thread-safe
   void shutdown();
 
+  /// Runs all callbacks from `dispatch`. Called by the pollset updater.
+  void run_dispatched();
+
 protected:
   // -- utility functions ------------------------------------------------------
 
@@ -135,6 +157,13 @@ protected:
 
   /// Signals whether shutdown has been requested.
   bool shutting_down_ = false;
+
+  /// Guards `dispatched_`.
+  std::mutex dispatch_lock_;
+
+  /// Stores callbacks from `dispatch` until the multiplexer's thread runs
+  /// them.
+  std::vector<std::pair<socket, manager_callback>> dispatched_;
 };
 
 } // namespace caf::net
@@ -0,0 +1,50 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "caf/default_enum_inspect.hpp"
+#include "caf/detail/net_export.hpp"
+#include "caf/fwd.hpp"
+
+namespace caf::net {
+
+/// Selects what an endpoint manager does with outbound messages that exceed
+/// the configured capacity of its queue.
+enum class overflow_strategy : uint8_t {
+  /// Rejects the new message. Requests receive an error response.
+  drop_newest,
+  /// Accepts the new message and discards the oldest pending messages when
+  /// the endpoint pulls its next message. Requests receive an error response.
+  drop_oldest,
+  /// Rejects the new message. Requests receive an error response. For all
+  /// other messages, the sender receives the ordinary message
+  /// `(sec::unavailable_or_would_block, actor_addr)` with the address of the
+  /// remote receiver. Actors may handle this message as backpressure signal.
+  /// Actors without a matching handler drop it via their default handler
+  /// instead of terminating.
+  notify_sender,
+};
+
+/// @relates overflow_strategy
+CAF_NET_EXPORT std::string to_string(overflow_strategy x);
+
+/// @relates overflow_strategy
+CAF_NET_EXPORT bool from_string(string_view, overflow_strategy&);
+
+/// @relates overflow_strategy
+CAF_NET_EXPORT bool from_integer(std::underlying_type_t<overflow_strategy>,
+                                 overflow_strategy&);
+
+/// @relates overflow_strategy
+template <class Inspector>
+bool inspect(Inspector& f, overflow_strategy& x) {
+  return default_enum_inspect(f, x);
+}
+
+} // namespace caf::net
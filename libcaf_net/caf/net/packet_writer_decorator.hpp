@@ -39,10 +39,14 @@ public:
     return parent_.transport();
   }
 
-  endpoint_manager& manager() {
+  decltype(auto) manager() {
     return parent_.manager();
   }
 
+  const auto& id() const noexcept {
+    return object_.id();
+  }
+
   byte_buffer next_header_buffer() override {
     return transport().next_header_buffer();
   }
@@ -32,6 +32,8 @@ public:
 
   static constexpr uint8_t shutdown_code = 0x04;
 
+  static constexpr uint8_t dispatch_code = 0x05;
+
   // -- constructors, destructors, and assignment operators --------------------
 
   pollset_updater(pipe_socket read_handle, multiplexer* parent);
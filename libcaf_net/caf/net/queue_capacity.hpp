@@ -0,0 +1,97 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+#include "caf/detail/net_export.hpp"
+#include "caf/fwd.hpp"
+#include "caf/net/endpoint_manager_queue.hpp"
+#include "caf/net/overflow_strategy.hpp"
+
+namespace caf::net {
+
+/// Tracks the messages in the outbound queue of an endpoint manager and
+/// applies `caf.middleman.max-queued-messages`,
+/// `caf.middleman.max-queued-bytes` and `caf.middleman.overflow-strategy`.
+///
+/// Senders call `try_add` concurrently. The check is racy with respect to other
+/// senders, i.e., the queue may exceed its capacity by the number of
+/// concurrent senders. Only the I/O thread calls `remove` and
+/// `must_drop_oldest`. Since it does not pull messages while the socket is
+/// busy, `try_add` accepts up to twice the capacity with `drop_oldest` and
+/// rejects new messages beyond that.
+class CAF_NET_EXPORT queue_capacity {
+public:
+  // -- constructors, destructors, and assignment operators --------------------
+
+  /// @param max_messages Maximum number of queued messages (0 = unlimited).
+  /// @param max_bytes Maximum sum of size hints (0 = unlimited).
+  queue_capacity(size_t max_messages, size_t max_bytes,
+                 overflow_strategy strategy) noexcept;
+
+  /// Reads the capacity from the configuration.
+  explicit queue_capacity(const actor_system_config& cfg);
+
+  // -- properties -------------------------------------------------------------
+
+  /// Returns the number of queued messages.
+  size_t messages() const noexcept {
+    return messages_.load();
+  }
+
+  /// Returns the sum of the size hints of all queued messages.
+  size_t bytes() const noexcept {
+    return bytes_.load();
+  }
+
+  overflow_strategy strategy() const noexcept {
+    return strategy_;
+  }
+
+  // -- bookkeeping ------------------------------------------------------------
+
+  /// Adds a message with given size hint to the bookkeeping unless the queue
+  /// is full.
+  /// @returns `true` if the message may enter the queue, `false` if the caller
+  ///          must reject it.
+  /// @thread-safe
+  bool try_add(size_t size_hint) noexcept;
+
+  /// Removes a message with given size hint from the bookkeeping after it left
+  /// the queue or if it failed to enter the queue after a successful
+  /// `try_add`.
+  void remove(size_t size_hint) noexcept;
+
+  /// Returns whether the I/O thread must drop the message it just pulled from
+  /// the queue (and passed to `remove`) in order to make room for newer
+  /// messages. Only `drop_oldest` drops messages after accepting them.
+  bool must_drop_oldest() const noexcept;
+
+  /// Rejects `x` according to the overflow strategy. Requests always receive
+  /// an error response with `sec::unavailable_or_would_block`. With
+  /// `notify_sender`, the sender of an asynchronous message receives the
+  /// message `(sec::unavailable_or_would_block, actor_addr)` instead, where
+  /// the address denotes the remote receiver. Unlike an `error`, this message
+  /// does not end up in the error handler, so actors that do not handle it
+  /// merely drop it instead of terminating.
+  void reject(const endpoint_manager_queue::message& x) const;
+
+private:
+  bool exceeds(size_t messages, size_t bytes, size_t factor) const noexcept;
+
+  size_t max_messages_;
+
+  size_t max_bytes_;
+
+  overflow_strategy strategy_;
+
+  std::atomic<size_t> messages_;
+
+  std::atomic<size_t> bytes_;
+};
+
+} // namespace caf::net
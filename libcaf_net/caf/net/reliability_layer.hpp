@@ -0,0 +1,363 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "caf/actor.hpp"
+#include "caf/byte_buffer.hpp"
+#include "caf/error.hpp"
+#include "caf/fwd.hpp"
+#include "caf/logger.hpp"
+#include "caf/net/defaults.hpp"
+#include "caf/net/endpoint_manager.hpp"
+#include "caf/net/endpoint_manager_queue.hpp"
+#include "caf/net/network_socket.hpp"
+#include "caf/net/packet_writer.hpp"
+#include "caf/net/receive_policy.hpp"
+#include "caf/net/reliable_session.hpp"
+#include "caf/sec.hpp"
+#include "caf/send.hpp"
+#include "caf/span.hpp"
+#include "caf/string_view.hpp"
+
+namespace caf::net {
+
+/// Runs a stream-oriented application such as `basp::application` on top of
+/// a `datagram_transport`. The layer sits between `transport_worker` and the
+/// application: toward the worker it behaves like an application that
+/// receives one datagram per `handle_data` call, toward the application it
+/// behaves like a stream transport that honors `configure_read`.
+///
+/// A `reliable_session` per peer takes care of acknowledgements,
+/// retransmissions and congestion control. The layer registers a timeout with
+/// the tag `retransmit_tag` for driving retransmissions. Once the peer stops
+/// acknowledging segments, the layer reports `sec::socket_disconnected` to the
+/// application exactly once and ignores all further events.
+///
+/// The application writes a single byte stream, which the layer maps to
+/// `default_stream`. Hence, a lost segment holds back all later messages to
+/// the peer, regardless of sender and receiver. Mapping sender/receiver pairs
+/// to separate streams requires framing each stream on its own, since the
+/// receiving application parses one contiguous byte stream.
+/// @tparam Clock Provides the current time via `Clock::now()`. Unit tests may
+///               substitute a manual clock.
+template <class Application, class Clock = reliable_session::clock_type>
+class reliability_layer {
+public:
+  // -- member types -----------------------------------------------------------
+
+  using application_type = Application;
+
+  using clock_type = Clock;
+
+  using time_point = reliable_session::time_point;
+
+  // -- constants --------------------------------------------------------------
+
+  /// Tags the timeout for retransmitting unacknowledged segments.
+  static constexpr string_view retransmit_tag = "reliability-retransmit";
+
+  /// Carries the byte stream of the application.
+  static constexpr reliable_session::stream_id default_stream = 0;
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  explicit reliability_layer(application_type application,
+                             size_t max_segment_size
+                             = reliable_session::default_max_segment_size)
+    : application_(std::move(application)),
+      session_(max_segment_size),
+      read_policy_(receive_policy::stop()),
+      timer_deadline_(time_point::max()) {
+    // nop
+  }
+
+  // -- properties -------------------------------------------------------------
+
+  application_type& application() noexcept {
+    return application_;
+  }
+
+  const application_type& application() const noexcept {
+    return application_;
+  }
+
+  const reliable_session& session() const noexcept {
+    return session_;
+  }
+
+  /// Returns whether the layer reported an error to the application.
+  bool failed() const noexcept {
+    return failed_;
+  }
+
+  // -- interface functions ----------------------------------------------------
+
+  template <class Parent>
+  error init(Parent& parent) {
+    auto writer = make_writer(parent);
+    if (auto err = application_.init(writer))
+      return err;
+    flush(parent);
+    return none;
+  }
+
+  template <class Parent>
+  error handle_data(Parent& parent, span<const byte> datagram) {
+    if (failed_)
+      return none;
+    if (auto err = session_.handle_datagram(clock_type::now(), datagram)) {
+      CAF_LOG_DEBUG("drop malformed datagram:" << err);
+      return none;
+    }
+    session_.drain(delivered_);
+    for (auto& x : delivered_)
+      if (x.stream == default_stream)
+        rd_buf_.insert(rd_buf_.end(), x.payload.begin(), x.payload.end());
+    delivered_.clear();
+    auto writer = make_writer(parent);
+    auto err = consume(writer);
+    flush(parent);
+    return err;
+  }
+
+  template <class Parent>
+  error write_message(Parent& parent,
+                      std::unique_ptr<endpoint_manager_queue::message> msg) {
+    if (failed_)
+      return sec::socket_disconnected;
+    auto writer = make_writer(parent);
+    auto err = application_.write_message(writer, std::move(msg));
+    flush(parent);
+    return err;
+  }
+
+  template <class Parent>
+  void resolve(Parent& parent, string_view path, const actor& listener) {
+    if (failed_) {
+      anon_send(listener, make_error(sec::socket_disconnected));
+      return;
+    }
+    auto writer = make_writer(parent);
+    application_.resolve(writer, path, listener);
+    flush(parent);
+  }
+
+  template <class Parent>
+  void new_proxy(Parent& parent, actor_id id) {
+    if (failed_)
+      return;
+    auto writer = make_writer(parent);
+    application_.new_proxy(writer, id);
+    flush(parent);
+  }
+
+  template <class Parent>
+  void local_actor_down(Parent& parent, actor_id id, error reason) {
+    if (failed_)
+      return;
+    auto writer = make_writer(parent);
+    application_.local_actor_down(writer, id, std::move(reason));
+    flush(parent);
+  }
+
+  template <class Parent>
+  void timeout(Parent& parent, std::string tag, uint64_t id) {
+    if (failed_)
+      return;
+    if (string_view{tag} == retransmit_tag) {
+      timer_deadline_ = time_point::max();
+    } else {
+      auto writer = make_writer(parent);
+      application_.timeout(writer, std::move(tag), id);
+      // The application may have resumed reading.
+      if (auto err = consume(writer))
+        CAF_LOG_ERROR("application failed to resume reading:" << err);
+    }
+    flush(parent);
+  }
+
+  void handle_error(sec code) {
+    if (failed_)
+      return;
+    failed_ = true;
+    application_.handle_error(code);
+  }
+
+private:
+  // -- nested types -----------------------------------------------------------
+
+  /// Presents the layer as stream transport to the application.
+  template <class Parent>
+  class stream_adapter final : public packet_writer {
+  public:
+    stream_adapter(reliability_layer& layer, Parent& parent)
+      : layer_(layer), parent_(parent) {
+      // nop
+    }
+
+    actor_system& system() {
+      return parent_.system();
+    }
+
+    stream_adapter& transport() {
+      return *this;
+    }
+
+    decltype(auto) manager() {
+      return parent_.manager();
+    }
+
+    /// Returns an invalid socket, since all peers share the datagram socket.
+    network_socket handle() const noexcept {
+      return network_socket{invalid_socket_id};
+    }
+
+    void configure_read(receive_policy policy) {
+      layer_.read_policy_ = policy;
+    }
+
+    byte_buffer next_header_buffer() override {
+      return layer_.next_buffer();
+    }
+
+    byte_buffer next_payload_buffer() override {
+      return layer_.next_buffer();
+    }
+
+  protected:
+    /// Passes the packet to the session as a whole, which saves segments
+    /// compared to sending header and payload separately.
+    void write_impl(span<byte_buffer*> buffers) override {
+      if (buffers.size() == 1) {
+        layer_.session_.send(default_stream, *buffers[0]);
+        layer_.recycle(*buffers[0]);
+        return;
+      }
+      auto& packet = layer_.packet_buf_;
+      for (auto buf : buffers) {
+        packet.insert(packet.end(), buf->begin(), buf->end());
+        layer_.recycle(*buf);
+      }
+      layer_.session_.send(default_stream, packet);
+      packet.clear();
+    }
+
+  private:
+    reliability_layer& layer_;
+    Parent& parent_;
+  };
+
+  // -- utility functions ------------------------------------------------------
+
+  template <class Parent>
+  stream_adapter<Parent> make_writer(Parent& parent) {
+    return {*this, parent};
+  }
+
+  byte_buffer next_buffer() {
+    if (free_bufs_.empty())
+      return {};
+    auto buf = std::move(free_bufs_.back());
+    free_bufs_.pop_back();
+    return buf;
+  }
+
+  /// Keeps the memory of `buf` for later writes.
+  void recycle(byte_buffer& buf) {
+    if (free_bufs_.size() < defaults::middleman::max_payload_buffers) {
+      buf.clear();
+      free_bufs_.emplace_back(std::move(buf));
+    }
+  }
+
+  /// Passes buffered bytes to the application for as long as it reads.
+  template <class Parent>
+  error consume(stream_adapter<Parent>& out) {
+    size_t offset = 0;
+    while (read_policy_.min_size > 0
+           && rd_buf_.size() - offset >= read_policy_.min_size) {
+      auto n = std::min(rd_buf_.size() - offset,
+                        static_cast<size_t>(read_policy_.max_size));
+      auto bytes = make_span(rd_buf_.data() + offset, n);
+      offset += n;
+      if (auto err = application_.handle_data(out, bytes)) {
+        rd_buf_.erase(rd_buf_.begin(), rd_buf_.begin() + offset);
+        return err;
+      }
+    }
+    rd_buf_.erase(rd_buf_.begin(), rd_buf_.begin() + offset);
+    return none;
+  }
+
+  /// Sends everything the session has to send and arms the retransmission
+  /// timer.
+  template <class Parent>
+  void flush(Parent& parent) {
+    auto now = clock_type::now();
+    session_.poll(now, wr_bufs_);
+    if (session_.failed()) {
+      // Tear down once: drop all pending I/O and never re-arm the timer.
+      CAF_LOG_WARNING("peer stopped acknowledging segments");
+      wr_bufs_.clear();
+      rd_buf_.clear();
+      read_policy_ = receive_policy::stop();
+      timer_deadline_ = time_point::max();
+      handle_error(sec::socket_disconnected);
+      return;
+    }
+    for (auto& buf : wr_bufs_)
+      parent.write_packet(buf);
+    wr_bufs_.clear();
+    auto deadline = session_.next_timeout();
+    if (deadline < timer_deadline_) {
+      // Timeouts carry a unique ID for routing them back to this worker.
+      timer_deadline_ = deadline;
+      auto id = next_timer_id_++;
+      parent.transport().set_timeout(id, parent.id());
+      parent.manager().set_timeout(
+        std::max(std::chrono::duration_cast<timespan>(deadline - now),
+                 timespan{0}),
+        to_string(retransmit_tag), id);
+    }
+  }
+
+  // -- member variables -------------------------------------------------------
+
+  application_type application_;
+
+  reliable_session session_;
+
+  /// Stores in-order bytes until the application reads them.
+  byte_buffer rd_buf_;
+
+  receive_policy read_policy_;
+
+  std::vector<reliable_session::delivery> delivered_;
+
+  std::vector<byte_buffer> wr_bufs_;
+
+  /// Stores buffers for the application after passing their content to the
+  /// session.
+  std::vector<byte_buffer> free_bufs_;
+
+  /// Concatenates the buffers of a packet.
+  byte_buffer packet_buf_;
+
+  /// Stores when the pending retransmission timer fires.
+  time_point timer_deadline_;
+
+  /// Signals that the application received an error.
+  bool failed_ = false;
+
+  static inline std::atomic<uint64_t> next_timer_id_{1};
+};
+
+} // namespace caf::net
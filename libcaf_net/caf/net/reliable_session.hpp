@@ -0,0 +1,265 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "caf/byte_buffer.hpp"
+#include "caf/byte_span.hpp"
+#include "caf/detail/net_export.hpp"
+#include "caf/error.hpp"
+#include "caf/timespan.hpp"
+
+namespace caf::net {
+
+/// Implements reliable, ordered delivery on top of an unreliable datagram
+/// channel between two peers. The session splits outgoing data into segments
+/// that fit into a single datagram, acknowledges received segments
+/// cumulatively plus selectively for the next 64 segments, and retransmits
+/// segments on timeout (RFC 6298 estimator) or after three acknowledgements
+/// for later segments. A NewReno-style congestion window limits the number of
+/// unacknowledged segments.
+///
+/// All segments share one sequence space for acknowledgements, but each
+/// stream has its own ordering. Hence, a lost segment only holds back data of
+/// its own stream.
+///
+/// The session performs no I/O and reads no clock. Callers pass received
+/// datagrams to `handle_datagram`, collect outgoing datagrams with `poll` and
+/// call `poll` again once `next_timeout` expires.
+class CAF_NET_EXPORT reliable_session {
+public:
+  // -- member types -----------------------------------------------------------
+
+  using clock_type = std::chrono::steady_clock;
+
+  using time_point = clock_type::time_point;
+
+  using stream_id = uint16_t;
+
+  /// Identifies the kind of a segment on the wire.
+  enum class segment_type : uint8_t {
+    data = 1,
+    ack = 2,
+  };
+
+  /// In-order data for one stream.
+  struct delivery {
+    stream_id stream;
+    byte_buffer payload;
+  };
+
+  // -- constants --------------------------------------------------------------
+
+  /// Size of the segment header in bytes. Data segments carry type, stream,
+  /// sequence number and stream sequence number, acknowledgements carry type,
+  /// the next expected sequence number and the selective acknowledgements.
+  static constexpr size_t header_size = 20;
+
+  /// Payload per segment. Stays below common path MTUs to avoid
+  /// fragmentation on the IP layer.
+  static constexpr size_t default_max_segment_size = 1200;
+
+  /// Congestion window for new sessions in segments.
+  static constexpr size_t initial_window = 4;
+
+  /// Upper bound for the congestion window and the receive window in
+  /// segments.
+  static constexpr size_t max_window = 1024;
+
+  /// Number of acknowledgements for later segments that mark a segment as
+  /// lost.
+  static constexpr size_t dup_threshold = 3;
+
+  /// Number of consecutive timeouts after which the session fails.
+  static constexpr size_t max_retransmissions = 10;
+
+  static constexpr timespan initial_rto = std::chrono::seconds(1);
+
+  static constexpr timespan min_rto = std::chrono::milliseconds(200);
+
+  static constexpr timespan max_rto = std::chrono::seconds(60);
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  /// @pre `max_segment_size > 0`
+  explicit reliable_session(size_t max_segment_size
+                            = default_max_segment_size);
+
+  // -- properties -------------------------------------------------------------
+
+  size_t max_segment_size() const noexcept {
+    return max_segment_size_;
+  }
+
+  /// Returns the current congestion window in segments.
+  size_t congestion_window() const noexcept {
+    return cwnd_;
+  }
+
+  size_t slow_start_threshold() const noexcept {
+    return ssthresh_;
+  }
+
+  timespan smoothed_rtt() const noexcept {
+    return srtt_;
+  }
+
+  timespan retransmission_timeout() const noexcept {
+    return rto_;
+  }
+
+  /// Returns the number of sent segments that wait for an acknowledgement.
+  size_t in_flight() const noexcept {
+    return in_flight_.size();
+  }
+
+  /// Returns the number of segments that wait for room in the congestion
+  /// window.
+  size_t queued() const noexcept {
+    return unsent_.size();
+  }
+
+  /// Returns how many segments the session sent more than once.
+  size_t retransmissions() const noexcept {
+    return retransmissions_;
+  }
+
+  /// Returns whether `poll` has nothing to send and no segment waits for an
+  /// acknowledgement.
+  bool idle() const noexcept {
+    return in_flight_.empty() && unsent_.empty() && !ack_pending_;
+  }
+
+  /// Returns whether the peer failed to acknowledge a segment for
+  /// `max_retransmissions` timeouts in a row.
+  bool failed() const noexcept {
+    return backoffs_ >= max_retransmissions;
+  }
+
+  /// Returns when the session needs to retransmit or `time_point::max()` if
+  /// no segment waits for an acknowledgement.
+  time_point next_timeout() const noexcept {
+    return rto_deadline_;
+  }
+
+  // -- sending ----------------------------------------------------------------
+
+  /// Splits `bytes` into segments for `stream` and queues them for sending.
+  void send(stream_id stream, const_byte_span bytes);
+
+  /// Appends all datagrams that the session may send at `now` to `out`:
+  /// pending acknowledgements, retransmissions and queued segments that fit
+  /// into the congestion window.
+  void poll(time_point now, std::vector<byte_buffer>& out);
+
+  // -- receiving --------------------------------------------------------------
+
+  /// Processes a datagram from the peer.
+  error handle_datagram(time_point now, const_byte_span datagram);
+
+  /// Moves all data that became available in order to `out`.
+  void drain(std::vector<delivery>& out);
+
+private:
+  // -- member types -----------------------------------------------------------
+
+  struct segment {
+    stream_id stream = 0;
+    uint64_t stream_seq = 0;
+    byte_buffer payload;
+    time_point sent;
+    bool retransmitted = false;
+    bool lost = false;
+    size_t dup_acks = 0;
+  };
+
+  struct stream_state {
+    uint64_t next_send = 0;
+    uint64_t next_receive = 0;
+    /// Stores out-of-order segments. Holds less than `max_window` entries.
+    std::map<uint64_t, byte_buffer> pending;
+  };
+
+  // -- utility functions ------------------------------------------------------
+
+  error handle_data(uint64_t seq, stream_id stream, uint64_t stream_seq,
+                    const_byte_span payload);
+
+  error handle_ack(time_point now, uint64_t next_expected, uint64_t sack);
+
+  void retransmit(time_point now, uint64_t seq, segment& x,
+                  std::vector<byte_buffer>& out);
+
+  void update_rtt(timespan sample);
+
+  void grow_window(size_t acked);
+
+  void enter_recovery();
+
+  uint64_t send_unacknowledged() const noexcept {
+    return in_flight_.empty() ? next_seq_ : in_flight_.begin()->first;
+  }
+
+  // -- sender state -----------------------------------------------------------
+
+  size_t max_segment_size_;
+
+  uint64_t next_seq_ = 0;
+
+  std::deque<segment> unsent_;
+
+  std::map<uint64_t, segment> in_flight_;
+
+  size_t cwnd_ = initial_window;
+
+  size_t ssthresh_ = max_window;
+
+  /// Counts acknowledged segments during congestion avoidance.
+  size_t ca_acked_ = 0;
+
+  bool in_recovery_ = false;
+
+  /// Ends the current recovery once acknowledged cumulatively.
+  uint64_t recovery_point_ = 0;
+
+  bool has_rtt_ = false;
+
+  timespan srtt_{0};
+
+  timespan rttvar_{0};
+
+  timespan rto_ = initial_rto;
+
+  time_point rto_deadline_ = time_point::max();
+
+  size_t backoffs_ = 0;
+
+  size_t retransmissions_ = 0;
+
+  // -- receiver state ---------------------------------------------------------
+
+  uint64_t next_expected_ = 0;
+
+  /// Received sequence numbers above `next_expected_`.
+  std::set<uint64_t> received_;
+
+  bool ack_pending_ = false;
+
+  std::vector<delivery> delivered_;
+
+  // -- shared state -----------------------------------------------------------
+
+  std::unordered_map<stream_id, stream_state> streams_;
+};
+
+} // namespace caf::net
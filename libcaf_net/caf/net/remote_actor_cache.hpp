@@ -0,0 +1,100 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "caf/actor_addr.hpp"
+#include "caf/actor_control_block.hpp"
+#include "caf/detail/net_export.hpp"
+#include "caf/fwd.hpp"
+#include "caf/optional.hpp"
+#include "caf/timespan.hpp"
+#include "caf/uri.hpp"
+
+namespace caf::net {
+
+/// Caches the results of resolving remote actors by their URI. Entries expire
+/// after a configurable time-to-live or when their proxy gets killed, e.g.,
+/// because the remote actor terminated or the connection broke down.
+/// @thread-safe
+class CAF_NET_EXPORT remote_actor_cache
+  : public std::enable_shared_from_this<remote_actor_cache> {
+public:
+  // -- member types -----------------------------------------------------------
+
+  using clock_type = std::chrono::steady_clock;
+
+  using time_point = clock_type::time_point;
+
+  struct entry {
+    strong_actor_ptr proxy;
+    std::set<std::string> ifs;
+    time_point expires;
+  };
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  /// @param ttl Configures how long entries remain valid. Passing 0 disables
+  ///            the cache.
+  explicit remote_actor_cache(timespan ttl);
+
+  // -- properties -------------------------------------------------------------
+
+  /// Returns whether the cache stores any entries at all.
+  bool enabled() const noexcept {
+    return ttl_.count() > 0;
+  }
+
+  /// Returns the number of stored entries, including expired entries that
+  /// were not pruned yet.
+  size_t size() const;
+
+  /// Returns the number of proxies with an attached functor.
+  size_t num_attached() const;
+
+  // -- lookups ----------------------------------------------------------------
+
+  /// Returns the proxy and its messaging interface for `locator` unless the
+  /// entry expired or does not exist.
+  optional<entry> get(const uri& locator, time_point now = clock_type::now());
+
+  // -- modifiers --------------------------------------------------------------
+
+  /// Stores `proxy` as result for resolving `locator`. The entry disappears
+  /// once the proxy gets killed. Attaches at most one functor to each proxy,
+  /// regardless of how many entries refer to it.
+  void put(const uri& locator, strong_actor_ptr proxy,
+           std::set<std::string> ifs, time_point now = clock_type::now());
+
+  /// Drops the entry for `locator`.
+  void erase(const uri& locator);
+
+  /// Drops all entries.
+  void clear();
+
+private:
+  /// Drops all entries for the proxy `addr`.
+  void erase(const actor_addr& addr);
+
+  timespan ttl_;
+
+  mutable std::mutex mtx_;
+
+  std::unordered_map<std::string, entry> entries_;
+
+  /// Lists all proxies with an attached functor. Holding weak references
+  /// prevents the addresses from getting reused for other actors.
+  std::unordered_set<actor_addr> attached_;
+};
+
+} // namespace caf::net
@@ -0,0 +1,175 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "caf/callback.hpp"
+#include "caf/detail/net_export.hpp"
+#include "caf/fwd.hpp"
+#include "caf/ip_address.hpp"
+#include "caf/optional.hpp"
+#include "caf/timespan.hpp"
+
+namespace caf::net {
+
+/// Resolves host names on dedicated threads and caches the results. Failed
+/// lookups are cached as well (for a separate, usually shorter, time-to-live)
+/// to keep reconnect attempts from flooding the system resolver. Concurrent
+/// requests for the same host share a single lookup.
+/// @thread-safe
+class CAF_NET_EXPORT resolver {
+public:
+  // -- member types -----------------------------------------------------------
+
+  using clock_type = std::chrono::steady_clock;
+
+  using time_point = clock_type::time_point;
+
+  using address_list = std::vector<ip_address>;
+
+  /// Performs the actual, blocking lookup. Returns an empty list on error.
+  using lookup_function = std::function<address_list(const std::string&)>;
+
+  /// Receives the result of an asynchronous lookup. An empty list signals
+  /// that the host name did not resolve to any address.
+  using handler_type = unique_callback_ptr<void(const address_list&)>;
+
+  // -- constants --------------------------------------------------------------
+
+  static constexpr timespan default_ttl = std::chrono::seconds(60);
+
+  static constexpr timespan default_negative_ttl = std::chrono::seconds(5);
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  /// @param lookup Resolves host names. Defaults to `ip::resolve` if empty.
+  /// @param ttl Configures how long successful lookups remain valid.
+  /// @param negative_ttl Configures how long failed lookups remain valid.
+  explicit resolver(lookup_function lookup = nullptr,
+                    timespan ttl = default_ttl,
+                    timespan negative_ttl = default_negative_ttl);
+
+  resolver(const resolver&) = delete;
+
+  resolver& operator=(const resolver&) = delete;
+
+  ~resolver();
+
+  // -- properties -------------------------------------------------------------
+
+  /// Returns the number of cached results, including expired results that
+  /// were not pruned yet.
+  size_t size() const;
+
+  /// Returns whether the resolver runs any background thread.
+  bool running() const;
+
+  /// Returns whether `stop` was called without calling `start` afterwards.
+  bool stopped() const;
+
+  // -- lifetime management ----------------------------------------------------
+
+  /// Spawns `num_threads` threads for performing lookups.
+  void start(size_t num_threads = 1);
+
+  /// Stops all threads. Calls the handlers of pending lookups with an empty
+  /// list. Afterwards, all lookups return an empty list immediately until
+  /// calling `start` again. Does not wait for threads that are busy with a
+  /// lookup, since the system resolver may block for a long time. These
+  /// threads terminate on their own once the lookup returns.
+  void stop();
+
+  // -- lookups ----------------------------------------------------------------
+
+  /// Returns the cached result for `host` unless it expired.
+  optional<address_list> cached(const std::string& host,
+                                time_point now = clock_type::now());
+
+  /// Resolves `host` in the background and calls `f` with the result. Calls
+  /// `f` immediately on a cache hit. Otherwise, calls `f` from one of the
+  /// resolver threads.
+  void async_resolve(const std::string& host, handler_type f);
+
+  /// Convenience function for calling `async_resolve` with a function object.
+  template <class F>
+  void async_resolve(const std::string& host, F f) {
+    async_resolve(host, handler_type{make_type_erased_callback(std::move(f))});
+  }
+
+  /// Resolves `host` and blocks the caller until the result becomes
+  /// available. Performs the lookup on the calling thread if the resolver
+  /// was never started.
+  address_list resolve(const std::string& host);
+
+  // -- modifiers --------------------------------------------------------------
+
+  /// Replaces the function for resolving host names, e.g., with a stub for
+  /// testing. Drops all cached results.
+  void set_lookup_function(lookup_function lookup);
+
+  /// Drops all cached results.
+  void clear();
+
+private:
+  // -- member types -----------------------------------------------------------
+
+  struct entry {
+    address_list addresses;
+    time_point expires;
+  };
+
+  /// Holds everything the threads access. Each thread keeps the state alive,
+  /// because `stop` detaches threads that may still block in a lookup.
+  struct shared_state {
+    shared_state(lookup_function lookup, timespan ttl, timespan negative_ttl);
+
+    /// Processes jobs until `generation` changes.
+    void run(size_t gen);
+
+    /// Stores the result for `host` and dispatches it to all waiting handlers.
+    void complete(const std::string& host, address_list addresses);
+
+    timespan ttl;
+
+    timespan negative_ttl;
+
+    std::mutex mtx;
+
+    std::condition_variable cv;
+
+    lookup_function lookup;
+
+    bool shutting_down = false;
+
+    /// Increases with each call to `stop`. Threads of older generations
+    /// terminate after finishing their current lookup.
+    size_t generation = 0;
+
+    size_t num_threads = 0;
+
+    /// Stores host names that wait for a thread.
+    std::deque<std::string> jobs;
+
+    /// Stores the handlers for each host name that we currently resolve.
+    std::unordered_map<std::string, std::vector<handler_type>> pending;
+
+    std::unordered_map<std::string, entry> entries;
+  };
+
+  // -- member variables -------------------------------------------------------
+
+  std::shared_ptr<shared_state> state_;
+};
+
+} // namespace caf::net
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include "caf/actor.hpp"
 #include "caf/actor_system.hpp"
 #include "caf/callback.hpp"
@@ -29,6 +31,18 @@ public:
 
   using fallback_handler = unique_callback_ptr<result<message>(message&)>;
 
+  using manager_callback = unique_callback_ptr<void(socket_manager&)>;
+
+  /// Allows other threads to reach a manager via its multiplexer without
+  /// holding a reference to the manager. A thread that holds a raw pointer
+  /// instead may run concurrently to the destructor of the manager.
+  struct event_target {
+    multiplexer* mpx;
+    socket handle;
+  };
+
+  using event_target_ptr = std::shared_ptr<const event_target>;
+
   // -- constructors, destructors, and assignment operators --------------------
 
   /// @pre `handle != invalid_socket`
@@ -122,6 +136,24 @@ public:
     return make_actor_shell<Handle>(down, std::move(f));
   }
 
+  // -- event targets ----------------------------------------------------------
+
+  /// Returns a target for `post`. Must run on the multiplexer's thread.
+  event_target_ptr make_event_target();
+
+  /// Calls `f` with the manager of `target` on the multiplexer's thread unless
+  /// the manager no longer exists by then. Also drops `f` if the OS reused the
+  /// socket for another manager in the meantime.
+  /// @thread-safe
+  static void post(const event_target_ptr& target, manager_callback f);
+
+  /// Convenience function for calling `post` with a function object.
+  /// @thread-safe
+  template <class F>
+  static void post(const event_target_ptr& target, F f) {
+    post(target, manager_callback{make_type_erased_callback(std::move(f))});
+  }
+
   // -- event loop management --------------------------------------------------
 
   void register_reading();
@@ -152,6 +184,10 @@ protected:
   multiplexer* parent_;
 
   error abort_reason_;
+
+  /// Identifies this manager for `post`, also in case the OS reuses the
+  /// socket for a new manager.
+  event_target_ptr event_target_;
 };
 
 template <class Protocol>
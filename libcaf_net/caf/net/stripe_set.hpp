@@ -0,0 +1,108 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "caf/net/endpoint_manager.hpp"
+
+namespace caf::net {
+
+/// Lists all connections to a peer. The backend and all proxies for the peer
+/// share the same set. The set has a fixed number of slots, one per configured
+/// connection. The first slot holds the connection that carries all control
+/// traffic. The backend publishes a new snapshot whenever it fills a slot.
+/// Hence, proxies always see the current connections without any locking.
+///
+/// Each sender/receiver pair maps to a fixed slot. Messages of a pair use the
+/// connection in this slot and thus arrive in order. While the slot is empty or
+/// its connection failed, messages of the pair use the first connection
+/// instead. Messages may overtake each other whenever a pair moves between
+/// connections, i.e., when the backend connects a slot for the first time,
+/// when the connection of a slot fails, and when the backend fills the slot
+/// with a new connection afterwards.
+class stripe_set {
+public:
+  // -- member types -----------------------------------------------------------
+
+  using list = std::vector<endpoint_manager_ptr>;
+
+  using list_ptr = std::shared_ptr<const list>;
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  /// @param first The connection for control traffic.
+  /// @param num_slots The maximum number of connections.
+  explicit stripe_set(endpoint_manager_ptr first, size_t num_slots = 1) {
+    auto xs = std::make_shared<list>(std::max(num_slots, size_t{1}));
+    xs->front() = std::move(first);
+    list_ = std::move(xs);
+  }
+
+  // -- properties -------------------------------------------------------------
+
+  /// Returns the current connections. Empty slots hold `nullptr`.
+  list_ptr snapshot() const {
+    return std::atomic_load(&list_);
+  }
+
+  /// Returns the first connection.
+  endpoint_manager_ptr front() const {
+    return snapshot()->front();
+  }
+
+  /// Returns the connection for messages from `sender` to `receiver`.
+  endpoint_manager_ptr select(const actor_control_block* sender,
+                              actor_id receiver) const {
+    auto xs = snapshot();
+    if (xs->size() == 1)
+      return xs->front();
+    auto h = std::hash<const actor_control_block*>{}(sender);
+    h ^= std::hash<actor_id>{}(receiver) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    auto& x = (*xs)[h % xs->size()];
+    if (x == nullptr || x->disconnected())
+      return xs->front();
+    return x;
+  }
+
+  /// Returns whether all slots hold a working connection.
+  bool full() const {
+    auto xs = snapshot();
+    return std::none_of(xs->begin() + 1, xs->end(), vacant);
+  }
+
+  // -- modifiers --------------------------------------------------------------
+
+  /// Puts `x` into the first empty slot or into the first slot with a failed
+  /// connection.
+  /// @returns `false` if all slots hold a working connection, `true`
+  ///          otherwise.
+  /// @pre Callers serialize all modifications.
+  bool add(endpoint_manager_ptr x) {
+    auto xs = snapshot();
+    auto i = std::find_if(xs->begin() + 1, xs->end(), vacant);
+    if (i == xs->end())
+      return false;
+    auto copy = std::make_shared<list>(*xs);
+    (*copy)[static_cast<size_t>(std::distance(xs->begin(), i))] = std::move(x);
+    std::atomic_store(&list_, list_ptr{std::move(copy)});
+    return true;
+  }
+
+private:
+  static bool vacant(const endpoint_manager_ptr& x) {
+    return x == nullptr || x->disconnected();
+  }
+
+  list_ptr list_;
+};
+
+using stripe_set_ptr = std::shared_ptr<stripe_set>;
+
+} // namespace caf::net
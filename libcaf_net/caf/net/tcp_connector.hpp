@@ -0,0 +1,93 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "caf/callback.hpp"
+#include "caf/detail/net_export.hpp"
+#include "caf/error.hpp"
+#include "caf/expected.hpp"
+#include "caf/ip_endpoint.hpp"
+#include "caf/net/fwd.hpp"
+#include "caf/net/socket_manager.hpp"
+#include "caf/net/tcp_stream_socket.hpp"
+
+namespace caf::net {
+
+/// Waits for a nonblocking connection attempt on the multiplexer. Multiple
+/// connectors may race for the same peer by sharing a single `race` state, in
+/// which case the first connector that establishes its connection wins and
+/// all others close their sockets once they complete.
+class CAF_NET_EXPORT tcp_connector : public socket_manager {
+public:
+  // -- member types -----------------------------------------------------------
+
+  using super = socket_manager;
+
+  /// Receives the connected socket or the error of the last failed attempt.
+  using handler_type = unique_callback_ptr<void(expected<tcp_stream_socket>)>;
+
+  /// Shared state of all connectors racing for the same peer. Only accessed
+  /// from the multiplexer thread after starting the race.
+  struct race {
+    /// Counts connectors that did not complete yet.
+    size_t pending = 0;
+
+    /// Signals that some connector has called `handler` already.
+    bool done = false;
+
+    /// Stores the error of the last failed attempt.
+    error last_error;
+
+    handler_type handler;
+  };
+
+  using race_ptr = std::shared_ptr<race>;
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  tcp_connector(tcp_stream_socket handle, multiplexer* parent, race_ptr state);
+
+  ~tcp_connector() override;
+
+  // -- factories --------------------------------------------------------------
+
+  /// Connects to all `endpoints` in parallel and calls `f` with the first
+  /// socket that connects successfully. Calls `f` with an error if all
+  /// attempts fail. Usually calls `f` from the multiplexer thread, but calls
+  /// it immediately if no attempt could start at all.
+  static void start(multiplexer& mpx, const std::vector<ip_endpoint>& endpoints,
+                    handler_type f);
+
+  // -- properties -------------------------------------------------------------
+
+  /// Returns the managed socket.
+  tcp_stream_socket handle() const noexcept {
+    return socket_cast<tcp_stream_socket>(handle_);
+  }
+
+  // -- interface functions ----------------------------------------------------
+
+  error init(const settings& config) override;
+
+  bool handle_read_event() override;
+
+  bool handle_write_event() override;
+
+  void handle_error(sec code) override;
+
+private:
+  /// Records a failed attempt and reports an error if all attempts failed.
+  void fail(error reason);
+
+  race_ptr race_;
+
+  /// Guards against reporting the result of this attempt more than once.
+  bool completed_ = false;
+};
+
+} // namespace caf::net
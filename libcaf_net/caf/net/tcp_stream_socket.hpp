@@ -33,4 +33,18 @@ expected<tcp_stream_socket>
 expected<tcp_stream_socket> CAF_NET_EXPORT
 make_connected_tcp_stream_socket(const uri::authority_type& node);
 
+/// Creates a nonblocking `tcp_stream_socket` and starts connecting it to
+/// given remote node. The socket becomes writable once the connection attempt
+/// completes, at which point `connect_result` reports the outcome.
+/// @param node Host and port of the remote node.
+/// @returns The connecting socket or an error.
+/// @relates tcp_stream_socket
+expected<tcp_stream_socket>
+  CAF_NET_EXPORT make_connecting_tcp_stream_socket(ip_endpoint node);
+
+/// Returns the outcome of a nonblocking connection attempt on `x`.
+/// @pre `x` became writable after calling `make_connecting_tcp_stream_socket`
+/// @relates tcp_stream_socket
+error CAF_NET_EXPORT connect_result(tcp_stream_socket x);
+
 } // namespace caf::net
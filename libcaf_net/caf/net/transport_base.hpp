@@ -10,6 +10,7 @@
 #include "caf/fwd.hpp"
 #include "caf/logger.hpp"
 #include "caf/net/defaults.hpp"
+#include "caf/net/fwd.hpp"
 #include "caf/net/receive_policy.hpp"
 
 namespace caf::net {
@@ -22,8 +23,10 @@ namespace caf::net {
 /// @tparam Application The type of the application used in this stack.
 /// @tparam IdType The id type of the derived transport, must match the IdType
 /// of `NextLayer`.
+/// @tparam Manager The type of the manager that owns the transport. Unit
+/// tests may substitute a manager that lives outside of a multiplexer.
 template <class Transport, class NextLayer, class Handle, class Application,
-          class IdType>
+          class IdType, class Manager = endpoint_manager>
 class transport_base {
 public:
   // -- member types -----------------------------------------------------------
@@ -38,6 +41,8 @@ public:
 
   using id_type = IdType;
 
+  using manager_type = Manager;
+
   using buffer_cache_type = std::vector<byte_buffer>;
 
   // -- constructors, destructors, and assignment operators --------------------
@@ -70,9 +75,9 @@ public:
     return *reinterpret_cast<transport_type*>(this);
   }
 
-  /// Returns a reference to the `endpoint_manager` of this transport.
+  /// Returns a reference to the manager of this transport.
   /// @pre `init` must be called before calling this getter.
-  endpoint_manager& manager() {
+  manager_type& manager() {
     CAF_ASSERT(manager_);
     return *manager_;
   }
@@ -80,9 +85,9 @@ public:
   // -- transport member functions ---------------------------------------------
 
   /// Initializes this transport.
-  /// @param parent The `endpoint_manager` that manages this transport.
+  /// @param parent The manager of this transport.
   /// @returns `error` on failure, none on success.
-  virtual error init(endpoint_manager& parent) {
+  virtual error init(manager_type& parent) {
     CAF_LOG_TRACE("");
     manager_ = &parent;
     auto& cfg = system().config();
@@ -104,7 +109,7 @@ public:
   /// listener on success - an `error` otherwise.
   /// @param locator The `uri` of the remote actor.
   /// @param listener The `actor_handle` which the result should be sent to.
-  auto resolve(endpoint_manager&, const uri& locator, const actor& listener) {
+  auto resolve(manager_type&, const uri& locator, const actor& listener) {
     CAF_LOG_TRACE(CAF_ARG(locator) << CAF_ARG(listener));
     auto f = detail::make_overload(
       [&](auto& layer) -> decltype(layer.resolve(*this, locator, listener)) {
@@ -120,7 +125,7 @@ public:
   /// Gets called by an actor proxy after creation.
   /// @param peer The `node_id` of the remote node.
   /// @param id The id of the remote actor.
-  void new_proxy(endpoint_manager&, const node_id& peer, actor_id id) {
+  void new_proxy(manager_type&, const node_id& peer, actor_id id) {
     next_layer_.new_proxy(*this, peer, id);
   }
 
@@ -128,7 +133,7 @@ public:
   /// @param peer The `node_id` of the remote endpoint.
   /// @param id The `actor_id` of the remote actor.
   /// @param reason The reason why the local actor has shut down.
-  void local_actor_down(endpoint_manager&, const node_id& peer, actor_id id,
+  void local_actor_down(manager_type&, const node_id& peer, actor_id id,
                         error reason) {
     next_layer_.local_actor_down(*this, peer, id, std::move(reason));
   }
@@ -137,7 +142,7 @@ public:
   /// was triggered.
   /// @param tag The type tag of the timeout.
   /// @param id The timeout id of the timeout.
-  void timeout(endpoint_manager&, std::string tag, uint64_t id) {
+  void timeout(manager_type&, std::string tag, uint64_t id) {
     next_layer_.timeout(*this, std::move(tag), id);
   }
 
@@ -161,11 +166,11 @@ public:
 
   /// Called by the endpoint manager when the transport can read data from its
   /// socket.
-  virtual bool handle_read_event(endpoint_manager&) = 0;
+  virtual bool handle_read_event(manager_type&) = 0;
 
   /// Called by the endpoint manager when the transport can write data to its
   /// socket.
-  virtual bool handle_write_event(endpoint_manager& parent) = 0;
+  virtual bool handle_write_event(manager_type& parent) = 0;
 
   /// Queues a packet scattered across multiple buffers to be sent via this
   /// transport.
@@ -207,7 +212,7 @@ protected:
 
   byte_buffer read_buf_;
 
-  endpoint_manager* manager_;
+  manager_type* manager_;
 
   size_t max_consecutive_reads_;
 };
@@ -4,8 +4,10 @@
 
 #pragma once
 
-#include <unordered_map>
+#include <deque>
+#include <type_traits>
 
+#include "caf/detail/flat_hash_map.hpp"
 #include "caf/logger.hpp"
 #include "caf/net/endpoint_manager_queue.hpp"
 #include "caf/net/fwd.hpp"
@@ -16,7 +18,27 @@
 
 namespace caf::net {
 
+/// Evaluates to `true` if `Application` declares a static member
+/// `handshake_free` with value `true`, i.e., if the application never expects
+/// an answer from its peer before sending messages. Only such applications may
+/// run on group workers.
+template <class Application, class = void>
+struct is_handshake_free : std::false_type {};
+
+template <class Application>
+struct is_handshake_free<Application,
+                         std::void_t<decltype(Application::handshake_free)>>
+  : std::bool_constant<Application::handshake_free> {};
+
+template <class Application>
+constexpr bool is_handshake_free_v = is_handshake_free<Application>::value;
+
 /// Implements a dispatcher that dispatches between transport and workers.
+///
+/// The dispatcher owns its workers and stores them in a deque, i.e., workers
+/// never move in memory. All lookup tables map to plain pointers and a cache
+/// for the most recent sender skips the table lookup for bursts of datagrams
+/// from the same peer.
 template <class Factory, class IdType>
 class transport_worker_dispatcher {
 public:
@@ -30,7 +52,7 @@ public:
 
   using worker_type = transport_worker<application_type, id_type>;
 
-  using worker_ptr = transport_worker_ptr<application_type, id_type>;
+  using worker_ptr = worker_type*;
 
   // -- constructors, destructors, and assignment operators --------------------
 
@@ -99,35 +121,51 @@ public:
 
   template <class... Ts>
   void set_timeout(uint64_t timeout_id, id_type id, Ts&&...) {
-    workers_by_timeout_id_.emplace(timeout_id, workers_by_id_.at(id));
+    if (auto worker = find_worker(id))
+      workers_by_timeout_id_.emplace(timeout_id, worker);
   }
 
   template <class Parent>
   void timeout(Parent& parent, std::string tag, uint64_t id) {
-    if (auto worker = workers_by_timeout_id_.at(id)) {
-      worker->timeout(parent, std::move(tag), id);
-      workers_by_timeout_id_.erase(id);
+    auto i = workers_by_timeout_id_.find(id);
+    if (i == nullptr) {
+      CAF_LOG_DEBUG("drop timeout without worker:" << CAF_ARG(tag)
+                                                   << CAF_ARG(id));
+      return;
     }
+    auto worker = *i;
+    workers_by_timeout_id_.erase(id);
+    worker->timeout(parent, std::move(tag), id);
   }
 
   void handle_error(sec error) {
-    for (const auto& p : workers_by_id_) {
-      auto worker = p.second;
-      worker->handle_error(error);
-    }
+    for (auto& worker : workers_)
+      worker.handle_error(error);
   }
 
   template <class Parent>
   expected<worker_ptr> add_new_worker(Parent& parent, node_id node,
                                       id_type id) {
     CAF_LOG_TRACE(CAF_ARG(node) << CAF_ARG(id));
-    auto application = factory_.make();
-    auto worker = std::make_shared<worker_type>(std::move(application), id);
-    if (auto err = worker->init(parent))
+    auto& worker = workers_.emplace_back(factory_.make(), id);
+    if (auto err = worker.init(parent)) {
+      workers_.pop_back();
       return err;
-    workers_by_id_.emplace(std::move(id), worker);
-    workers_by_node_.emplace(std::move(node), worker);
-    return worker;
+    }
+    workers_by_id_.emplace(std::move(id), &worker);
+    workers_by_node_.emplace(std::move(node), &worker);
+    return &worker;
+  }
+
+  /// Adds a worker that sends all messages for `node` to the multicast group
+  /// `group`. Each group member receives the same datagrams, which rules out
+  /// applications that negotiate with their peer, e.g., `basp::application`.
+  template <class Parent>
+  expected<worker_ptr> add_group_worker(Parent& parent, node_id node,
+                                        id_type group) {
+    static_assert(is_handshake_free_v<application_type>,
+                  "group workers require a handshake-free application");
+    return add_new_worker(parent, std::move(node), std::move(group));
   }
 
 private:
@@ -136,24 +174,40 @@ private:
   }
 
   worker_ptr find_worker(const id_type& id) {
-    return find_worker_impl(workers_by_id_, id);
+    // Datagrams tend to arrive in bursts from the same peer.
+    if (last_worker_ != nullptr && last_id_ == id)
+      return last_worker_;
+    if (auto worker = find_worker_impl(workers_by_id_, id)) {
+      last_id_ = id;
+      last_worker_ = worker;
+      return worker;
+    }
+    return nullptr;
   }
 
   template <class Key>
-  worker_ptr find_worker_impl(const std::unordered_map<Key, worker_ptr>& map,
-                              const Key& key) {
-    if (map.count(key) == 0) {
-      CAF_LOG_DEBUG("could not find worker: " << CAF_ARG(key));
-      return nullptr;
-    }
-    return map.at(key);
+  worker_ptr
+  find_worker_impl(const detail::flat_hash_map<Key, worker_ptr>& map,
+                   const Key& key) {
+    if (auto result = map.find(key))
+      return *result;
+    CAF_LOG_DEBUG("could not find worker: " << CAF_ARG(key));
+    return nullptr;
   }
 
+  // -- worker storage ---------------------------------------------------------
+
+  std::deque<worker_type> workers_;
+
   // -- worker lookups ---------------------------------------------------------
 
-  std::unordered_map<id_type, worker_ptr> workers_by_id_;
-  std::unordered_map<node_id, worker_ptr> workers_by_node_;
-  std::unordered_map<uint64_t, worker_ptr> workers_by_timeout_id_;
+  detail::flat_hash_map<id_type, worker_ptr> workers_by_id_;
+  detail::flat_hash_map<node_id, worker_ptr> workers_by_node_;
+  detail::flat_hash_map<uint64_t, worker_ptr> workers_by_timeout_id_;
+
+  /// Caches the result of the most recent successful lookup by ID.
+  id_type last_id_;
+  worker_ptr last_worker_ = nullptr;
 
   factory_type factory_;
 };
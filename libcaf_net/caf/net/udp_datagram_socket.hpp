@@ -4,9 +4,17 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "caf/byte_buffer.hpp"
 #include "caf/detail/net_export.hpp"
+#include "caf/error.hpp"
 #include "caf/fwd.hpp"
+#include "caf/ip_endpoint.hpp"
 #include "caf/net/network_socket.hpp"
+#include "caf/span.hpp"
 
 namespace caf::net {
 
@@ -18,6 +26,61 @@ struct CAF_NET_EXPORT udp_datagram_socket : network_socket {
   using super::super;
 };
 
+/// Maximum number of datagrams per `read_batch` or `write_batch` call.
+/// @relates udp_datagram_socket
+constexpr size_t max_udp_batch_size = 64;
+
+/// Maximum number of datagrams per `write_segmented` call.
+/// @relates udp_datagram_socket
+constexpr size_t max_udp_gso_segments = 64;
+
+/// Maximum number of bytes per `write_segmented` call.
+/// @relates udp_datagram_socket
+constexpr size_t max_udp_gso_bytes = 65000;
+
+/// Maximum number of buffers per `write_segmented` call.
+/// @relates udp_datagram_socket
+constexpr size_t max_udp_gso_buffers = 1024;
+
+/// Lists the offloads that the kernel provides for a UDP socket.
+/// @relates udp_datagram_socket
+struct udp_offload_support {
+  /// Signals support for UDP segmentation offload, i.e., `write_segmented`.
+  bool gso = false;
+
+  /// Signals that the kernel may coalesce received datagrams.
+  bool gro = false;
+};
+
+/// Storage for receiving a single datagram with `read_batch`.
+/// @relates udp_datagram_socket
+struct udp_datagram_slot {
+  /// Receives the datagram. Reading never resizes the buffer, i.e., its size
+  /// limits the size of received datagrams.
+  byte_buffer buf;
+
+  /// Stores the size of the received datagram.
+  size_t size = 0;
+
+  /// Stores the size of the individual datagrams if the kernel coalesced
+  /// multiple datagrams from the same sender into this slot (GRO), 0
+  /// otherwise. The last datagram may be shorter.
+  size_t segment_size = 0;
+
+  /// Stores the sender of the received datagram.
+  ip_endpoint ep;
+};
+
+/// Refers to a datagram for sending with `write_batch`.
+/// @relates udp_datagram_socket
+struct udp_datagram_view {
+  /// Points to the datagram, scattered across up to 10 buffers.
+  span<byte_buffer*> bufs;
+
+  /// Addresses the receiver.
+  ip_endpoint ep;
+};
+
 /// Creates a `udp_datagram_socket` bound to given port.
 /// @param ep ip_endpoint that contains the port to bind to. Pass port '0' to
 ///           bind to any unused port - The endpoint will be updated with the
@@ -32,6 +95,37 @@ expected<std::pair<udp_datagram_socket, uint16_t>>
 /// @relates udp_datagram_socket
 error CAF_NET_EXPORT allow_connreset(udp_datagram_socket x, bool new_value);
 
+/// Joins the multicast group `group` on `x`, i.e., `x` receives datagrams
+/// that peers send to the group address. Receiving requires binding `x` to
+/// the group's port and to the wildcard address.
+/// @param x The UDP socket for receiving datagrams.
+/// @param group The multicast address of the group.
+/// @param interface_index Selects the network interface for IPv6 groups. The
+///                        default value 0 lets the kernel choose. IPv4 groups
+///                        always use the default interface.
+/// @relates udp_datagram_socket
+error CAF_NET_EXPORT join_multicast_group(udp_datagram_socket x,
+                                          const ip_address& group,
+                                          uint32_t interface_index = 0);
+
+/// Leaves a group that `x` joined previously via `join_multicast_group`.
+/// @relates udp_datagram_socket
+error CAF_NET_EXPORT leave_multicast_group(udp_datagram_socket x,
+                                           const ip_address& group,
+                                           uint32_t interface_index = 0);
+
+/// Sets how many hops (routers) datagrams that `x` sends to a multicast group
+/// may pass. The default value 1 restricts datagrams to the local network.
+/// Sets the option for IPv4 and IPv6 groups if `x` is a dual-stack socket.
+/// @relates udp_datagram_socket
+error CAF_NET_EXPORT multicast_ttl(udp_datagram_socket x, uint8_t hops);
+
+/// Enables or disables delivery of datagrams that `x` sends to a multicast
+/// group to group members on the same host. Enabled by default. Sets the
+/// option for IPv4 and IPv6 groups if `x` is a dual-stack socket.
+/// @relates udp_datagram_socket
+error CAF_NET_EXPORT multicast_loopback(udp_datagram_socket x, bool new_value);
+
 /// Receives the next datagram on socket `x`.
 /// @param x The UDP socket for receiving datagrams.
 /// @param buf Writable output buffer.
@@ -43,6 +137,43 @@ error CAF_NET_EXPORT allow_connreset(udp_datagram_socket x, bool new_value);
 variant<std::pair<size_t, ip_endpoint>, sec>
   CAF_NET_EXPORT read(udp_datagram_socket x, span<byte> buf);
 
+/// Calls `f` with each datagram in `slot`, splitting datagrams that the
+/// kernel coalesced via GRO.
+/// @relates udp_datagram_slot
+template <class F>
+error for_each_datagram(udp_datagram_slot& slot, F f) {
+  if (slot.segment_size == 0 || slot.segment_size >= slot.size)
+    return f(make_span(slot.buf.data(), slot.size));
+  for (size_t offset = 0; offset < slot.size; offset += slot.segment_size) {
+    auto n = std::min(slot.segment_size, slot.size - offset);
+    if (auto err = f(make_span(slot.buf.data() + offset, n)))
+      return err;
+  }
+  return none;
+}
+
+/// Probes which offloads the kernel supports for `x` and enables receive
+/// offload (GRO) if available. Enabling GRO requires callers to split
+/// received datagrams via `for_each_datagram`.
+/// @relates udp_datagram_socket
+udp_offload_support CAF_NET_EXPORT enable_udp_offload(udp_datagram_socket x);
+
+/// Receives up to `slots.size()` datagrams on socket `x`, using a single
+/// system call where the platform supports it (`recvmmsg` on Linux).
+/// @param x The UDP socket for receiving datagrams.
+/// @param slots Pre-allocated storage for the datagrams.
+/// @returns The number of received datagrams on success, an error code
+///          otherwise. Returns `sec::unavailable_or_would_block` if no
+///          datagram was available.
+/// @relates udp_datagram_socket
+/// @post The first N slots store the received datagrams, whereas N is the
+///       returned integer. Datagrams that did not fit into their slot are
+///       truncated. Datagrams from senders with an unsupported address family
+///       are dropped, i.e., N may be 0 even if the socket received data.
+/// @note Reads at most `max_udp_batch_size` datagrams per call.
+variant<size_t, sec> CAF_NET_EXPORT
+read_batch(udp_datagram_socket x, span<udp_datagram_slot> slots);
+
 /// Sends the content of `bufs` as a datagram to the endpoint `ep` on socket
 /// `x`.
 /// @param x The UDP socket for sending datagrams.
@@ -65,6 +196,37 @@ variant<size_t, sec> CAF_NET_EXPORT write(udp_datagram_socket x,
 variant<size_t, sec> CAF_NET_EXPORT write(udp_datagram_socket x,
                                           span<const byte> buf, ip_endpoint ep);
 
+/// Sends multiple datagrams on socket `x`, using a single system call where
+/// the platform supports it (`sendmmsg` on Linux).
+/// @param x The UDP socket for sending datagrams.
+/// @param datagrams The datagrams to send in order.
+/// @returns The number of sent datagrams on success, otherwise an error code.
+///          Returns `sec::unavailable_or_would_block` if the socket could not
+///          send the first datagram.
+/// @relates udp_datagram_socket
+/// @pre Each datagram consists of less than 10 buffers.
+/// @note Sends at most `max_udp_batch_size` datagrams per call.
+variant<size_t, sec> CAF_NET_EXPORT
+write_batch(udp_datagram_socket x, span<const udp_datagram_view> datagrams);
+
+/// Sends the content of `bufs` as multiple datagrams of `segment_size` bytes
+/// to the endpoint `ep` with a single system call, letting the kernel (or
+/// the NIC) split the buffer (GSO). The last datagram may be shorter.
+/// @param x The UDP socket for sending datagrams.
+/// @param bufs Points to the datagrams, scattered across any number of
+///             buffers.
+/// @param segment_size The size of each datagram.
+/// @param ep The enpoint to send the datagrams to.
+/// @returns The number of written bytes on success, otherwise an error code.
+///          Returns `sec::feature_disabled` if the platform lacks GSO.
+/// @relates udp_datagram_socket
+/// @pre `bufs.size() <= max_udp_gso_buffers`
+/// @pre The datagrams sum up to at most `max_udp_gso_bytes` and
+///      `max_udp_gso_segments` datagrams.
+variant<size_t, sec> CAF_NET_EXPORT
+write_segmented(udp_datagram_socket x, span<byte_buffer*> bufs,
+                size_t segment_size, ip_endpoint ep);
+
 /// Converts the result from I/O operation on a ::udp_datagram_socket to either
 /// an error code or a non-zero positive integer.
 /// @relates udp_datagram_socket
@@ -4,7 +4,6 @@
 
 #include "caf/net/actor_proxy_impl.hpp"
 
-#include "caf/actor_system.hpp"
 #include "caf/expected.hpp"
 #include "caf/logger.hpp"
 
@@ -16,6 +15,13 @@ actor_proxy_impl::actor_proxy_impl(actor_config& cfg, endpoint_manager_ptr dst)
   dst_->enqueue_event(node(), id());
 }
 
+actor_proxy_impl::actor_proxy_impl(actor_config& cfg, stripe_set_ptr dst)
+  : super(cfg), stripes_(std::move(dst)) {
+  CAF_ASSERT(stripes_ != nullptr);
+  // The first connection carries all control traffic for this proxy.
+  stripes_->front()->enqueue_event(node(), id());
+}
+
 actor_proxy_impl::~actor_proxy_impl() {
   // nop
 }
@@ -24,7 +30,10 @@ bool actor_proxy_impl::enqueue(mailbox_element_ptr msg, execution_unit*) {
   CAF_PUSH_AID(0);
   CAF_ASSERT(msg != nullptr);
   CAF_LOG_SEND_EVENT(msg);
-  return dst_->enqueue(std::move(msg), ctrl());
+  if (dst_ != nullptr)
+    return dst_->enqueue(std::move(msg), ctrl());
+  auto mgr = stripes_->select(msg->sender.get(), id());
+  return mgr->enqueue(std::move(msg), ctrl());
 }
 
 void actor_proxy_impl::kill_proxy(execution_unit* ctx, error rsn) {
@@ -0,0 +1,196 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#include "caf/detail/lz4.hpp"
+
+#include "caf/span.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace caf::detail {
+
+namespace {
+
+constexpr size_t hash_log = 12;
+
+constexpr size_t hash_size = size_t{1} << hash_log;
+
+/// Provides a contiguous view on the dictionary followed by the input.
+class window {
+public:
+  window(span<const byte> dict, span<const byte> input)
+    : dict_(dict), input_(input) {
+    // nop
+  }
+
+  size_t size() const noexcept {
+    return dict_.size() + input_.size();
+  }
+
+  byte operator[](size_t pos) const noexcept {
+    return pos < dict_.size() ? dict_[pos] : input_[pos - dict_.size()];
+  }
+
+  uint32_t read32(size_t pos) const noexcept {
+    uint32_t result = 0;
+    if (pos >= dict_.size()) {
+      memcpy(&result, input_.data() + (pos - dict_.size()), 4);
+    } else if (pos + 4 <= dict_.size()) {
+      memcpy(&result, dict_.data() + pos, 4);
+    } else {
+      byte tmp[4];
+      for (size_t i = 0; i < 4; ++i)
+        tmp[i] = (*this)[pos + i];
+      memcpy(&result, tmp, 4);
+    }
+    return result;
+  }
+
+private:
+  span<const byte> dict_;
+  span<const byte> input_;
+};
+
+size_t hash(uint32_t x) noexcept {
+  return static_cast<size_t>((x * 2654435761u) >> (32 - hash_log));
+}
+
+void write_length(size_t n, lz4::binary_buffer& out) {
+  while (n >= 255) {
+    out.push_back(byte{255});
+    n -= 255;
+  }
+  out.push_back(static_cast<byte>(n));
+}
+
+bool read_length(span<const byte> input, size_t& pos, size_t& n) {
+  for (;;) {
+    if (pos >= input.size())
+      return false;
+    auto x = static_cast<uint8_t>(input[pos++]);
+    n += x;
+    if (x != 255)
+      return true;
+  }
+}
+
+void write_sequence(const window& buf, size_t anchor, size_t pos,
+                    size_t offset, size_t match_len, lz4::binary_buffer& out) {
+  auto lit_len = pos - anchor;
+  auto ml = match_len - lz4::min_match;
+  auto token = (std::min(lit_len, size_t{15}) << 4) | std::min(ml, size_t{15});
+  out.push_back(static_cast<byte>(token));
+  if (lit_len >= 15)
+    write_length(lit_len - 15, out);
+  for (auto i = anchor; i < pos; ++i)
+    out.push_back(buf[i]);
+  out.push_back(static_cast<byte>(offset & 0xFF));
+  out.push_back(static_cast<byte>(offset >> 8));
+  if (ml >= 15)
+    write_length(ml - 15, out);
+}
+
+void write_last_literals(const window& buf, size_t anchor,
+                         lz4::binary_buffer& out) {
+  auto lit_len = buf.size() - anchor;
+  out.push_back(static_cast<byte>(std::min(lit_len, size_t{15}) << 4));
+  if (lit_len >= 15)
+    write_length(lit_len - 15, out);
+  for (auto i = anchor; i < buf.size(); ++i)
+    out.push_back(buf[i]);
+}
+
+} // namespace
+
+void lz4::compress(span<const byte> dict, span<const byte> input,
+                   binary_buffer& out) {
+  if (dict.size() > max_offset)
+    dict = dict.subspan(dict.size() - max_offset);
+  out.reserve(out.size() + compress_bound(input.size()));
+  window buf{dict, input};
+  auto first = dict.size();
+  auto anchor = first;
+  if (input.size() <= match_limit) {
+    write_last_literals(buf, anchor, out);
+    return;
+  }
+  // Positions in the table are off by one to use 0 as "no entry".
+  std::array<uint32_t, hash_size> table;
+  table.fill(0);
+  if (first >= min_match)
+    for (size_t pos = 0; pos + min_match <= first; ++pos)
+      table[hash(buf.read32(pos))] = static_cast<uint32_t>(pos + 1);
+  auto end = buf.size();
+  auto pos = first;
+  while (pos + match_limit < end) {
+    auto x = buf.read32(pos);
+    auto& entry = table[hash(x)];
+    auto candidate = static_cast<size_t>(entry);
+    entry = static_cast<uint32_t>(pos + 1);
+    if (candidate == 0 || pos - (candidate - 1) > max_offset
+        || buf.read32(candidate - 1) != x) {
+      ++pos;
+      continue;
+    }
+    --candidate;
+    auto match_len = min_match;
+    while (pos + match_len + last_literals < end
+           && buf[candidate + match_len] == buf[pos + match_len])
+      ++match_len;
+    write_sequence(buf, anchor, pos, pos - candidate, match_len, out);
+    pos += match_len;
+    anchor = pos;
+  }
+  write_last_literals(buf, anchor, out);
+}
+
+bool lz4::decompress(span<const byte> dict, span<const byte> input,
+                     size_t output_size, binary_buffer& out) {
+  // Blocks cannot expand beyond this bound. Checking it first prevents a few
+  // Bytes from forcing us to allocate the maximum output size.
+  if (output_size > decompress_bound(input.size()))
+    return false;
+  auto out_begin = out.size();
+  out.reserve(out_begin + output_size);
+  auto produced = [&] { return out.size() - out_begin; };
+  size_t pos = 0;
+  while (pos < input.size()) {
+    auto token = static_cast<uint8_t>(input[pos++]);
+    size_t lit_len = token >> 4;
+    if (lit_len == 15 && !read_length(input, pos, lit_len))
+      return false;
+    if (lit_len > input.size() - pos || lit_len > output_size - produced())
+      return false;
+    out.insert(out.end(), input.begin() + pos, input.begin() + pos + lit_len);
+    pos += lit_len;
+    if (pos == input.size())
+      break;
+    if (input.size() - pos < 2)
+      return false;
+    auto offset = static_cast<size_t>(input[pos])
+                  | (static_cast<size_t>(input[pos + 1]) << 8);
+    pos += 2;
+    size_t match_len = token & 0x0F;
+    if (match_len == 15 && !read_length(input, pos, match_len))
+      return false;
+    match_len += min_match;
+    if (offset == 0 || offset > produced() + dict.size()
+        || match_len > output_size - produced())
+      return false;
+    for (size_t i = 0; i < match_len; ++i) {
+      auto n = produced();
+      byte x;
+      if (n >= offset)
+        x = out[out_begin + n - offset];
+      else
+        x = dict[dict.size() - (offset - n)];
+      out.push_back(x);
+    }
+  }
+  return produced() == output_size;
+}
+
+} // namespace caf::detail
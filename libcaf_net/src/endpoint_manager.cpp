@@ -4,10 +4,15 @@
 
 #include "caf/net/endpoint_manager.hpp"
 
+#include "caf/actor_system_config.hpp"
+#include "caf/behavior.hpp"
 #include "caf/intrusive/inbox_result.hpp"
+#include "caf/logger.hpp"
 #include "caf/net/multiplexer.hpp"
 #include "caf/sec.hpp"
 #include "caf/send.hpp"
+#include "caf/spawn_options.hpp"
+#include "caf/telemetry/metric_registry.hpp"
 
 namespace caf::net {
 
@@ -15,12 +20,30 @@ namespace caf::net {
 
 endpoint_manager::endpoint_manager(socket handle, const multiplexer_ptr& parent,
                                    actor_system& sys)
-  : super(handle, parent), sys_(sys), queue_(unit, unit, unit) {
+  : super(handle, parent),
+    sys_(sys),
+    capacity_(sys.config()),
+    lanes_(get_or(sys.config(), "caf.middleman.urgent-weight",
+                  default_urgent_weight)),
+    disconnected_(false),
+    queue_(unit, unit, unit, unit) {
+  auto& reg = sys.metrics();
+  queued_messages_gauge_ = reg.gauge_singleton(
+    "caf.middleman", "queued-messages",
+    "Number of messages in the outbound queues of all endpoints.");
+  queued_bytes_gauge_ = reg.gauge_singleton(
+    "caf.middleman", "queued-bytes",
+    "Estimated size of all messages in the outbound queues of all endpoints.",
+    "bytes");
   queue_.try_block();
 }
 
 endpoint_manager::~endpoint_manager() {
-  // nop
+  if (timeout_proxy_ != nullptr)
+    anon_send_exit(timeout_proxy_, exit_reason::user_shutdown);
+  // Messages that remain in the queue leave it with this manager.
+  queued_messages_gauge_->dec(static_cast<int64_t>(capacity_.messages()));
+  queued_bytes_gauge_->dec(static_cast<int64_t>(capacity_.bytes()));
 }
 
 // -- properties ---------------------------------------------------------------
@@ -39,15 +62,20 @@ endpoint_manager_queue::message_ptr endpoint_manager::next_message() {
   if (queue_.blocked())
     return nullptr;
   queue_.fetch_more();
-  auto& q = std::get<1>(queue_.queue().queues());
-  auto ts = q.next_task_size();
-  if (ts == 0)
-    return nullptr;
-  q.inc_deficit(ts);
-  auto result = q.next();
-  if (queue_.empty())
-    queue_.try_block();
-  return result;
+  for (;;) {
+    auto result = lanes_.next(queue_.queue());
+    if (result == nullptr)
+      return nullptr;
+    remove_queued(result->size_hint);
+    // Drop the oldest messages until the remainder fits into the queue.
+    if (capacity_.must_drop_oldest()) {
+      capacity_.reject(*result);
+      continue;
+    }
+    if (queue_.empty())
+      queue_.try_block();
+    return result;
+  }
 }
 
 // -- event management ---------------------------------------------------------
@@ -60,11 +88,59 @@ void endpoint_manager::resolve(uri locator, actor listener) {
     anon_send(listener, resolve_atom_v, make_error(sec::request_receiver_down));
 }
 
-void endpoint_manager::enqueue(mailbox_element_ptr msg,
+bool endpoint_manager::enqueue(mailbox_element_ptr msg,
                                strong_actor_ptr receiver) {
   using message_type = endpoint_manager_queue::message;
-  auto ptr = new message_type(std::move(msg), std::move(receiver));
-  enqueue(ptr);
+  return enqueue(std::make_unique<message_type>(std::move(msg),
+                                                std::move(receiver)));
+}
+
+bool endpoint_manager::enqueue(endpoint_manager_queue::message_ptr msg) {
+  CAF_ASSERT(msg != nullptr);
+  // Update the bookkeeping before pushing, because the I/O thread may pull the
+  // message immediately. The queue deletes the message if it is closed.
+  auto size_hint = msg->size_hint;
+  if (!capacity_.try_add(size_hint)) {
+    capacity_.reject(*msg);
+    return false;
+  }
+  queued_messages_gauge_->inc();
+  queued_bytes_gauge_->inc(static_cast<int64_t>(size_hint));
+  if (!enqueue(msg.release())) {
+    remove_queued(size_hint);
+    return false;
+  }
+  return true;
+}
+
+void endpoint_manager::set_timeout(timespan delay, std::string tag,
+                                   uint64_t id) {
+  // Only the I/O thread sets timeouts, hence we can spawn the proxy lazily.
+  if (timeout_proxy_ == nullptr) {
+    auto impl = [target{make_event_target()}]() -> behavior {
+      return {
+        [target](std::string& tag, uint64_t id) {
+          post_event(target, std::move(tag), id);
+        },
+      };
+    };
+    timeout_proxy_ = sys_.spawn<hidden>(impl);
+  }
+  delayed_anon_send(timeout_proxy_, delay, std::move(tag), id);
+}
+
+void endpoint_manager::post_event(const event_target_ptr& target,
+                                  std::string tag, uint64_t id) {
+  auto f = [tag{std::move(tag)}, id](socket_manager& mgr) mutable {
+    static_cast<endpoint_manager&>(mgr).enqueue_event(std::move(tag), id);
+  };
+  post(target, std::move(f));
+}
+
+void endpoint_manager::remove_queued(size_t size_hint) noexcept {
+  capacity_.remove(size_hint);
+  queued_messages_gauge_->dec();
+  queued_bytes_gauge_->dec(static_cast<int64_t>(size_hint));
 }
 
 bool endpoint_manager::enqueue(endpoint_manager_queue::element* ptr) {
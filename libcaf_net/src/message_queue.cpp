@@ -4,47 +4,40 @@
 
 #include "caf/net/basp/message_queue.hpp"
 
-#include <iterator>
-
 namespace caf::net::basp {
 
-message_queue::message_queue() : next_id(0), next_undelivered(0) {
+message_queue::message_queue()
+  : next_id(0), next_undelivered(0), delivering_(false), overflow_size_(0) {
   // nop
 }
 
 void message_queue::push(execution_unit* ctx, uint64_t id,
                          strong_actor_ptr receiver,
                          mailbox_element_ptr content) {
-  std::unique_lock<std::mutex> guard{lock};
-  CAF_ASSERT(id >= next_undelivered);
-  CAF_ASSERT(id < next_id);
-  auto first = pending.begin();
-  auto last = pending.end();
-  if (id == next_undelivered) {
-    // Dispatch current head.
-    if (receiver != nullptr)
-      receiver->enqueue(std::move(content), ctx);
-    auto next = id + 1;
-    // Check whether we can deliver more.
-    if (first == last || first->id != next) {
-      next_undelivered = next;
-      CAF_ASSERT(next_undelivered <= next_id);
-      return;
+  CAF_ASSERT(id >= next_undelivered.load());
+  CAF_ASSERT(id < next_id.load());
+  // Messages that run too far ahead go to the slow path. Since
+  // `next_undelivered` only grows, IDs within the window stay there.
+  if (id - next_undelivered.load(std::memory_order_acquire) >= window_size) {
+    {
+      std::unique_lock<std::mutex> guard{overflow_mtx_};
+      overflow_.emplace(id, overflow_msg{std::move(receiver),
+                                         std::move(content)});
     }
-    // Deliver everything until reaching a non-consecutive ID or the end.
-    auto i = first;
-    for (; i != last && i->id == next; ++i, ++next)
-      if (i->receiver != nullptr)
-        i->receiver->enqueue(std::move(i->content), ctx);
-    next_undelivered = next;
-    pending.erase(first, i);
-    CAF_ASSERT(next_undelivered <= next_id);
+    // Incrementing the counter after inserting guarantees that the delivering
+    // thread finds the message once it observes the new count.
+    overflow_size_.fetch_add(1);
+    deliver(ctx);
     return;
   }
-  // Get the insertion point.
-  auto pred = [&](const actor_msg& x) { return x.id >= id; };
-  pending.emplace(std::find_if(first, last, pred),
-                  actor_msg{id, std::move(receiver), std::move(content)});
+  auto& x = slot(id);
+  CAF_ASSERT(!x.ready.load());
+  x.receiver = std::move(receiver);
+  x.content = std::move(content);
+  // Sequential consistency guarantees that either we observe that the
+  // delivering thread is done or that it observes our ready flag.
+  x.ready.store(true);
+  deliver(ctx);
 }
 
 void message_queue::drop(execution_unit* ctx, uint64_t id) {
@@ -52,8 +45,57 @@ void message_queue::drop(execution_unit* ctx, uint64_t id) {
 }
 
 uint64_t message_queue::new_id() {
-  std::unique_lock<std::mutex> guard{lock};
-  return next_id++;
+  return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+void message_queue::deliver(execution_unit* ctx) {
+  for (;;) {
+    auto expected = false;
+    if (!delivering_.compare_exchange_strong(expected, true))
+      return;
+    auto next = next_undelivered.load(std::memory_order_relaxed);
+    for (;;) {
+      auto& x = slot(next);
+      overflow_msg msg;
+      if (x.ready.load(std::memory_order_acquire)) {
+        msg.receiver = std::move(x.receiver);
+        msg.content = std::move(x.content);
+        x.ready.store(false, std::memory_order_relaxed);
+      } else if (!take_overflow(next, msg)) {
+        break;
+      }
+      // Releasing the slot allows a producer to reuse it for `next + window`.
+      next_undelivered.store(++next, std::memory_order_release);
+      if (msg.receiver != nullptr)
+        msg.receiver->enqueue(std::move(msg.content), ctx);
+    }
+    delivering_.store(false);
+    // Another producer may have added the next message after our last check
+    // but before we released the flag. In this case, its attempt to deliver
+    // failed and we need to pick up its message.
+    if (!slot(next).ready.load() && !has_overflow(next))
+      return;
+  }
+}
+
+bool message_queue::take_overflow(uint64_t id, overflow_msg& result) {
+  if (overflow_size_.load() == 0)
+    return false;
+  std::unique_lock<std::mutex> guard{overflow_mtx_};
+  auto i = overflow_.begin();
+  if (i == overflow_.end() || i->first != id)
+    return false;
+  result = std::move(i->second);
+  overflow_.erase(i);
+  overflow_size_.fetch_sub(1);
+  return true;
+}
+
+bool message_queue::has_overflow(uint64_t id) {
+  if (overflow_size_.load() == 0)
+    return false;
+  std::unique_lock<std::mutex> guard{overflow_mtx_};
+  return overflow_.count(id) != 0;
 }
 
 } // namespace caf::net::basp
@@ -170,6 +170,20 @@ void multiplexer::init(const socket_manager_ptr& mgr) {
   }
 }
 
+void multiplexer::dispatch(socket handle, manager_callback f) {
+  CAF_LOG_TRACE(CAF_ARG2("socket", handle.id));
+  bool wake_up = false;
+  {
+    std::lock_guard<std::mutex> guard{dispatch_lock_};
+    // A single pipe message suffices for all callbacks that queue up before
+    // the multiplexer runs them.
+    wake_up = dispatched_.empty();
+    dispatched_.emplace_back(handle, std::move(f));
+  }
+  if (wake_up)
+    write_to_pipe(pollset_updater::dispatch_code, nullptr);
+}
+
 void multiplexer::close_pipe() {
   CAF_LOG_TRACE("");
   std::lock_guard<std::mutex> guard{write_lock_};
@@ -282,6 +296,26 @@ void multiplexer::shutdown() {
   }
 }
 
+void multiplexer::run_dispatched() {
+  CAF_LOG_TRACE("");
+  std::vector<std::pair<socket, manager_callback>> xs;
+  {
+    std::lock_guard<std::mutex> guard{dispatch_lock_};
+    xs.swap(dispatched_);
+  }
+  for (auto& [handle, f] : xs) {
+    auto has_handle = [id{handle.id}](const socket_manager_ptr& mgr) {
+      return mgr->handle().id == id;
+    };
+    auto i = std::find_if(managers_.begin(), managers_.end(), has_handle);
+    if (i != managers_.end()) {
+      // Keep the manager alive in case the callback changes the pollset.
+      auto mgr = *i;
+      (*f)(*mgr);
+    }
+  }
+}
+
 // -- utility functions --------------------------------------------------------
 
 short multiplexer::handle(const socket_manager_ptr& mgr, short events,
@@ -335,10 +369,12 @@ void multiplexer::write_to_pipe(uint8_t opcode, const socket_manager_ptr& mgr) {
   CAF_ASSERT(opcode == pollset_updater::register_reading_code
              || opcode == pollset_updater::register_writing_code
              || opcode == pollset_updater::init_manager_code
-             || opcode == pollset_updater::shutdown_code);
-  CAF_ASSERT(mgr != nullptr || opcode == pollset_updater::shutdown_code);
+             || opcode == pollset_updater::shutdown_code
+             || opcode == pollset_updater::dispatch_code);
+  CAF_ASSERT(mgr != nullptr || opcode == pollset_updater::shutdown_code
+             || opcode == pollset_updater::dispatch_code);
   pollset_updater::msg_buf buf;
-  if (opcode != pollset_updater::shutdown_code)
+  if (mgr != nullptr)
     mgr->ref();
   buf[0] = static_cast<byte>(opcode);
   auto value = reinterpret_cast<intptr_t>(mgr.get());
@@ -349,7 +385,7 @@ void multiplexer::write_to_pipe(uint8_t opcode, const socket_manager_ptr& mgr) {
     if (write_handle_ != invalid_socket)
       res = write(write_handle_, buf);
   }
-  if (res <= 0 && opcode != pollset_updater::shutdown_code)
+  if (res <= 0 && mgr != nullptr)
     mgr->deref();
 }
 
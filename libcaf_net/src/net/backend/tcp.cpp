@@ -4,18 +4,19 @@
 
 #include "caf/net/backend/tcp.hpp"
 
+#include <algorithm>
+#include <future>
+#include <memory>
 #include <mutex>
 #include <string>
 
 #include "caf/net/actor_proxy_impl.hpp"
 #include "caf/net/basp/application.hpp"
-#include "caf/net/basp/application_factory.hpp"
 #include "caf/net/basp/ec.hpp"
 #include "caf/net/defaults.hpp"
-#include "caf/net/doorman.hpp"
-#include "caf/net/ip.hpp"
 #include "caf/net/make_endpoint_manager.hpp"
 #include "caf/net/middleman.hpp"
+#include "caf/net/resolver.hpp"
 #include "caf/net/socket_guard.hpp"
 #include "caf/net/stream_transport.hpp"
 #include "caf/net/tcp_accept_socket.hpp"
@@ -25,7 +26,16 @@
 namespace caf::net::backend {
 
 tcp::tcp(middleman& mm)
-  : middleman_backend("tcp"), mm_(mm), proxies_(mm.system(), *this) {
+  : middleman_backend("tcp"),
+    mm_(mm),
+    peers_(std::make_shared<peer_map>()),
+    proxies_(mm.system(), *this),
+    content_cache_(get_or(mm.system().config(),
+                          "caf.middleman.content-cache-size",
+                          basp::content_cache::default_capacity)),
+    num_stripes_(std::max(get_or(mm.system().config(),
+                                 "caf.middleman.tcp-stripes", size_t{1}),
+                          size_t{1})) {
   // nop
 }
 
@@ -51,45 +61,43 @@ error tcp::init() {
   if (!port)
     return port.error();
   listening_port_ = *port;
-  CAF_LOG_INFO("doorman spawned on " << CAF_ARG(*port));
-  auto doorman_uri = make_uri("tcp://doorman");
-  if (!doorman_uri)
-    return doorman_uri.error();
-  auto& mpx = mm_.mpx();
-  auto mgr = make_endpoint_manager(
-    mpx, mm_.system(),
-    doorman{acc_guard.release(), basp::application_factory{proxies_}});
-  if (auto err = mgr->init()) {
-    CAF_LOG_ERROR("mgr->init() failed: " << err);
-    return err;
-  }
+  CAF_LOG_INFO("acceptor spawned on " << CAF_ARG(*port));
+  // The acceptor initializes each manager once it added it to the multiplexer.
+  auto factory = [this](tcp_stream_socket sock, multiplexer*) {
+    if (auto err = nonblocking(sock, true))
+      CAF_LOG_ERROR("failed to set accepted socket to nonblocking:" << err);
+    return socket_manager_ptr{new_peer_manager(sock)};
+  };
+  mm_.make_acceptor(acc_guard.release(), std::move(factory));
   return none;
 }
 
 void tcp::stop() {
-  for (const auto& p : peers_)
+  peer_map_ptr peers;
+  {
+    const std::lock_guard<std::mutex> lock(lock_);
+    peers = peer_snapshot();
+    std::atomic_store(&peers_, std::make_shared<const peer_map>());
+  }
+  for (const auto& p : *peers)
     proxies_.erase(p.first);
-  peers_.clear();
 }
 
 expected<endpoint_manager_ptr> tcp::get_or_connect(const uri& locator) {
-  if (auto auth = locator.authority_only()) {
-    auto id = make_node_id(*auth);
-    if (auto ptr = peer(id))
-      return ptr;
-    auto host = locator.authority().host;
-    if (auto hostname = get_if<std::string>(&host)) {
-      for (const auto& addr : ip::resolve(*hostname)) {
-        ip_endpoint ep{addr, locator.authority().port};
-        auto sock = make_connected_tcp_stream_socket(ep);
-        if (!sock)
-          continue;
-        else
-          return emplace(id, *sock);
-      }
-    }
-  }
-  return sec::cannot_connect_to_node;
+  auto auth = locator.authority_only();
+  if (!auth)
+    return sec::cannot_connect_to_node;
+  auto id = make_node_id(*auth);
+  if (auto ptr = peer(id))
+    return ptr;
+  using promise_type = std::promise<expected<endpoint_manager_ptr>>;
+  auto res = std::make_shared<promise_type>();
+  auto f = [res](const expected<endpoint_manager_ptr>& mgr) {
+    res->set_value(mgr);
+  };
+  auto fut = res->get_future();
+  with_peer(id, *auth, make_type_erased_callback(f));
+  return fut.get();
 }
 
 endpoint_manager_ptr tcp::peer(const node_id& id) {
@@ -97,18 +105,136 @@ endpoint_manager_ptr tcp::peer(const node_id& id) {
 }
 
 void tcp::resolve(const uri& locator, const actor& listener) {
-  if (auto p = get_or_connect(locator))
-    (*p)->resolve(locator, listener);
+  auto auth = locator.authority_only();
+  if (!auth) {
+    anon_send(listener, make_error(sec::cannot_connect_to_node));
+    return;
+  }
+  auto id = make_node_id(*auth);
+  if (auto ptr = peer(id)) {
+    ptr->resolve(locator, listener);
+    return;
+  }
+  // The manager sends the BASP handshake first. Hence, the peer processes the
+  // request only after completing the handshake.
+  auto f = [locator, listener](const expected<endpoint_manager_ptr>& mgr) {
+    if (mgr)
+      (*mgr)->resolve(locator, listener);
+    else
+      anon_send(listener, mgr.error());
+  };
+  with_peer(id, *auth, make_type_erased_callback(f));
+}
+
+void tcp::with_peer(const node_id& id, const uri::authority_type& auth,
+                    pending_request f) {
+  endpoint_manager_ptr mgr;
+  {
+    const std::lock_guard<std::mutex> lock(lock_);
+    // Check again, because the connection may have succeeded in the meantime.
+    auto peers = peer_snapshot();
+    if (auto i = peers->find(id); i != peers->end()) {
+      mgr = i->second->front();
+    } else {
+      auto& requests = pending_requests_[id];
+      requests.emplace_back(std::move(f));
+      // Only the first request starts connecting to the node.
+      if (requests.size() > 1)
+        return;
+    }
+  }
+  if (mgr)
+    (*f)(mgr);
   else
-    anon_send(listener, p.error());
+    connect_async(id, auth);
+}
+
+void tcp::connect_async(const node_id& id, const uri::authority_type& auth) {
+  auto port = auth.port;
+  if (auto hostname = get_if<std::string>(&auth.host)) {
+    // Host name lookups may take a long time. Hence, we continue on one of the
+    // resolver threads once the addresses become available.
+    auto f = [this, id, port](const resolver::address_list& addrs) {
+      // The resolver also reports an empty list after stopping. Fail all
+      // pending requests without touching the multiplexer in this case.
+      if (addrs.empty()) {
+        connected(id, {}, make_error(sec::cannot_connect_to_node));
+        return;
+      }
+      std::vector<ip_endpoint> endpoints;
+      for (const auto& addr : addrs)
+        endpoints.emplace_back(addr, port);
+      connect_async(id, std::move(endpoints));
+    };
+    mm_.dns().async_resolve(*hostname, std::move(f));
+  } else if (auto addr = get_if<ip_address>(&auth.host)) {
+    connect_async(id, std::vector<ip_endpoint>{ip_endpoint{*addr, port}});
+  } else {
+    connect_async(id, std::vector<ip_endpoint>{});
+  }
+}
+
+void tcp::connect_async(const node_id& id,
+                        std::vector<ip_endpoint> endpoints) {
+  auto f = [this, id, endpoints](expected<tcp_stream_socket> sock) {
+    connected(id, endpoints, std::move(sock));
+  };
+  tcp_connector::start(mm_.mpx(), endpoints, make_type_erased_callback(f));
+}
+
+void tcp::connected(const node_id& id, std::vector<ip_endpoint> endpoints,
+                    expected<tcp_stream_socket> sock) {
+  auto mgr = sock ? emplace(id, *sock) : expected<endpoint_manager_ptr>{
+                                           std::move(sock.error())};
+  // The peer may have connected to us in the meantime, in which case we use
+  // its connection instead.
+  auto is_new = static_cast<bool>(mgr);
+  if (auto existing = !is_new ? peer(id) : nullptr; existing != nullptr)
+    mgr = std::move(existing);
+  std::vector<pending_request> requests;
+  {
+    const std::lock_guard<std::mutex> lock(lock_);
+    if (auto i = pending_requests_.find(id); i != pending_requests_.end()) {
+      requests.swap(i->second);
+      pending_requests_.erase(i);
+    }
+  }
+  if (!mgr)
+    CAF_LOG_WARNING("failed to connect to node:" << CAF_ARG(id)
+                                                 << CAF_ARG2("error",
+                                                             mgr.error()));
+  for (auto& f : requests)
+    (*f)(mgr);
+  if (!is_new)
+    return;
+  // Race for additional stripes in the background as well.
+  for (size_t i = 1; i < num_stripes_; ++i) {
+    auto f = [this, id](expected<tcp_stream_socket> stripe) {
+      if (!stripe) {
+        CAF_LOG_WARNING("failed to open additional connection:"
+                        << stripe.error());
+        return;
+      }
+      if (auto added = emplace_stripe(id, *stripe); !added)
+        CAF_LOG_WARNING("failed to add stripe:" << added.error());
+    };
+    tcp_connector::start(mm_.mpx(), endpoints, make_type_erased_callback(f));
+  }
 }
 
 strong_actor_ptr tcp::make_proxy(node_id nid, actor_id aid) {
   using impl_type = actor_proxy_impl;
   using hdl_type = strong_actor_ptr;
   actor_config cfg;
+  auto xs = stripes(nid);
+  if (xs == nullptr)
+    return nullptr;
+  // Proxies without stripes skip the per-message stripe selection.
+  if (num_stripes_ == 1)
+    return make_actor<impl_type, hdl_type>(aid, nid, &mm_.system(), cfg,
+                                           xs->front());
   return make_actor<impl_type, hdl_type>(aid, nid, &mm_.system(), cfg,
-                                         peer(nid));
+                                         std::move(xs));
 }
 
 void tcp::set_last_hop(node_id*) {
@@ -119,12 +245,20 @@ uint16_t tcp::port() const noexcept {
   return listening_port_;
 }
 
-endpoint_manager_ptr tcp::get_peer(const node_id& id) {
-  const std::lock_guard<std::mutex> lock(lock_);
-  auto i = peers_.find(id);
-  if (i != peers_.end())
+stripe_set_ptr tcp::stripes(const node_id& id) {
+  auto peers = peer_snapshot();
+  auto i = peers->find(id);
+  if (i != peers->end())
     return i->second;
   return nullptr;
 }
 
+endpoint_manager_ptr tcp::get_peer(const node_id& id) {
+  auto peers = peer_snapshot();
+  auto i = peers->find(id);
+  if (i != peers->end())
+    return i->second->front();
+  return nullptr;
+}
+
 } // namespace caf::net::backend
@@ -19,7 +19,12 @@
 namespace caf::net::backend {
 
 test::test(middleman& mm)
-  : middleman_backend("test"), mm_(mm), proxies_(mm.system(), *this) {
+  : middleman_backend("test"),
+    mm_(mm),
+    proxies_(mm.system(), *this),
+    content_cache_(get_or(mm.system().config(),
+                          "caf.middleman.content-cache-size",
+                          basp::content_cache::default_capacity)) {
   // nop
 }
 
@@ -78,7 +83,7 @@ test::peer_entry& test::emplace(const node_id& peer_id, stream_socket first,
   if (auto err = nonblocking(second, true))
     CAF_LOG_ERROR("nonblocking failed: " << err);
   auto mpx = mm_.mpx();
-  basp::application app{proxies_};
+  basp::application app{proxies_, &content_cache_};
   auto mgr = make_endpoint_manager(mpx, mm_.system(),
                                    transport_type{second, std::move(app)});
   if (auto err = mgr->init()) {
@@ -4,6 +4,9 @@
 
 #include "caf/net/basp/application.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <optional>
 #include <vector>
 
 #include "caf/actor_system.hpp"
@@ -12,12 +15,16 @@
 #include "caf/binary_serializer.hpp"
 #include "caf/byte_buffer.hpp"
 #include "caf/defaults.hpp"
+#include "caf/detail/lz4.hpp"
 #include "caf/detail/network_order.hpp"
 #include "caf/detail/parse.hpp"
+#include "caf/detail/scope_guard.hpp"
+#include "caf/detail/sync_request_bouncer.hpp"
 #include "caf/error.hpp"
 #include "caf/logger.hpp"
 #include "caf/net/basp/constants.hpp"
 #include "caf/net/basp/ec.hpp"
+#include "caf/net/basp/message_batch.hpp"
 #include "caf/net/packet_writer.hpp"
 #include "caf/no_stages.hpp"
 #include "caf/none.hpp"
@@ -27,8 +34,8 @@
 
 namespace caf::net::basp {
 
-application::application(proxy_registry& proxies)
-  : proxies_(proxies), queue_{new message_queue}, hub_{new hub_type} {
+application::application(proxy_registry& proxies, content_cache* cache)
+  : proxies_(proxies), content_cache_(cache) {
   // nop
 }
 
@@ -37,32 +44,107 @@ error application::write_message(
   CAF_ASSERT(ptr != nullptr);
   CAF_ASSERT(ptr->msg != nullptr);
   CAF_LOG_TRACE(CAF_ARG2("content", ptr->msg->content()));
-  const auto& src = ptr->msg->sender;
-  const auto& dst = ptr->receiver;
-  if (dst == nullptr) {
+  if (ptr->receiver == nullptr) {
     // TODO: valid?
     return none;
   }
+  heartbeats_.sent();
+  auto next = batching_enabled() ? manager_->next_message() : nullptr;
+  if (next == nullptr) {
+    auto payload_buf = writer.next_payload_buffer();
+    payload_buf.reserve(envelope_size_hint + ptr->size_hint);
+    auto type = message_type::actor_message;
+    if (auto err = serialize_actor_message(payload_buf, *ptr, type))
+      return err;
+    compress_payload(type, payload_buf);
+    auto hdr = writer.next_header_buffer();
+    to_bytes(header{type, static_cast<uint32_t>(payload_buf.size()),
+                    ptr->msg->mid.integer_value()},
+             hdr);
+    writer.write_packet(hdr, payload_buf);
+    return none;
+  }
+  // Pack pending messages into a single frame until the batch is full, writing
+  // each message with its regular header and payload. A message that fails to
+  // serialize only drops itself, not the entire batch.
   auto payload_buf = writer.next_payload_buffer();
-  binary_serializer sink{system(), payload_buf};
+  batch_writer batch{payload_buf, max_batch_size_, max_batch_bytes_};
+  auto append = [&](const endpoint_manager_queue::message& x) {
+    if (x.receiver == nullptr)
+      return;
+    auto& buf = batch.begin(envelope_size_hint + x.size_hint);
+    auto type = message_type::actor_message;
+    if (auto err = serialize_actor_message(buf, x, type)) {
+      CAF_LOG_ERROR("unable to serialize actor message, drop it:" << err);
+      batch.rollback();
+      if (x.msg->mid.is_request()) {
+        detail::sync_request_bouncer bouncer{std::move(err)};
+        bouncer(*x.msg);
+      }
+      return;
+    }
+    batch.commit(type, x.msg->mid.integer_value());
+  };
+  append(*ptr);
+  do {
+    append(*next);
+  } while (!batch.full() && (next = manager_->next_message()) != nullptr);
+  if (batch.empty())
+    return none;
+  auto type = message_type::message_batch;
+  compress_payload(type, payload_buf);
+  auto hdr = writer.next_header_buffer();
+  to_bytes(header{type, static_cast<uint32_t>(payload_buf.size()),
+                  static_cast<uint64_t>(batch.size())},
+           hdr);
+  writer.write_packet(hdr, payload_buf);
+  return none;
+}
+
+error application::serialize_actor_message(
+  byte_buffer& buf, const endpoint_manager_queue::message& x,
+  message_type& type) {
+  const auto& src = x.msg->sender;
+  const auto& dst = x.receiver;
+  binary_serializer sink{system(), buf};
+  auto src_node = node_id{};
+  auto src_id = actor_id{0};
   if (src != nullptr) {
-    auto src_id = src->id();
-    system().registry().put(src_id, src);
-    if (!sink.apply_objects(src->node(), src_id, dst->id(), ptr->msg->stages))
+    src_node = src->node();
+    src_id = src->id();
+    export_actor(src);
+  }
+  // The compact envelope assigns a slot for a new node. If serializing fails
+  // later on, the peer never receives the node literal. Hence, we restore the
+  // previous state of the table in this case.
+  std::optional<node_table> nodes_backup;
+  if (features_.compact_envelopes && src_node
+      && outgoing_nodes_.find(src_node) == node_table::max_size)
+    nodes_backup = outgoing_nodes_;
+  auto rollback = detail::make_scope_guard([&] {
+    if (nodes_backup)
+      outgoing_nodes_ = std::move(*nodes_backup);
+  });
+  auto& stages = x.msg->stages;
+  if (features_.compact_envelopes) {
+    type = message_type::compact_actor_message;
+    auto has_stages = !stages.empty();
+    if (!write_compact_envelope(sink, outgoing_nodes_, src_node, src_id,
+                                dst->id(), has_stages)
+        || (has_stages && !sink.apply(stages)))
       return sink.get_error();
   } else {
-    if (!sink.apply_objects(node_id{}, actor_id{0}, dst->id(),
-                            ptr->msg->stages))
+    type = message_type::actor_message;
+    if (!sink.apply_objects(src_node, src_id, dst->id(), stages))
       return sink.get_error();
   }
-  if (!sink.apply_objects(ptr->msg->content()))
+  if (content_cache_ != nullptr) {
+    if (auto err = content_cache_->serialize(system(), x.msg->content(), buf))
+      return err;
+  } else if (!sink.apply_objects(x.msg->content())) {
     return sink.get_error();
-  auto hdr = writer.next_header_buffer();
-  to_bytes(header{message_type::actor_message,
-                  static_cast<uint32_t>(payload_buf.size()),
-                  ptr->msg->mid.integer_value()},
-           hdr);
-  writer.write_packet(hdr, payload_buf);
+  }
+  rollback.disable();
   return none;
 }
 
@@ -82,27 +164,29 @@ void application::resolve(packet_writer& writer, string_view path,
            hdr);
   writer.write_packet(hdr, payload);
   pending_resolves_.emplace(req_id, listener);
+  heartbeats_.sent();
 }
 
 void application::new_proxy(packet_writer& writer, actor_id id) {
-  auto hdr = writer.next_header_buffer();
-  to_bytes(header{message_type::monitor_message, 0, static_cast<uint64_t>(id)},
-           hdr);
-  writer.write_packet(hdr);
+  auto first = control_batch_.add_monitor(id);
+  if (!control_batching_enabled())
+    flush_control_messages(writer);
+  else if (first)
+    schedule_control_flush();
 }
 
 void application::local_actor_down(packet_writer& writer, actor_id id,
                                    error reason) {
-  auto payload = writer.next_payload_buffer();
-  binary_serializer sink{system(), payload};
-  if (!sink.apply_objects(reason))
-    CAF_RAISE_ERROR("unable to serialize an error");
-  auto hdr = writer.next_header_buffer();
-  to_bytes(header{message_type::down_message,
-                  static_cast<uint32_t>(payload.size()),
-                  static_cast<uint64_t>(id)},
-           hdr);
-  writer.write_packet(hdr, payload);
+  auto first = control_batch_.add_down(id, std::move(reason));
+  if (!control_batching_enabled())
+    flush_control_messages(writer);
+  else if (first)
+    schedule_control_flush();
+}
+
+void application::flush_control_messages(packet_writer& writer) {
+  if (control_batch_.flush(system(), writer, features_.control_batches) > 0)
+    heartbeats_.sent();
 }
 
 strong_actor_ptr application::resolve_local_path(string_view path) {
@@ -175,11 +259,18 @@ error application::handle(size_t& next_read_size, packet_writer& writer,
 error application::handle(packet_writer& writer, header hdr,
                           byte_span payload) {
   CAF_LOG_TRACE(CAF_ARG(hdr) << CAF_ARG2("payload.size", payload.size()));
+  // Reject message types that require a feature we never agreed on, even if
+  // we would support it.
+  if (!permits(features_, hdr.type))
+    return ec::unimplemented;
   switch (hdr.type) {
     case message_type::handshake:
       return ec::unexpected_handshake;
     case message_type::actor_message:
+    case message_type::compact_actor_message:
       return handle_actor_message(writer, hdr, payload);
+    case message_type::message_batch:
+      return handle_message_batch(writer, hdr, payload);
     case message_type::resolve_request:
       return handle_resolve_request(writer, hdr, payload);
     case message_type::resolve_response:
@@ -188,8 +279,14 @@ error application::handle(packet_writer& writer, header hdr,
       return handle_monitor_message(writer, hdr, payload);
     case message_type::down_message:
       return handle_down_message(writer, hdr, payload);
+    case message_type::monitor_batch:
+      return handle_monitor_batch(writer, hdr, payload);
+    case message_type::down_batch:
+      return handle_down_batch(writer, hdr, payload);
     case message_type::heartbeat:
       return none;
+    case message_type::compressed_message:
+      return handle_compressed_message(writer, hdr, payload);
     default:
       return ec::unimplemented;
   }
@@ -204,9 +301,13 @@ error application::handle_handshake(packet_writer&, header hdr,
     return ec::version_mismatch;
   node_id peer_id;
   std::vector<std::string> app_ids;
+  std::vector<std::string> feature_names;
   binary_deserializer source{&executor_, payload};
   if (!source.apply_objects(peer_id, app_ids))
     return source.get_error();
+  // Peers that predate optional features omit the list entirely.
+  if (source.remaining() > 0 && !source.apply(feature_names))
+    return source.get_error();
   if (!peer_id || app_ids.empty())
     return ec::invalid_handshake;
   auto ids = get_or(system().config(), "caf.middleman.app-identifiers",
@@ -217,44 +318,39 @@ error application::handle_handshake(packet_writer&, header hdr,
   if (std::none_of(app_ids.begin(), app_ids.end(), predicate))
     return ec::app_identifiers_mismatch;
   peer_id_ = std::move(peer_id);
+  features_ = negotiate(local_features_, feature_names);
   state_ = connection_state::await_header;
   return none;
 }
 
 error application::handle_actor_message(packet_writer&, header hdr,
                                         byte_span payload) {
-  auto worker = hub_->pop();
-  if (worker != nullptr) {
-    CAF_LOG_DEBUG("launch BASP worker for deserializing an actor_message");
-    worker->launch(node_id{}, hdr, payload);
-  } else {
-    CAF_LOG_DEBUG(
-      "out of BASP workers, continue deserializing an actor_message");
-    // If no worker is available then we have no other choice than to take
-    // the performance hit and deserialize in this thread.
-    struct handler : remote_message_handler<handler> {
-      handler(message_queue* queue, proxy_registry* proxies,
-              actor_system* system, node_id last_hop, basp::header& hdr,
-              byte_span payload)
-        : queue_(queue),
-          proxies_(proxies),
-          system_(system),
-          last_hop_(std::move(last_hop)),
-          hdr_(hdr),
-          payload_(payload) {
-        msg_id_ = queue_->new_id();
-      }
-      message_queue* queue_;
-      proxy_registry* proxies_;
-      actor_system* system_;
-      node_id last_hop_;
-      basp::header& hdr_;
-      byte_span payload_;
-      uint64_t msg_id_;
-    };
-    handler f{queue_.get(), &proxies_, system_, node_id{}, hdr, payload};
-    f.handle_remote_message(&executor_);
+  // Compact envelopes refer to our node table. Hence, we must decode them here
+  // in order to process node literals in the same order the peer wrote them.
+  compact_envelope envelope;
+  if (hdr.type == message_type::compact_actor_message) {
+    // Batches pass their messages here directly, bypassing the check in
+    // `handle`.
+    if (!features_.compact_envelopes)
+      return ec::unimplemented;
+    binary_deserializer source{&executor_, payload};
+    if (!read_compact_envelope(source, incoming_nodes_, envelope)) {
+      CAF_LOG_ERROR("failed to decode compact envelope:" << source.get_error());
+      return ec::invalid_payload;
+    }
   }
+  dispatcher_->dispatch(&executor_, hdr, payload, std::move(envelope));
+  return none;
+}
+
+error application::handle_message_batch(packet_writer& writer, header hdr,
+                                        byte_span payload) {
+  CAF_LOG_TRACE(CAF_ARG(hdr) << CAF_ARG2("payload.size", payload.size()));
+  if (!read_batch(payload, hdr.operation_data, batch_buf_))
+    return ec::invalid_payload;
+  for (auto& x : batch_buf_)
+    if (auto err = handle_actor_message(writer, x.hdr, x.payload))
+      return err;
   return none;
 }
 
@@ -278,7 +374,7 @@ error application::handle_resolve_request(packet_writer& writer, header rec_hdr,
   std::set<std::string> ifs;
   if (result) {
     aid = result->id();
-    system().registry().put(aid, result);
+    export_actor(result);
   } else {
     aid = 0;
   }
@@ -329,27 +425,8 @@ error application::handle_monitor_message(packet_writer& writer,
                 << CAF_ARG2("received.size", received.size()));
   if (!received.empty())
     return ec::unexpected_payload;
-  auto aid = static_cast<actor_id>(received_hdr.operation_data);
-  auto hdl = system().registry().get(aid);
-  if (hdl != nullptr) {
-    endpoint_manager_ptr mgr = manager_;
-    auto nid = peer_id_;
-    hdl->get()->attach_functor([mgr, nid, aid](error reason) mutable {
-      mgr->enqueue_event(std::move(nid), aid, std::move(reason));
-    });
-  } else {
-    error reason = exit_reason::unknown;
-    auto payload = writer.next_payload_buffer();
-    binary_serializer sink{&executor_, payload};
-    if (!sink.apply_objects(reason))
-      return sink.get_error();
-    auto hdr = writer.next_header_buffer();
-    to_bytes(header{message_type::down_message,
-                    static_cast<uint32_t>(payload.size()),
-                    received_hdr.operation_data},
-             hdr);
-    writer.write_packet(hdr, payload);
-  }
+  monitor_local_actor(writer,
+                      static_cast<actor_id>(received_hdr.operation_data));
   return none;
 }
 
@@ -365,12 +442,151 @@ error application::handle_down_message(packet_writer&, header received_hdr,
   return none;
 }
 
+error application::handle_monitor_batch(packet_writer& writer,
+                                        header received_hdr,
+                                        byte_span received) {
+  CAF_LOG_TRACE(CAF_ARG(received_hdr)
+                << CAF_ARG2("received.size", received.size()));
+  std::vector<actor_id> ids;
+  if (auto err = control_batch::read_monitors(&executor_, received_hdr,
+                                              received, ids))
+    return err;
+  for (auto aid : ids)
+    monitor_local_actor(writer, aid);
+  return none;
+}
+
+error application::handle_down_batch(packet_writer&, header received_hdr,
+                                     byte_span received) {
+  CAF_LOG_TRACE(CAF_ARG(received_hdr)
+                << CAF_ARG2("received.size", received.size()));
+  control_batch::down_list downs;
+  if (auto err = control_batch::read_downs(&executor_, received_hdr, received,
+                                           downs))
+    return err;
+  for (auto& [aid, reason] : downs)
+    proxies_.erase(peer_id_, aid, std::move(reason));
+  return none;
+}
+
+error application::handle_compressed_message(packet_writer& writer,
+                                             header hdr, byte_span payload) {
+  CAF_LOG_TRACE(CAF_ARG(hdr) << CAF_ARG2("payload.size", payload.size()));
+  if (payload.size() < compressed_prefix_size)
+    return ec::invalid_payload;
+  message_type type;
+  if (!from_integer(static_cast<uint8_t>(payload[0]), type)
+      || type == message_type::handshake
+      || type == message_type::compressed_message)
+    return ec::invalid_payload;
+  uint32_t u32_size = 0;
+  memcpy(&u32_size, payload.data() + 1, sizeof(uint32_t));
+  auto size = static_cast<size_t>(detail::from_network_order(u32_size));
+  // The LZ4 decoder rejects sizes beyond the maximum compression ratio before
+  // allocating memory for the output.
+  auto block = payload.subspan(compressed_prefix_size);
+  decompression_buf_.clear();
+  if (size > max_decompressed_size_
+      || !detail::lz4::decompress({}, block, size, decompression_buf_))
+    return ec::invalid_payload;
+  hdr.type = type;
+  hdr.payload_len = static_cast<uint32_t>(size);
+  return handle(writer, hdr, make_span(decompression_buf_));
+}
+
+void application::monitor_local_actor(packet_writer& writer, actor_id aid) {
+  auto hdl = system().registry().get(aid);
+  if (hdl == nullptr) {
+    local_actor_down(writer, aid, exit_reason::unknown);
+    return;
+  }
+  endpoint_manager_ptr mgr = manager_;
+  auto nid = peer_id_;
+  hdl->get()->attach_functor([mgr, nid, aid](error reason) mutable {
+    mgr->enqueue_event(std::move(nid), aid, std::move(reason));
+  });
+}
+
+void application::schedule_control_flush() {
+  // The manager processes the event on its next write event, i.e., after all
+  // other events that are currently pending.
+  manager_->enqueue_event(to_string(flush_control_tag), uint64_t{0});
+}
+
+bool application::heartbeat(packet_writer& writer) {
+  // We stop reading from the socket while flow control pauses the connection.
+  // Hence, the lack of inbound data says nothing about our peer.
+  auto paused = flow_control_ != nullptr && flow_control_->paused();
+  switch (heartbeats_.tick(paused)) {
+    case heartbeat_monitor::action::disconnect:
+      CAF_LOG_WARNING("connection timed out:" << CAF_ARG2("peer", peer_id_));
+      connection_lost();
+      return false;
+    case heartbeat_monitor::action::send_heartbeat:
+      if (state_ == connection_state::await_header
+          || state_ == connection_state::await_payload) {
+        auto hdr = writer.next_header_buffer();
+        to_bytes(header{message_type::heartbeat, 0, 0}, hdr);
+        writer.write_packet(hdr);
+      }
+      break;
+    default:
+      break;
+  }
+  return true;
+}
+
+void application::connection_lost() {
+  // Killing the proxies sends down messages with reason
+  // `remote_link_unreachable` to all local actors that monitor an actor on the
+  // peer node.
+  if (peer_id_)
+    proxies_.erase(peer_id_);
+  for (auto& kvp : pending_resolves_)
+    anon_send(kvp.second, sec::remote_lookup_failed);
+  pending_resolves_.clear();
+}
+
+void application::compress_payload(message_type& type, byte_buffer& buf) {
+  if (!features_.compression || buf.size() < compression_threshold_)
+    return;
+  compression_buf_.clear();
+  compression_buf_.reserve(compressed_prefix_size
+                           + detail::lz4::compress_bound(buf.size()));
+  compression_buf_.push_back(static_cast<byte>(type));
+  auto u32_size = detail::to_network_order(static_cast<uint32_t>(buf.size()));
+  auto size_bytes = as_bytes(make_span(&u32_size, 1));
+  compression_buf_.insert(compression_buf_.end(), size_bytes.begin(),
+                          size_bytes.end());
+  detail::lz4::compress({}, buf, compression_buf_);
+  // Keep the original payload if compressing does not save any Bytes.
+  if (compression_buf_.size() >= buf.size())
+    return;
+  buf.swap(compression_buf_);
+  type = message_type::compressed_message;
+}
+
+void application::export_actor(const strong_actor_ptr& ptr) {
+  exported_actors_.add(system().registry(), ptr);
+}
+
+flow_control::resume_callback application::make_resume_callback() {
+  if (manager_ == nullptr)
+    return nullptr;
+  auto f = [target{manager_->make_event_target()}] {
+    endpoint_manager::post_event(target,
+                                 to_string(flow_control::resume_reading_tag));
+  };
+  return flow_control::resume_callback{make_type_erased_callback(f)};
+}
+
 error application::generate_handshake(byte_buffer& buf) {
   binary_serializer sink{&executor_, buf};
   if (!sink.apply_objects(system().node(),
                           get_or(system().config(),
                                  "caf.middleman.app-identifiers",
-                                 application::default_app_ids())))
+                                 application::default_app_ids()),
+                          to_names(local_features_)))
     return sink.get_error();
   return none;
 }
@@ -0,0 +1,159 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#include "caf/net/basp/compact_envelope.hpp"
+
+#include <algorithm>
+
+#include "caf/binary_deserializer.hpp"
+#include "caf/binary_serializer.hpp"
+#include "caf/byte.hpp"
+#include "caf/sec.hpp"
+#include "caf/span.hpp"
+
+namespace caf::net::basp {
+
+namespace {
+
+constexpr uint8_t to_flag(compact_flags x) noexcept {
+  return static_cast<uint8_t>(x);
+}
+
+constexpr bool has_flag(uint8_t flags, compact_flags x) noexcept {
+  return (flags & to_flag(x)) != 0;
+}
+
+} // namespace
+
+// -- node_table ---------------------------------------------------------------
+
+node_table::node_table() {
+  entries_.reserve(max_size);
+}
+
+size_t node_table::find(const node_id& x) const noexcept {
+  auto i = std::find(entries_.begin(), entries_.end(), x);
+  if (i == entries_.end())
+    return max_size;
+  return static_cast<size_t>(std::distance(entries_.begin(), i));
+}
+
+const node_id* node_table::get(size_t slot) const noexcept {
+  if (slot < entries_.size() && entries_[slot])
+    return &entries_[slot];
+  return nullptr;
+}
+
+size_t node_table::assign(node_id x) {
+  auto slot = next_slot_;
+  next_slot_ = (next_slot_ + 1) % max_size;
+  store(slot, std::move(x));
+  return slot;
+}
+
+bool node_table::store(size_t slot, node_id x) {
+  if (slot >= max_size)
+    return false;
+  if (slot >= entries_.size())
+    entries_.resize(slot + 1);
+  entries_[slot] = std::move(x);
+  return true;
+}
+
+// -- encoding and decoding ----------------------------------------------------
+
+bool write_varint(binary_serializer& sink, uint64_t x) {
+  // 64 bits require at most 10 Bytes with 7 bits per Byte.
+  byte buf[10];
+  size_t i = 0;
+  while (x > 0x7f) {
+    buf[i++] = static_cast<byte>((static_cast<uint8_t>(x) & 0x7f) | 0x80);
+    x >>= 7;
+  }
+  buf[i++] = static_cast<byte>(static_cast<uint8_t>(x) & 0x7f);
+  return sink.value(make_span(buf, i));
+}
+
+bool read_varint(binary_deserializer& source, uint64_t& x) {
+  uint64_t result = 0;
+  int shift = 0;
+  uint8_t low7 = 0;
+  do {
+    if (shift >= 64) {
+      source.emplace_error(sec::runtime_error, "varint exceeds 64 bits");
+      return false;
+    }
+    if (!source.value(low7))
+      return false;
+    result |= static_cast<uint64_t>(low7 & 0x7f) << shift;
+    shift += 7;
+  } while (low7 & 0x80);
+  x = result;
+  return true;
+}
+
+bool write_compact_envelope(binary_serializer& sink, node_table& nodes,
+                            const node_id& source_node, actor_id source_id,
+                            actor_id dest_id, bool has_stages) {
+  uint8_t flags = 0;
+  if (has_stages)
+    flags |= to_flag(compact_flags::has_stages);
+  if (!source_node || source_id == 0)
+    return sink.value(flags) && write_varint(sink, dest_id);
+  flags |= to_flag(compact_flags::has_sender);
+  auto slot = nodes.find(source_node);
+  if (slot < node_table::max_size) {
+    return sink.value(flags) && write_varint(sink, slot)
+           && write_varint(sink, source_id) && write_varint(sink, dest_id);
+  }
+  flags |= to_flag(compact_flags::node_literal);
+  slot = nodes.assign(source_node);
+  return sink.value(flags) && write_varint(sink, slot)
+         && sink.apply(source_node) && write_varint(sink, source_id)
+         && write_varint(sink, dest_id);
+}
+
+bool read_compact_envelope(binary_deserializer& source, node_table& nodes,
+                           compact_envelope& x) {
+  auto initial_size = source.remaining();
+  uint8_t flags = 0;
+  if (!source.value(flags))
+    return false;
+  x.has_stages = has_flag(flags, compact_flags::has_stages);
+  if (has_flag(flags, compact_flags::has_sender)) {
+    uint64_t slot = 0;
+    if (!read_varint(source, slot))
+      return false;
+    if (has_flag(flags, compact_flags::node_literal)) {
+      node_id nid;
+      if (!source.apply(nid))
+        return false;
+      if (!nid || !nodes.store(slot, nid)) {
+        source.emplace_error(sec::runtime_error, "invalid node literal");
+        return false;
+      }
+      x.source_node = std::move(nid);
+    } else if (auto nid = nodes.get(slot)) {
+      x.source_node = *nid;
+    } else {
+      source.emplace_error(sec::runtime_error, "unknown node table slot");
+      return false;
+    }
+    uint64_t source_id = 0;
+    if (!read_varint(source, source_id))
+      return false;
+    x.source_id = source_id;
+  } else {
+    x.source_node = node_id{};
+    x.source_id = 0;
+  }
+  uint64_t dest_id = 0;
+  if (!read_varint(source, dest_id))
+    return false;
+  x.dest_id = dest_id;
+  x.size = initial_size - source.remaining();
+  return true;
+}
+
+} // namespace caf::net::basp
@@ -0,0 +1,93 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#include "caf/net/basp/content_cache.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "caf/actor_system.hpp"
+#include "caf/binary_serializer.hpp"
+#include "caf/detail/message_data.hpp"
+
+namespace caf::net::basp {
+
+namespace {
+
+bool is_shared(const message& x) noexcept {
+  auto ptr = x.cptr();
+  return ptr != nullptr && !ptr->unique();
+}
+
+} // namespace
+
+content_cache::content_cache(size_t capacity, size_t shards)
+  : shards_(std::max(std::min(shards, capacity), size_t{1})) {
+  shard_capacity_ = (capacity + shards_.size() - 1) / shards_.size();
+}
+
+error content_cache::serialize(actor_system& sys, const message& content,
+                               byte_buffer& buf) {
+  // Messages without other copies cannot reach further receivers.
+  if (shard_capacity_ == 0 || !is_shared(content)) {
+    binary_serializer sink{sys, buf};
+    if (!sink.apply(content))
+      return sink.get_error();
+    return none;
+  }
+  auto key = content.cptr();
+  auto& x = shard_for(key);
+  buffer_ptr bytes;
+  {
+    std::unique_lock<std::mutex> guard{x.mtx};
+    expire(x);
+    if (auto i = x.entries.find(key); i != x.entries.end())
+      bytes = i->second.bytes;
+  }
+  if (bytes == nullptr) {
+    auto tmp = std::make_shared<byte_buffer>();
+    binary_serializer sink{sys, *tmp};
+    if (!sink.apply(content))
+      return sink.get_error();
+    bytes = tmp;
+    std::unique_lock<std::mutex> guard{x.mtx};
+    // Another connection may have serialized the same content meanwhile.
+    if (x.entries.emplace(key, entry{content, bytes}).second) {
+      x.order.emplace_back(key);
+      if (x.order.size() > shard_capacity_) {
+        x.entries.erase(x.order.front());
+        x.order.pop_front();
+      }
+    }
+  }
+  buf.insert(buf.end(), bytes->begin(), bytes->end());
+  return none;
+}
+
+size_t content_cache::size() const {
+  size_t result = 0;
+  for (auto& x : shards_) {
+    std::unique_lock<std::mutex> guard{x.mtx};
+    result += x.entries.size();
+  }
+  return result;
+}
+
+content_cache::shard& content_cache::shard_for(key_type key) noexcept {
+  // The lower bits of heap addresses are mostly zero due to alignment.
+  auto addr = reinterpret_cast<uintptr_t>(key) >> 4;
+  return shards_[addr % shards_.size()];
+}
+
+void content_cache::expire(shard& x) {
+  while (!x.order.empty()) {
+    auto i = x.entries.find(x.order.front());
+    if (is_shared(i->second.content))
+      return;
+    x.entries.erase(i);
+    x.order.pop_front();
+  }
+}
+
+} // namespace caf::net::basp
@@ -0,0 +1,114 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#include "caf/net/basp/control_batch.hpp"
+
+#include "caf/binary_deserializer.hpp"
+#include "caf/binary_serializer.hpp"
+#include "caf/byte_buffer.hpp"
+#include "caf/net/basp/ec.hpp"
+#include "caf/net/basp/message_type.hpp"
+#include "caf/net/packet_writer.hpp"
+#include "caf/raise_error.hpp"
+
+namespace caf::net::basp {
+
+namespace {
+
+template <class List>
+error read_list(execution_unit* ctx, header hdr, byte_span payload,
+                List& result) {
+  binary_deserializer source{ctx, payload};
+  if (!source.apply(result))
+    return source.get_error();
+  if (result.size() != hdr.operation_data || source.remaining() > 0)
+    return ec::invalid_payload;
+  return none;
+}
+
+} // namespace
+
+// -- modifiers ----------------------------------------------------------------
+
+bool control_batch::add_monitor(actor_id id) {
+  monitors_.emplace_back(id);
+  return size() == 1;
+}
+
+bool control_batch::add_down(actor_id id, error reason) {
+  downs_.emplace_back(id, std::move(reason));
+  return size() == 1;
+}
+
+size_t control_batch::flush(actor_system& sys, packet_writer& writer,
+                            bool use_batches) {
+  size_t result = 0;
+  if (monitors_.size() > 1 && use_batches) {
+    auto payload = writer.next_payload_buffer();
+    binary_serializer sink{sys, payload};
+    if (!sink.apply(monitors_))
+      CAF_RAISE_ERROR("unable to serialize actor IDs");
+    auto hdr = writer.next_header_buffer();
+    to_bytes(header{message_type::monitor_batch,
+                    static_cast<uint32_t>(payload.size()),
+                    static_cast<uint64_t>(monitors_.size())},
+             hdr);
+    writer.write_packet(hdr, payload);
+    ++result;
+  } else {
+    for (auto id : monitors_) {
+      auto hdr = writer.next_header_buffer();
+      to_bytes(header{message_type::monitor_message, 0,
+                      static_cast<uint64_t>(id)},
+               hdr);
+      writer.write_packet(hdr);
+      ++result;
+    }
+  }
+  monitors_.clear();
+  if (downs_.size() > 1 && use_batches) {
+    auto payload = writer.next_payload_buffer();
+    binary_serializer sink{sys, payload};
+    if (!sink.apply(downs_))
+      CAF_RAISE_ERROR("unable to serialize down notifications");
+    auto hdr = writer.next_header_buffer();
+    to_bytes(header{message_type::down_batch,
+                    static_cast<uint32_t>(payload.size()),
+                    static_cast<uint64_t>(downs_.size())},
+             hdr);
+    writer.write_packet(hdr, payload);
+    ++result;
+  } else {
+    for (auto& [id, reason] : downs_) {
+      auto payload = writer.next_payload_buffer();
+      binary_serializer sink{sys, payload};
+      if (!sink.apply_objects(reason))
+        CAF_RAISE_ERROR("unable to serialize an error");
+      auto hdr = writer.next_header_buffer();
+      to_bytes(header{message_type::down_message,
+                      static_cast<uint32_t>(payload.size()),
+                      static_cast<uint64_t>(id)},
+               hdr);
+      writer.write_packet(hdr, payload);
+      ++result;
+    }
+  }
+  downs_.clear();
+  return result;
+}
+
+// -- decoding -----------------------------------------------------------------
+
+error control_batch::read_monitors(execution_unit* ctx, header hdr,
+                                   byte_span payload,
+                                   std::vector<actor_id>& result) {
+  return read_list(ctx, hdr, payload, result);
+}
+
+error control_batch::read_downs(execution_unit* ctx, header hdr,
+                                byte_span payload, down_list& result) {
+  return read_list(ctx, hdr, payload, result);
+}
+
+} // namespace caf::net::basp
@@ -0,0 +1,37 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#include "caf/net/basp/export_table.hpp"
+
+#include <algorithm>
+
+#include "caf/actor_registry.hpp"
+
+namespace caf::net::basp {
+
+bool export_table::add(actor_registry& registry, const strong_actor_ptr& ptr) {
+  // Checking first avoids constructing a weak pointer for every message, which
+  // touches the reference count of the actor.
+  auto aid = ptr->id();
+  if (entries_.count(aid) != 0)
+    return false;
+  entries_.emplace(aid, weak_actor_ptr{ptr.get()});
+  registry.put(aid, ptr);
+  if (entries_.size() >= prune_at_) {
+    prune();
+    prune_at_ = std::max(prune_threshold, entries_.size() * 2);
+  }
+  return true;
+}
+
+void export_table::prune() {
+  for (auto i = entries_.begin(); i != entries_.end();) {
+    if (i->second.lock() == nullptr)
+      i = entries_.erase(i);
+    else
+      ++i;
+  }
+}
+
+} // namespace caf::net::basp
@@ -0,0 +1,56 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#include "caf/net/basp/features.hpp"
+
+#include <algorithm>
+
+namespace caf::net::basp {
+
+std::vector<std::string> to_names(const features& xs) {
+  std::vector<std::string> result;
+  if (xs.compact_envelopes)
+    result.emplace_back(to_string(compact_envelopes_feature));
+  if (xs.message_batches)
+    result.emplace_back(to_string(message_batches_feature));
+  if (xs.control_batches)
+    result.emplace_back(to_string(control_batches_feature));
+  if (xs.compression)
+    result.emplace_back(to_string(compression_feature));
+  return result;
+}
+
+features negotiate(const features& local,
+                   const std::vector<std::string>& names) {
+  auto has = [&names](string_view name) {
+    return std::find(names.begin(), names.end(), name) != names.end();
+  };
+  features result;
+  result.compact_envelopes = local.compact_envelopes
+                             && has(compact_envelopes_feature);
+  result.message_batches = local.message_batches
+                           && has(message_batches_feature);
+  result.control_batches = local.control_batches
+                           && has(control_batches_feature);
+  result.compression = local.compression && has(compression_feature);
+  return result;
+}
+
+bool permits(const features& xs, message_type x) noexcept {
+  switch (x) {
+    case message_type::compact_actor_message:
+      return xs.compact_envelopes;
+    case message_type::message_batch:
+      return xs.message_batches;
+    case message_type::monitor_batch:
+    case message_type::down_batch:
+      return xs.control_batches;
+    case message_type::compressed_message:
+      return xs.compression;
+    default:
+      return true;
+  }
+}
+
+} // namespace caf::net::basp
@@ -0,0 +1,108 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#include "caf/net/basp/flow_control.hpp"
+
+namespace caf::net::basp {
+
+namespace {
+
+class tracked_mailbox_element : public mailbox_element {
+public:
+  tracked_mailbox_element(flow_control_ptr fc, strong_actor_ptr sender,
+                          message_id id, forwarding_stack stages,
+                          message content)
+    : mailbox_element(std::move(sender), id, std::move(stages),
+                      std::move(content)),
+      fc_(std::move(fc)) {
+    fc_->delivered();
+  }
+
+  ~tracked_mailbox_element() override {
+    fc_->processed();
+  }
+
+private:
+  flow_control_ptr fc_;
+};
+
+} // namespace
+
+// -- constructors, destructors, and assignment operators ----------------------
+
+flow_control::flow_control(resume_callback on_resume, size_t high_watermark,
+                           size_t low_watermark)
+  : on_resume_(std::move(on_resume)),
+    pending_(0),
+    paused_(false),
+    high_watermark_(high_watermark),
+    low_watermark_(low_watermark) {
+  CAF_ASSERT(low_watermark < high_watermark);
+}
+
+flow_control::~flow_control() {
+  // nop
+}
+
+// -- tracking -----------------------------------------------------------------
+
+mailbox_element_ptr
+flow_control::make_element(strong_actor_ptr sender, message_id id,
+                           mailbox_element::forwarding_stack stages,
+                           message content) {
+  return mailbox_element_ptr{
+    new tracked_mailbox_element(flow_control_ptr{this}, std::move(sender), id,
+                                std::move(stages), std::move(content))};
+}
+
+bool flow_control::pause() {
+  if (pending_.load() < high_watermark_)
+    return false;
+  paused_.store(true);
+  if (pending_.load() > low_watermark_)
+    return true;
+  // Actors caught up before we set the flag. If `processed` saw the flag
+  // nonetheless, it has called the resume callback already and we must wait
+  // for it.
+  return !paused_.exchange(false);
+}
+
+void flow_control::detach() {
+  std::unique_lock<std::mutex> guard{mtx_};
+  on_resume_ = nullptr;
+}
+
+// -- callbacks for tracked elements -------------------------------------------
+
+void flow_control::delivered() noexcept {
+  ++pending_;
+}
+
+void flow_control::processed() {
+  if (--pending_ > low_watermark_ || !paused_.load())
+    return;
+  if (paused_.exchange(false)) {
+    // Holding the lock while calling the callback keeps `detach` from
+    // destroying it concurrently.
+    std::unique_lock<std::mutex> guard{mtx_};
+    if (on_resume_ != nullptr)
+      (*on_resume_)();
+  }
+}
+
+// -- free functions -----------------------------------------------------------
+
+mailbox_element_ptr
+make_tracked_mailbox_element(flow_control* fc, strong_actor_ptr sender,
+                             message_id id,
+                             mailbox_element::forwarding_stack stages,
+                             message content) {
+  if (fc == nullptr)
+    return make_mailbox_element(std::move(sender), id, std::move(stages),
+                                std::move(content));
+  return fc->make_element(std::move(sender), id, std::move(stages),
+                          std::move(content));
+}
+
+} // namespace caf::net::basp
@@ -0,0 +1,34 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#include "caf/net/basp/heartbeat_monitor.hpp"
+
+namespace caf::net::basp {
+
+// -- constructors, destructors, and assignment operators ----------------------
+
+heartbeat_monitor::heartbeat_monitor(timespan interval,
+                                     timespan connection_timeout) noexcept
+  : interval_(interval.count() > 0 ? interval : timespan{0}) {
+  if (enabled() && connection_timeout.count() > 0)
+    max_idle_ticks_ = static_cast<size_t>(
+      (connection_timeout.count() + interval_.count() - 1)
+      / interval_.count());
+}
+
+// -- event handlers -----------------------------------------------------------
+
+heartbeat_monitor::action heartbeat_monitor::tick(bool paused) noexcept {
+  if (received_since_tick_ || paused) {
+    received_since_tick_ = false;
+    idle_ticks_ = 0;
+  } else if (max_idle_ticks_ > 0 && ++idle_ticks_ >= max_idle_ticks_) {
+    return action::disconnect;
+  }
+  auto result = sent_since_tick_ ? action::none : action::send_heartbeat;
+  sent_since_tick_ = false;
+  return result;
+}
+
+} // namespace caf::net::basp
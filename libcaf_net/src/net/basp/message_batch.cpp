@@ -0,0 +1,65 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#include "caf/net/basp/message_batch.hpp"
+
+#include <algorithm>
+
+#include "caf/net/basp/constants.hpp"
+
+namespace caf::net::basp {
+
+// -- batch_writer -------------------------------------------------------------
+
+batch_writer::batch_writer(byte_buffer& buf, size_t max_messages,
+                           size_t max_bytes)
+  : buf_(buf), max_messages_(max_messages), max_bytes_(max_bytes) {
+  // nop
+}
+
+bool batch_writer::full() const noexcept {
+  return size_ >= max_messages_ || (max_bytes_ > 0 && buf_.size() >= max_bytes_);
+}
+
+byte_buffer& batch_writer::begin(size_t size_hint) {
+  offset_ = buf_.size();
+  buf_.reserve(offset_ + header_size + size_hint);
+  buf_.resize(offset_ + header_size);
+  return buf_;
+}
+
+void batch_writer::commit(message_type type, uint64_t operation_data) {
+  auto payload_len = buf_.size() - offset_ - header_size;
+  auto hdr = to_bytes(
+    header{type, static_cast<uint32_t>(payload_len), operation_data});
+  std::copy(hdr.begin(), hdr.end(), buf_.begin() + offset_);
+  ++size_;
+}
+
+void batch_writer::rollback() {
+  buf_.resize(offset_);
+}
+
+// -- free functions -----------------------------------------------------------
+
+bool read_batch(byte_span payload, uint64_t num_messages,
+                std::vector<batched_message>& out) {
+  out.clear();
+  for (uint64_t i = 0; i < num_messages; ++i) {
+    if (payload.size() < header_size)
+      return false;
+    auto hdr = header::from_bytes(payload);
+    payload = payload.subspan(header_size);
+    if (hdr.payload_len > payload.size())
+      return false;
+    if (hdr.type != message_type::actor_message
+        && hdr.type != message_type::compact_actor_message)
+      return false;
+    out.emplace_back(batched_message{hdr, payload.subspan(0, hdr.payload_len)});
+    payload = payload.subspan(hdr.payload_len);
+  }
+  return payload.empty();
+}
+
+} // namespace caf::net::basp
@@ -0,0 +1,52 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#include "caf/net/basp/message_dispatcher.hpp"
+
+#include "caf/logger.hpp"
+#include "caf/proxy_registry.hpp"
+
+namespace caf::net::basp {
+
+// -- constructors, destructors, and assignment operators ----------------------
+
+message_dispatcher::message_dispatcher(proxy_registry& proxies,
+                                       size_t num_workers, size_t threshold,
+                                       flow_control* fc)
+  : threshold_(threshold),
+    queue_(new message_queue),
+    hub_(new hub_type),
+    proxies_(&proxies),
+    system_(&proxies.system()),
+    flow_control_(fc) {
+  for (size_t i = 0; i < num_workers; ++i)
+    hub_->add_new_worker(*queue_, proxies, fc);
+}
+
+message_dispatcher::~message_dispatcher() {
+  // nop
+}
+
+// -- dispatching --------------------------------------------------------------
+
+bool message_dispatcher::dispatch(execution_unit* ctx, const header& hdr,
+                                  byte_span payload,
+                                  compact_envelope envelope) {
+  auto worker = payload.size() > threshold_ ? hub_->pop() : nullptr;
+  if (worker != nullptr) {
+    CAF_LOG_DEBUG("launch BASP worker for deserializing an actor_message");
+    worker->launch(node_id{}, hdr, payload, std::move(envelope));
+    return false;
+  }
+  CAF_LOG_DEBUG("deserialize actor_message in the I/O thread");
+  msg_id_ = queue_->new_id();
+  hdr_ = hdr;
+  payload_ = payload;
+  envelope_ = std::move(envelope);
+  handle_remote_message(ctx);
+  payload_ = byte_span{};
+  return true;
+}
+
+} // namespace caf::net::basp
@@ -32,6 +32,16 @@ std::string to_string(message_type x) {
       return "down_message";
     case message_type::heartbeat:
       return "heartbeat";
+    case message_type::compact_actor_message:
+      return "compact_actor_message";
+    case message_type::message_batch:
+      return "message_batch";
+    case message_type::monitor_batch:
+      return "monitor_batch";
+    case message_type::down_batch:
+      return "down_batch";
+    case message_type::compressed_message:
+      return "compressed_message";
   };
 }
 
@@ -57,6 +67,21 @@ bool from_string(string_view in, message_type& out) {
   } else if (in == "heartbeat") {
     out = message_type::heartbeat;
     return true;
+  } else if (in == "compact_actor_message") {
+    out = message_type::compact_actor_message;
+    return true;
+  } else if (in == "message_batch") {
+    out = message_type::message_batch;
+    return true;
+  } else if (in == "monitor_batch") {
+    out = message_type::monitor_batch;
+    return true;
+  } else if (in == "down_batch") {
+    out = message_type::down_batch;
+    return true;
+  } else if (in == "compressed_message") {
+    out = message_type::compressed_message;
+    return true;
   } else {
     return false;
   }
@@ -75,6 +100,11 @@ bool from_integer(std::underlying_type_t<message_type> in,
     case message_type::monitor_message:
     case message_type::down_message:
     case message_type::heartbeat:
+    case message_type::compact_actor_message:
+    case message_type::message_batch:
+    case message_type::monitor_batch:
+    case message_type::down_batch:
+    case message_type::compressed_message:
       out = result;
       return true;
   };
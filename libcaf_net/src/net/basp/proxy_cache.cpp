@@ -0,0 +1,42 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#include "caf/net/basp/proxy_cache.hpp"
+
+#include <functional>
+
+#include "caf/abstract_actor.hpp"
+#include "caf/proxy_registry.hpp"
+
+namespace caf::net::basp {
+
+// -- lookups ------------------------------------------------------------------
+
+strong_actor_ptr proxy_cache::get_or_put(proxy_registry& proxies,
+                                         const node_id& nid, actor_id aid) {
+  auto h = std::hash<node_id>{}(nid);
+  h ^= std::hash<actor_id>{}(aid) + 0x9e3779b9 + (h << 6) + (h >> 2);
+  auto& x = entries_[h & (capacity - 1)];
+  // The registry kills proxies when the remote actor terminates or the node
+  // disconnects. A killed proxy must not show up as sender again.
+  if (x.aid == aid && x.nid == nid && x.proxy != nullptr
+      && !x.proxy->get()->getf(abstract_actor::is_cleaned_up_flag)) {
+    ++hits_;
+    return x.proxy;
+  }
+  ++misses_;
+  x.nid = nid;
+  x.aid = aid;
+  x.proxy = proxies.get_or_put(nid, aid);
+  return x.proxy;
+}
+
+// -- modifiers ----------------------------------------------------------------
+
+void proxy_cache::clear() {
+  for (auto& x : entries_)
+    x = entry{};
+}
+
+} // namespace caf::net::basp
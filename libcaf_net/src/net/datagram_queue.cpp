@@ -0,0 +1,86 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#include "caf/net/datagram_queue.hpp"
+
+#include "caf/config.hpp"
+
+namespace caf::net {
+
+namespace {
+
+size_t round_up_to_power_of_two(size_t x) {
+  size_t result = 1;
+  while (result < x)
+    result <<= 1;
+  return result;
+}
+
+// Most datagrams consist of a header and a payload buffer.
+constexpr size_t pooled_buffers_per_slot = 2;
+
+} // namespace
+
+// -- constructors, destructors, and assignment operators ----------------------
+
+datagram_queue::datagram_queue(size_t capacity) {
+  entries_.resize(round_up_to_power_of_two(capacity));
+  pool_.reserve(entries_.size() * pooled_buffers_per_slot);
+}
+
+// -- modifiers ----------------------------------------------------------------
+
+byte_buffer datagram_queue::next_buffer() {
+  if (pool_.empty())
+    return {};
+  auto result = std::move(pool_.back());
+  pool_.pop_back();
+  return result;
+}
+
+void datagram_queue::push(const ip_endpoint& receiver,
+                          span<byte_buffer*> bufs) {
+  CAF_ASSERT(bufs.size() <= max_buffers);
+  if (size_ == capacity())
+    grow();
+  auto& x = entries_[(head_ + size_) & (capacity() - 1)];
+  x.receiver_ = receiver;
+  x.size_ = 0;
+  x.num_buffers_ = bufs.size();
+  for (size_t i = 0; i < bufs.size(); ++i) {
+    x.size_ += bufs[i]->size();
+    x.bufs_[i] = std::move(*bufs[i]);
+  }
+  ++size_;
+}
+
+void datagram_queue::pop() {
+  CAF_ASSERT(!empty());
+  auto& x = entries_[head_];
+  for (size_t i = 0; i < x.num_buffers_; ++i) {
+    auto& buf = x.bufs_[i];
+    buf.clear();
+    if (pool_.size() < pool_.capacity())
+      pool_.emplace_back(std::move(buf));
+    else
+      byte_buffer{}.swap(buf);
+  }
+  x.num_buffers_ = 0;
+  x.size_ = 0;
+  head_ = (head_ + 1) & (capacity() - 1);
+  --size_;
+}
+
+// -- utility functions --------------------------------------------------------
+
+void datagram_queue::grow() {
+  std::vector<entry> entries(capacity() * 2);
+  for (size_t i = 0; i < size_; ++i)
+    entries[i] = std::move((*this)[i]);
+  entries_.swap(entries);
+  head_ = 0;
+  pool_.reserve(entries_.size() * pooled_buffers_per_slot);
+}
+
+} // namespace caf::net
@@ -4,8 +4,79 @@
 
 #include "caf/net/endpoint_manager_queue.hpp"
 
+#include <cstdint>
+#include <string>
+#include <tuple>
+
+#include "caf/detail/meta_object.hpp"
+#include "caf/detail/node_pool.hpp"
+#include "caf/detail/serialized_size.hpp"
+#include "caf/type_id.hpp"
+#include "caf/type_id_list.hpp"
+
 namespace caf::net {
 
+namespace {
+
+/// Returns whether values of type `id` have the same serialized size
+/// regardless of their content.
+bool is_fixed_size(type_id_t id) noexcept {
+  switch (id) {
+    case type_id_v<bool>:
+    case type_id_v<double>:
+    case type_id_v<float>:
+    case type_id_v<int16_t>:
+    case type_id_v<int32_t>:
+    case type_id_v<int64_t>:
+    case type_id_v<int8_t>:
+    case type_id_v<long double>:
+    case type_id_v<uint16_t>:
+    case type_id_v<uint32_t>:
+    case type_id_v<uint64_t>:
+    case type_id_v<uint8_t>:
+    case type_id_v<timespan>:
+    case type_id_v<timestamp>:
+    case type_id_v<exit_reason>:
+    case type_id_v<sec>:
+      return true;
+    default:
+      return false;
+  }
+}
+
+size_t estimate_serialized_size(const message& content) noexcept {
+  // Fixed-size types contribute their in-memory size, which approximates the
+  // serialized size well enough for scheduling. The in-memory size of strings
+  // and containers only covers their handle. Hence, we measure strings
+  // directly and walk all other types with a size-only inspector, which
+  // writes no Bytes.
+  auto types = content.types();
+  auto result = sizeof(type_id_t) * (types.size() + 1);
+  for (size_t i = 0; i < types.size(); ++i) {
+    auto meta = detail::global_meta_object(types[i]);
+    if (meta == nullptr)
+      continue;
+    if (content.match_element<std::string>(i)) {
+      result += sizeof(uint32_t) + content.get_as<std::string>(i).size();
+    } else if (is_fixed_size(types[i])) {
+      result += meta->padded_size;
+    } else {
+      detail::serialized_size_inspector f;
+      if (meta->save(f, content.cdata().at(i)))
+        result += f.result;
+      else
+        result += meta->padded_size;
+    }
+  }
+  return result;
+}
+
+using event_pool = detail::node_pool<sizeof(endpoint_manager_queue::event)>;
+
+using message_pool = detail::node_pool<sizeof(endpoint_manager_queue::message)>;
+
+} // namespace
+
 endpoint_manager_queue::element::~element() {
   // nop
 }
@@ -41,11 +112,28 @@ size_t endpoint_manager_queue::event::task_size() const noexcept {
   return 1;
 }
 
+void* endpoint_manager_queue::event::operator new(size_t size) {
+  // Subtypes may add members, which don't fit into nodes of the pool.
+  if (size != sizeof(event))
+    return ::operator new(size);
+  return event_pool::allocate();
+}
+
+void endpoint_manager_queue::event::operator delete(void* ptr,
+                                                    size_t size) noexcept {
+  if (size != sizeof(event))
+    ::operator delete(ptr);
+  else
+    event_pool::deallocate(ptr);
+}
+
 endpoint_manager_queue::message::message(mailbox_element_ptr msg,
                                          strong_actor_ptr receiver)
-  : element(element_type::message),
+  : element(msg->mid.is_urgent_message() ? element_type::urgent_message
+                                         : element_type::message),
     msg(std::move(msg)),
-    receiver(std::move(receiver)) {
+    receiver(std::move(receiver)),
+    size_hint(estimate_serialized_size(this->msg->content())) {
   // nop
 }
 
@@ -57,4 +145,39 @@ endpoint_manager_queue::message::~message() {
   // nop
 }
 
+void* endpoint_manager_queue::message::operator new(size_t size) {
+  // Subtypes may add members, which don't fit into nodes of the pool.
+  if (size != sizeof(message))
+    return ::operator new(size);
+  return message_pool::allocate();
+}
+
+void endpoint_manager_queue::message::operator delete(void* ptr,
+                                                      size_t size) noexcept {
+  if (size != sizeof(message))
+    ::operator delete(ptr);
+  else
+    message_pool::deallocate(ptr);
+}
+
+endpoint_manager_queue::message_ptr
+endpoint_manager_queue::lane_selector::next(policy::queue_type& queue) {
+  auto& urgent_queue = std::get<1>(queue.queues());
+  auto& normal_queue = std::get<2>(queue.queues());
+  auto take = [](auto& q) -> message_ptr {
+    auto ts = q.next_task_size();
+    if (ts == 0)
+      return nullptr;
+    q.inc_deficit(ts);
+    return q.next();
+  };
+  if (!urgent_queue.empty()
+      && (normal_queue.empty() || urgent_streak_ < urgent_weight_)) {
+    ++urgent_streak_;
+    return take(urgent_queue);
+  }
+  urgent_streak_ = 0;
+  return take(normal_queue);
+}
+
 } // namespace caf::net
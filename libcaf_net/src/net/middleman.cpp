@@ -22,7 +22,17 @@ void middleman::init_global_meta_objects() {
   caf::init_global_meta_objects<id_block::net_module>();
 }
 
-middleman::middleman(actor_system& sys) : sys_(sys), mpx_(this) {
+middleman::middleman(actor_system& sys)
+  : sys_(sys),
+    mpx_(this),
+    remote_actors_(std::make_shared<remote_actor_cache>(
+      get_or(sys.config(), "caf.middleman.remote-actor-cache-ttl",
+             timespan{std::chrono::minutes(1)}))),
+    dns_(nullptr,
+         get_or(sys.config(), "caf.middleman.dns-cache-ttl",
+                resolver::default_ttl),
+         get_or(sys.config(), "caf.middleman.dns-negative-ttl",
+                resolver::default_negative_ttl)) {
   // nop
 }
 
@@ -31,6 +41,7 @@ middleman::~middleman() {
 }
 
 void middleman::start() {
+  dns_.start(get_or(config(), "caf.middleman.dns-threads", size_t{1}));
   if (!get_or(config(), "caf.middleman.manual-multiplexing", false)) {
     mpx_thread_ = std::thread{[this] {
       CAF_SET_LOGGER_SYS(&sys_);
@@ -46,8 +57,10 @@ void middleman::start() {
 }
 
 void middleman::stop() {
+  remote_actors_->clear();
   for (const auto& backend : backends_)
     backend->stop();
+  dns_.stop();
   mpx_.shutdown();
   if (mpx_thread_.joinable())
     mpx_thread_.join();
@@ -88,14 +101,80 @@ void middleman::add_module_options(actor_system_config& cfg) {
     .add<uri>("this-node", "locator of this CAF node")
     .add<size_t>("max-consecutive-reads",
                  "max. number of consecutive reads per broker")
+    .add<size_t>("datagram-batch-size",
+                 "max. number of datagrams per system call on UDP sockets")
+    .add<bool>("udp-offload",
+               "enables segmentation and receive offload (GSO/GRO) on UDP "
+               "sockets if the kernel supports it")
+    .add<size_t>("multicast-ttl",
+                 "max. number of hops for datagrams to multicast groups")
+    .add<bool>("multicast-loopback",
+               "delivers datagrams to multicast groups to members on the same "
+               "host")
     .add<bool>("manual-multiplexing",
                "disables background activity of the multiplexer")
     .add<size_t>("workers", "number of deserialization workers")
-    .add<timespan>("heartbeat-interval", "interval of heartbeat messages")
+    .add<size_t>("inline-deserialization-threshold",
+                 "max. payload size for deserializing actor messages in the "
+                 "I/O thread instead of a worker")
+    .add<bool>("compact-envelopes",
+               "enables compact envelopes for actor messages if the peer "
+               "supports them as well")
+    .add<size_t>("content-cache-size",
+                 "max. number of messages with cached content for sending "
+                 "the same message to multiple remote actors (0 disables)")
+    .add<size_t>("max-batch-size",
+                 "max. number of actor messages per BASP frame (disables "
+                 "batching if less than 2)")
+    .add<size_t>("max-batch-bytes",
+                 "max. payload size in Bytes of a BASP frame before it stops "
+                 "taking more actor messages (0 means unlimited)")
+    .add<size_t>("max-pending-messages",
+                 "max. number of delivered but unprocessed messages per "
+                 "connection before pausing reads (0 disables)")
+    .add<size_t>("max-queued-messages",
+                 "max. number of outbound messages per connection (0 means "
+                 "unlimited)")
+    .add<size_t>("max-queued-bytes",
+                 "max. estimated size of outbound messages per connection (0 "
+                 "means unlimited)")
+    .add<std::string>("overflow-strategy",
+                      "handling of outbound messages exceeding the queue "
+                      "capacity: drop_newest, drop_oldest, or notify_sender")
+    .add<size_t>("urgent-weight",
+                 "max. number of urgent messages per connection before "
+                 "sending a regular message if both are pending")
+    .add<size_t>("tcp-stripes",
+                 "number of TCP connections per peer, the first connection "
+                 "carries control traffic")
+    .add<timespan>("remote-actor-cache-ttl",
+                   "max. time for reusing the result of resolving a remote "
+                   "actor (disabled if 0)")
+    .add<timespan>("resolve-timeout",
+                   "max. time for resolving a path to a remote actor")
+    .add<timespan>("dns-cache-ttl",
+                   "max. time for reusing the addresses of a host name")
+    .add<timespan>("dns-negative-ttl",
+                   "max. time for reusing a failed host name lookup")
+    .add<size_t>("dns-threads", "number of threads for resolving host names")
+    .add<timespan>("heartbeat-interval",
+                   "interval of heartbeat messages on idle connections "
+                   "(disabled if 0)")
     .add<timespan>("connection-timeout",
                    "max. time between messages before declaring a node dead "
                    "(disabled if 0, ignored if heartbeats are disabled)")
     .add<std::string>("network-backend", "legacy option");
+  config_option_adder{cfg.custom_options(), "caf.middleman.compression"}
+    .add<bool>("enable", "enables compression if the peer accepts it as well")
+    .add<bool>("dictionary",
+               "enables compression with a dictionary of recent messages")
+    .add<size_t>("threshold", "min. message size for compressing a message")
+    .add<size_t>("dictionary-threshold",
+                 "min. message size for compressing with a dictionary")
+    .add<size_t>("max-ratio",
+                 "max. ratio between decompressed and compressed size")
+    .add<size_t>("max-message-size",
+                 "max. size of an incoming message after decompressing");
 }
 
 expected<endpoint_manager_ptr> middleman::connect(const uri& locator) {
@@ -106,11 +185,48 @@ expected<endpoint_manager_ptr> middleman::connect(const uri& locator) {
 }
 
 void middleman::resolve(const uri& locator, const actor& listener) {
+  if (auto hit = remote_actors_->get(locator)) {
+    anon_send(listener, std::move(hit->proxy), std::move(hit->ifs));
+    return;
+  }
   auto ptr = backend(locator.scheme());
-  if (ptr != nullptr)
-    ptr->resolve(locator, listener);
-  else
+  if (ptr == nullptr) {
     anon_send(listener, error{basp::ec::invalid_scheme});
+    return;
+  }
+  if (!remote_actors_->enabled()) {
+    ptr->resolve(locator, listener);
+    return;
+  }
+  // Put a relay between the backend and the listener that fills the cache. The
+  // relay gives up after a timeout in case the backend never answers.
+  auto timeout = get_or(config(), "caf.middleman.resolve-timeout",
+                        default_resolve_timeout);
+  auto relay = [cache{remote_actors_}, locator, listener,
+                timeout](event_based_actor* self) -> behavior {
+    self->set_error_handler([self, listener](scheduled_actor*, error& err) {
+      self->send(listener, std::move(err));
+      self->quit();
+    });
+    return {
+      [=](strong_actor_ptr& proxy, std::set<std::string>& ifs) {
+        cache->put(locator, proxy, ifs);
+        self->send(listener, std::move(proxy), std::move(ifs));
+        self->quit();
+      },
+      [=](sec code) {
+        self->send(listener, code);
+        self->quit();
+      },
+      after(timeout) >>
+        [=] {
+          self->send(listener, make_error(sec::request_timeout,
+                                          "backend did not resolve the path"));
+          self->quit();
+        },
+    };
+  };
+  ptr->resolve(locator, sys_.spawn(relay));
 }
 
 middleman_backend* middleman::backend(string_view scheme) const noexcept {
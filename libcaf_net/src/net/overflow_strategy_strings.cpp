@@ -0,0 +1,61 @@
+// clang-format off
+// DO NOT EDIT: this file is auto-generated by caf-generate-enum-strings.
+// Run the target update-enum-strings if this file is out of sync.
+#include "caf/config.hpp"
+#include "caf/string_view.hpp"
+
+CAF_PUSH_DEPRECATED_WARNING
+
+#include "caf/net/overflow_strategy.hpp"
+
+#include <string>
+
+namespace caf {
+namespace net {
+
+std::string to_string(overflow_strategy x) {
+  switch(x) {
+    default:
+      return "???";
+    case overflow_strategy::drop_newest:
+      return "drop_newest";
+    case overflow_strategy::drop_oldest:
+      return "drop_oldest";
+    case overflow_strategy::notify_sender:
+      return "notify_sender";
+  };
+}
+
+bool from_string(string_view in, overflow_strategy& out) {
+  if (in == "drop_newest") {
+    out = overflow_strategy::drop_newest;
+    return true;
+  } else if (in == "drop_oldest") {
+    out = overflow_strategy::drop_oldest;
+    return true;
+  } else if (in == "notify_sender") {
+    out = overflow_strategy::notify_sender;
+    return true;
+  } else {
+    return false;
+  }
+}
+
+bool from_integer(std::underlying_type_t<overflow_strategy> in,
+                  overflow_strategy& out) {
+  auto result = static_cast<overflow_strategy>(in);
+  switch(result) {
+    default:
+      return false;
+    case overflow_strategy::drop_newest:
+    case overflow_strategy::drop_oldest:
+    case overflow_strategy::notify_sender:
+      out = result;
+      return true;
+  };
+}
+
+} // namespace net
+} // namespace caf
+
+CAF_POP_WARNINGS
@@ -0,0 +1,82 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#include "caf/net/queue_capacity.hpp"
+
+#include "caf/actor_addr.hpp"
+#include "caf/actor_system_config.hpp"
+#include "caf/detail/sync_request_bouncer.hpp"
+#include "caf/logger.hpp"
+#include "caf/sec.hpp"
+
+namespace caf::net {
+
+// -- constructors, destructors, and assignment operators ----------------------
+
+queue_capacity::queue_capacity(size_t max_messages, size_t max_bytes,
+                               overflow_strategy strategy) noexcept
+  : max_messages_(max_messages),
+    max_bytes_(max_bytes),
+    strategy_(strategy),
+    messages_(0),
+    bytes_(0) {
+  // nop
+}
+
+queue_capacity::queue_capacity(const actor_system_config& cfg)
+  : queue_capacity(get_or(cfg, "caf.middleman.max-queued-messages", size_t{0}),
+                   get_or(cfg, "caf.middleman.max-queued-bytes", size_t{0}),
+                   overflow_strategy::drop_newest) {
+  if (auto str = get_if<std::string>(&cfg, "caf.middleman.overflow-strategy"))
+    if (!from_string(*str, strategy_))
+      CAF_LOG_WARNING("unknown overflow strategy:" << *str);
+}
+
+// -- bookkeeping --------------------------------------------------------------
+
+bool queue_capacity::try_add(size_t size_hint) noexcept {
+  auto factor = strategy_ == overflow_strategy::drop_oldest ? 2 : 1;
+  if (exceeds(messages_.load() + 1, bytes_.load() + size_hint, factor))
+    return false;
+  ++messages_;
+  bytes_ += size_hint;
+  return true;
+}
+
+void queue_capacity::remove(size_t size_hint) noexcept {
+  --messages_;
+  bytes_ -= size_hint;
+}
+
+bool queue_capacity::must_drop_oldest() const noexcept {
+  return strategy_ == overflow_strategy::drop_oldest
+         && exceeds(messages_.load(), bytes_.load(), 1);
+}
+
+void queue_capacity::reject(const endpoint_manager_queue::message& x) const {
+  CAF_LOG_DEBUG("outbound queue full, reject message:"
+                << CAF_ARG(strategy_)
+                << CAF_ARG2("messages", messages_.load()));
+  auto& elem = *x.msg;
+  if (elem.mid.is_request()) {
+    detail::sync_request_bouncer bouncer{
+      make_error(sec::unavailable_or_would_block)};
+    bouncer(elem);
+  } else if (strategy_ == overflow_strategy::notify_sender
+             && elem.sender != nullptr) {
+    auto receiver = actor_cast<actor_addr>(x.receiver);
+    elem.sender->enqueue(nullptr, make_message_id(),
+                         make_message(sec::unavailable_or_would_block,
+                                      std::move(receiver)),
+                         nullptr);
+  }
+}
+
+bool queue_capacity::exceeds(size_t messages, size_t bytes,
+                             size_t factor) const noexcept {
+  return (max_messages_ > 0 && messages > max_messages_ * factor)
+         || (max_bytes_ > 0 && bytes > max_bytes_ * factor);
+}
+
+} // namespace caf::net
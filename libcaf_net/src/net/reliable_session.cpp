@@ -0,0 +1,298 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#include "caf/net/reliable_session.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "caf/byte.hpp"
+#include "caf/detail/network_order.hpp"
+#include "caf/logger.hpp"
+#include "caf/optional.hpp"
+#include "caf/sec.hpp"
+
+namespace caf::net {
+
+namespace {
+
+template <class T>
+void write_int(byte* ptr, T x) {
+  auto y = detail::to_network_order(x);
+  memcpy(ptr, &y, sizeof(T));
+}
+
+template <class T>
+T read_int(const byte* ptr) {
+  T x;
+  memcpy(&x, ptr, sizeof(T));
+  return detail::from_network_order(x);
+}
+
+// Layout: type (1), reserved (1), stream (2), seq (8), stream seq (8).
+void write_data(byte_buffer& buf, uint64_t seq, uint16_t stream,
+                uint64_t stream_seq, const byte_buffer& payload) {
+  buf.resize(reliable_session::header_size);
+  auto ptr = buf.data();
+  ptr[0] = static_cast<byte>(reliable_session::segment_type::data);
+  ptr[1] = byte{0};
+  write_int(ptr + 2, stream);
+  write_int(ptr + 4, seq);
+  write_int(ptr + 12, stream_seq);
+  buf.insert(buf.end(), payload.begin(), payload.end());
+}
+
+// Layout: type (1), reserved (3), next expected seq (8), SACK bitmap (8).
+void write_ack(byte_buffer& buf, uint64_t next_expected, uint64_t sack) {
+  buf.resize(reliable_session::header_size);
+  auto ptr = buf.data();
+  ptr[0] = static_cast<byte>(reliable_session::segment_type::ack);
+  memset(ptr + 1, 0, 3);
+  write_int(ptr + 4, next_expected);
+  write_int(ptr + 12, sack);
+}
+
+} // namespace
+
+// -- constructors, destructors, and assignment operators ----------------------
+
+reliable_session::reliable_session(size_t max_segment_size)
+  : max_segment_size_(max_segment_size) {
+  CAF_ASSERT(max_segment_size > 0);
+}
+
+// -- sending ------------------------------------------------------------------
+
+void reliable_session::send(stream_id stream, const_byte_span bytes) {
+  auto& st = streams_[stream];
+  for (size_t offset = 0; offset < bytes.size();
+       offset += max_segment_size_) {
+    auto first = bytes.begin() + offset;
+    auto n = std::min(max_segment_size_, bytes.size() - offset);
+    segment x;
+    x.stream = stream;
+    x.stream_seq = st.next_send++;
+    x.payload.assign(first, first + n);
+    unsent_.emplace_back(std::move(x));
+  }
+}
+
+void reliable_session::poll(time_point now, std::vector<byte_buffer>& out) {
+  if (ack_pending_) {
+    uint64_t sack = 0;
+    for (auto seq : received_) {
+      auto bit = seq - next_expected_ - 1;
+      if (bit >= 64)
+        break;
+      sack |= uint64_t{1} << bit;
+    }
+    out.emplace_back();
+    write_ack(out.back(), next_expected_, sack);
+    ack_pending_ = false;
+  }
+  // Fast retransmit of segments that the peer reported as missing.
+  for (auto& [seq, x] : in_flight_)
+    if (x.lost)
+      retransmit(now, seq, x, out);
+  // On timeout, assume the network dropped everything in flight: retransmit
+  // the oldest segment, collapse the window and back off the timer.
+  if (!in_flight_.empty() && now >= rto_deadline_) {
+    CAF_LOG_DEBUG("retransmission timeout:" << CAF_ARG2("rto", rto_));
+    ssthresh_ = std::max(in_flight_.size() / 2, size_t{2});
+    cwnd_ = 1;
+    ca_acked_ = 0;
+    in_recovery_ = false;
+    ++backoffs_;
+    rto_ = std::min(rto_ * 2, max_rto);
+    auto& [seq, x] = *in_flight_.begin();
+    x.dup_acks = 0;
+    retransmit(now, seq, x, out);
+    rto_deadline_ = now + rto_;
+  }
+  // Send new segments while the window has room. The window limits the range
+  // of sequence numbers in flight, which also keeps the sender within the
+  // receive window of our peer.
+  while (!unsent_.empty() && next_seq_ - send_unacknowledged() < cwnd_) {
+    auto seq = next_seq_++;
+    auto& x = in_flight_.emplace(seq, std::move(unsent_.front())).first->second;
+    unsent_.pop_front();
+    x.sent = now;
+    out.emplace_back();
+    write_data(out.back(), seq, x.stream, x.stream_seq, x.payload);
+    if (rto_deadline_ == time_point::max())
+      rto_deadline_ = now + rto_;
+  }
+}
+
+// -- receiving ----------------------------------------------------------------
+
+error reliable_session::handle_datagram(time_point now,
+                                        const_byte_span datagram) {
+  if (datagram.size() < header_size)
+    return make_error(sec::runtime_error, "segment too short");
+  auto ptr = datagram.data();
+  switch (static_cast<segment_type>(ptr[0])) {
+    case segment_type::data:
+      return handle_data(read_int<uint64_t>(ptr + 4),
+                         read_int<uint16_t>(ptr + 2),
+                         read_int<uint64_t>(ptr + 12),
+                         datagram.subspan(header_size,
+                                          datagram.size() - header_size));
+    case segment_type::ack:
+      return handle_ack(now, read_int<uint64_t>(ptr + 4),
+                        read_int<uint64_t>(ptr + 12));
+    default:
+      return make_error(sec::runtime_error, "unknown segment type");
+  }
+}
+
+void reliable_session::drain(std::vector<delivery>& out) {
+  if (out.empty()) {
+    out.swap(delivered_);
+  } else {
+    out.insert(out.end(), std::make_move_iterator(delivered_.begin()),
+               std::make_move_iterator(delivered_.end()));
+    delivered_.clear();
+  }
+}
+
+// -- utility functions --------------------------------------------------------
+
+error reliable_session::handle_data(uint64_t seq, stream_id stream,
+                                    uint64_t stream_seq,
+                                    const_byte_span payload) {
+  // Acknowledge duplicates as well, since our previous acknowledgement may
+  // have been lost.
+  ack_pending_ = true;
+  if (seq < next_expected_ || received_.count(seq) > 0)
+    return none;
+  // Drop segments beyond the receive window. The sender retransmits them.
+  if (seq - next_expected_ >= max_window)
+    return none;
+  // A well-behaved sender never gets that far ahead in a single stream, since
+  // it sends the segments of a stream in order.
+  auto& st = streams_[stream];
+  if (stream_seq < st.next_receive)
+    return make_error(sec::runtime_error, "stream sequence number reused");
+  if (stream_seq - st.next_receive >= max_window)
+    return make_error(sec::runtime_error,
+                      "stream sequence number beyond the receive window");
+  if (seq == next_expected_) {
+    ++next_expected_;
+    while (!received_.empty() && *received_.begin() == next_expected_) {
+      received_.erase(received_.begin());
+      ++next_expected_;
+    }
+  } else {
+    received_.emplace(seq);
+  }
+  if (stream_seq != st.next_receive) {
+    st.pending.emplace(stream_seq, byte_buffer{payload.begin(), payload.end()});
+    return none;
+  }
+  delivered_.emplace_back(delivery{stream, {payload.begin(), payload.end()}});
+  ++st.next_receive;
+  auto i = st.pending.begin();
+  while (i != st.pending.end() && i->first == st.next_receive) {
+    delivered_.emplace_back(delivery{stream, std::move(i->second)});
+    ++st.next_receive;
+    i = st.pending.erase(i);
+  }
+  return none;
+}
+
+error reliable_session::handle_ack(time_point now, uint64_t next_expected,
+                                   uint64_t sack) {
+  if (next_expected > next_seq_)
+    return make_error(sec::runtime_error, "acknowledged an unsent segment");
+  size_t acked = 0;
+  optional<timespan> sample;
+  auto ack = [&](auto i) {
+    // Karn's algorithm: retransmitted segments produce no RTT samples, since
+    // we cannot tell which transmission the acknowledgement refers to.
+    if (!i->second.retransmitted)
+      sample = std::chrono::duration_cast<timespan>(now - i->second.sent);
+    ++acked;
+    return in_flight_.erase(i);
+  };
+  auto i = in_flight_.begin();
+  while (i != in_flight_.end() && i->first < next_expected)
+    i = ack(i);
+  uint64_t highest_sacked = 0;
+  for (uint64_t bit = 0; bit < 64; ++bit) {
+    if ((sack & (uint64_t{1} << bit)) == 0)
+      continue;
+    highest_sacked = next_expected + 1 + bit;
+    if (auto j = in_flight_.find(highest_sacked); j != in_flight_.end())
+      ack(j);
+  }
+  if (sample)
+    update_rtt(*sample);
+  if (acked > 0) {
+    backoffs_ = 0;
+    if (in_recovery_ && next_expected >= recovery_point_)
+      in_recovery_ = false;
+    if (!in_recovery_)
+      grow_window(acked);
+    rto_deadline_ = in_flight_.empty() ? time_point::max() : now + rto_;
+  }
+  // Each acknowledgement for a later segment counts as a hint that the
+  // network dropped the segments below it.
+  for (auto& [seq, x] : in_flight_) {
+    if (seq >= highest_sacked)
+      break;
+    if (++x.dup_acks == dup_threshold) {
+      x.lost = true;
+      enter_recovery();
+    }
+  }
+  return none;
+}
+
+void reliable_session::retransmit(time_point now, uint64_t seq, segment& x,
+                                  std::vector<byte_buffer>& out) {
+  x.retransmitted = true;
+  x.lost = false;
+  x.sent = now;
+  ++retransmissions_;
+  out.emplace_back();
+  write_data(out.back(), seq, x.stream, x.stream_seq, x.payload);
+}
+
+void reliable_session::update_rtt(timespan sample) {
+  if (!has_rtt_) {
+    srtt_ = sample;
+    rttvar_ = sample / 2;
+    has_rtt_ = true;
+  } else {
+    auto delta = srtt_ > sample ? srtt_ - sample : sample - srtt_;
+    rttvar_ = (rttvar_ * 3 + delta) / 4;
+    srtt_ = (srtt_ * 7 + sample) / 8;
+  }
+  rto_ = std::clamp(srtt_ + rttvar_ * 4, min_rto, max_rto);
+}
+
+void reliable_session::grow_window(size_t acked) {
+  if (cwnd_ < ssthresh_) {
+    cwnd_ = std::min(cwnd_ + acked, max_window);
+    return;
+  }
+  ca_acked_ += acked;
+  if (ca_acked_ >= cwnd_) {
+    ca_acked_ -= cwnd_;
+    cwnd_ = std::min(cwnd_ + 1, max_window);
+  }
+}
+
+void reliable_session::enter_recovery() {
+  if (in_recovery_)
+    return;
+  in_recovery_ = true;
+  recovery_point_ = next_seq_;
+  ssthresh_ = std::max(cwnd_ / 2, size_t{2});
+  cwnd_ = ssthresh_;
+  ca_acked_ = 0;
+}
+
+} // namespace caf::net
@@ -0,0 +1,88 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#include "caf/net/remote_actor_cache.hpp"
+
+#include "caf/abstract_actor.hpp"
+#include "caf/actor_cast.hpp"
+
+namespace caf::net {
+
+// -- constructors, destructors, and assignment operators ----------------------
+
+remote_actor_cache::remote_actor_cache(timespan ttl) : ttl_(ttl) {
+  // nop
+}
+
+// -- properties ---------------------------------------------------------------
+
+size_t remote_actor_cache::size() const {
+  std::unique_lock<std::mutex> guard{mtx_};
+  return entries_.size();
+}
+
+size_t remote_actor_cache::num_attached() const {
+  std::unique_lock<std::mutex> guard{mtx_};
+  return attached_.size();
+}
+
+// -- lookups ------------------------------------------------------------------
+
+optional<remote_actor_cache::entry>
+remote_actor_cache::get(const uri& locator, time_point now) {
+  std::unique_lock<std::mutex> guard{mtx_};
+  auto i = entries_.find(to_string(locator));
+  if (i == entries_.end())
+    return none;
+  if (i->second.expires <= now) {
+    entries_.erase(i);
+    return none;
+  }
+  return i->second;
+}
+
+// -- modifiers ----------------------------------------------------------------
+
+void remote_actor_cache::put(const uri& locator, strong_actor_ptr proxy,
+                             std::set<std::string> ifs, time_point now) {
+  if (!enabled() || proxy == nullptr)
+    return;
+  auto addr = actor_cast<actor_addr>(proxy);
+  {
+    std::unique_lock<std::mutex> guard{mtx_};
+    entries_[to_string(locator)] = entry{proxy, std::move(ifs), now + ttl_};
+    if (!attached_.emplace(addr).second)
+      return;
+  }
+  // Proxies call attached functors when the remote actor terminates or when
+  // the connection to its node breaks down.
+  std::weak_ptr<remote_actor_cache> weak_self = shared_from_this();
+  proxy->get()->attach_functor([weak_self, addr] {
+    if (auto self = weak_self.lock())
+      self->erase(addr);
+  });
+}
+
+void remote_actor_cache::erase(const uri& locator) {
+  std::unique_lock<std::mutex> guard{mtx_};
+  entries_.erase(to_string(locator));
+}
+
+void remote_actor_cache::clear() {
+  std::unique_lock<std::mutex> guard{mtx_};
+  entries_.clear();
+}
+
+void remote_actor_cache::erase(const actor_addr& addr) {
+  std::unique_lock<std::mutex> guard{mtx_};
+  attached_.erase(addr);
+  for (auto i = entries_.begin(); i != entries_.end();) {
+    if (actor_cast<actor_addr>(i->second.proxy) == addr)
+      i = entries_.erase(i);
+    else
+      ++i;
+  }
+}
+
+} // namespace caf::net
@@ -0,0 +1,194 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#include "caf/net/resolver.hpp"
+
+#include <algorithm>
+#include <future>
+#include <thread>
+
+#include "caf/detail/set_thread_name.hpp"
+#include "caf/net/ip.hpp"
+
+namespace caf::net {
+
+// -- constructors, destructors, and assignment operators ----------------------
+
+resolver::shared_state::shared_state(lookup_function lookup, timespan ttl,
+                                     timespan negative_ttl)
+  : ttl(ttl), negative_ttl(negative_ttl), lookup(std::move(lookup)) {
+  if (!this->lookup)
+    this->lookup = [](const std::string& host) { return ip::resolve(host); };
+}
+
+resolver::resolver(lookup_function lookup, timespan ttl, timespan negative_ttl)
+  : state_(std::make_shared<shared_state>(std::move(lookup), ttl,
+                                          negative_ttl)) {
+  // nop
+}
+
+resolver::~resolver() {
+  stop();
+}
+
+// -- properties ---------------------------------------------------------------
+
+size_t resolver::size() const {
+  std::unique_lock<std::mutex> guard{state_->mtx};
+  return state_->entries.size();
+}
+
+bool resolver::running() const {
+  std::unique_lock<std::mutex> guard{state_->mtx};
+  return state_->num_threads > 0;
+}
+
+bool resolver::stopped() const {
+  std::unique_lock<std::mutex> guard{state_->mtx};
+  return state_->shutting_down;
+}
+
+// -- lifetime management ------------------------------------------------------
+
+void resolver::start(size_t num_threads) {
+  std::unique_lock<std::mutex> guard{state_->mtx};
+  if (state_->num_threads > 0)
+    return;
+  state_->shutting_down = false;
+  state_->num_threads = std::max(num_threads, size_t{1});
+  for (size_t i = 0; i < state_->num_threads; ++i)
+    std::thread{[st{state_}, gen{state_->generation}] {
+      detail::set_thread_name("caf.net.dns");
+      st->run(gen);
+    }}.detach();
+}
+
+void resolver::stop() {
+  std::unordered_map<std::string, std::vector<handler_type>> pending;
+  {
+    std::unique_lock<std::mutex> guard{state_->mtx};
+    state_->shutting_down = true;
+    state_->num_threads = 0;
+    ++state_->generation;
+    pending.swap(state_->pending);
+    state_->jobs.clear();
+  }
+  state_->cv.notify_all();
+  // Threads that are still busy with a lookup find no handlers to call.
+  for (auto& kvp : pending)
+    for (auto& f : kvp.second)
+      (*f)(address_list{});
+}
+
+// -- lookups ------------------------------------------------------------------
+
+optional<resolver::address_list> resolver::cached(const std::string& host,
+                                                  time_point now) {
+  std::unique_lock<std::mutex> guard{state_->mtx};
+  auto& entries = state_->entries;
+  auto i = entries.find(host);
+  if (i == entries.end())
+    return none;
+  if (i->second.expires <= now) {
+    entries.erase(i);
+    return none;
+  }
+  return i->second.addresses;
+}
+
+void resolver::async_resolve(const std::string& host, handler_type f) {
+  // After `stop`, neither perform a lookup on the caller's thread nor return
+  // cached addresses. The owner is shutting down and should not start any new
+  // connection attempts.
+  if (stopped()) {
+    (*f)(address_list{});
+    return;
+  }
+  if (auto hit = cached(host)) {
+    (*f)(*hit);
+    return;
+  }
+  std::unique_lock<std::mutex> guard{state_->mtx};
+  if (state_->shutting_down) {
+    guard.unlock();
+    (*f)(address_list{});
+    return;
+  }
+  auto& handlers = state_->pending[host];
+  handlers.emplace_back(std::move(f));
+  // Only the first request for a host triggers a lookup.
+  if (handlers.size() > 1)
+    return;
+  if (state_->num_threads > 0) {
+    state_->jobs.emplace_back(host);
+    guard.unlock();
+    state_->cv.notify_one();
+    return;
+  }
+  auto lookup = state_->lookup;
+  guard.unlock();
+  state_->complete(host, lookup(host));
+}
+
+resolver::address_list resolver::resolve(const std::string& host) {
+  std::promise<address_list> result;
+  auto f = [&result](const address_list& addresses) {
+    result.set_value(addresses);
+  };
+  async_resolve(host, std::move(f));
+  return result.get_future().get();
+}
+
+// -- modifiers ----------------------------------------------------------------
+
+void resolver::set_lookup_function(lookup_function lookup) {
+  std::unique_lock<std::mutex> guard{state_->mtx};
+  state_->lookup = std::move(lookup);
+  state_->entries.clear();
+}
+
+void resolver::clear() {
+  std::unique_lock<std::mutex> guard{state_->mtx};
+  state_->entries.clear();
+}
+
+// -- utility functions --------------------------------------------------------
+
+void resolver::shared_state::run(size_t gen) {
+  for (;;) {
+    std::string host;
+    lookup_function f;
+    {
+      std::unique_lock<std::mutex> guard{mtx};
+      cv.wait(guard, [this, gen] {
+        return generation != gen || !jobs.empty();
+      });
+      if (generation != gen)
+        return;
+      host = std::move(jobs.front());
+      jobs.pop_front();
+      f = lookup;
+    }
+    complete(host, f(host));
+  }
+}
+
+void resolver::shared_state::complete(const std::string& host,
+                                      address_list addresses) {
+  std::vector<handler_type> handlers;
+  {
+    std::unique_lock<std::mutex> guard{mtx};
+    auto dt = addresses.empty() ? negative_ttl : ttl;
+    if (dt.count() > 0)
+      entries[host] = entry{addresses, clock_type::now() + dt};
+    if (auto i = pending.find(host); i != pending.end()) {
+      handlers.swap(i->second);
+      pending.erase(i);
+    }
+  }
+  for (auto& f : handlers)
+    (*f)(addresses);
+}
+
+} // namespace caf::net
@@ -0,0 +1,104 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#include "caf/net/tcp_connector.hpp"
+
+#include "caf/logger.hpp"
+#include "caf/make_counted.hpp"
+#include "caf/net/multiplexer.hpp"
+#include "caf/sec.hpp"
+
+namespace caf::net {
+
+// -- constructors, destructors, and assignment operators ----------------------
+
+tcp_connector::tcp_connector(tcp_stream_socket handle, multiplexer* parent,
+                             race_ptr state)
+  : super(handle, parent), race_(std::move(state)) {
+  // nop
+}
+
+tcp_connector::~tcp_connector() {
+  // nop
+}
+
+// -- factories ----------------------------------------------------------------
+
+void tcp_connector::start(multiplexer& mpx,
+                          const std::vector<ip_endpoint>& endpoints,
+                          handler_type f) {
+  auto state = std::make_shared<race>();
+  state->handler = std::move(f);
+  std::vector<tcp_stream_socket> sockets;
+  sockets.reserve(endpoints.size());
+  for (const auto& ep : endpoints) {
+    if (auto sock = make_connecting_tcp_stream_socket(ep))
+      sockets.emplace_back(*sock);
+    else
+      state->last_error = std::move(sock.error());
+  }
+  if (sockets.empty()) {
+    if (!state->last_error)
+      state->last_error = make_error(sec::cannot_connect_to_node,
+                                     "no endpoint to connect to");
+    (*state->handler)(std::move(state->last_error));
+    return;
+  }
+  // Set the counter before handing any connector to the multiplexer thread.
+  state->pending = sockets.size();
+  for (auto sock : sockets)
+    mpx.init(make_counted<tcp_connector>(sock, &mpx, state));
+}
+
+// -- interface functions ------------------------------------------------------
+
+error tcp_connector::init(const settings&) {
+  CAF_LOG_TRACE(CAF_ARG2("socket", handle_.id));
+  register_writing();
+  return none;
+}
+
+bool tcp_connector::handle_read_event() {
+  return false;
+}
+
+bool tcp_connector::handle_write_event() {
+  CAF_LOG_TRACE(CAF_ARG2("socket", handle_.id));
+  if (completed_)
+    return false;
+  if (auto err = connect_result(handle())) {
+    fail(std::move(err));
+    return false;
+  }
+  completed_ = true;
+  if (race_->done) {
+    // Another connector won the race. Our destructor closes the socket.
+    return false;
+  }
+  race_->done = true;
+  auto sock = handle();
+  // Transfer ownership of the socket to the handler.
+  handle_ = invalid_socket;
+  (*race_->handler)(sock);
+  return false;
+}
+
+void tcp_connector::handle_error(sec code) {
+  if (!completed_)
+    fail(make_error(code));
+}
+
+// -- utility functions --------------------------------------------------------
+
+void tcp_connector::fail(error reason) {
+  CAF_LOG_DEBUG("connection attempt failed:" << reason);
+  completed_ = true;
+  race_->last_error = std::move(reason);
+  if (--race_->pending == 0 && !race_->done) {
+    race_->done = true;
+    (*race_->handler)(std::move(race_->last_error));
+  }
+}
+
+} // namespace caf::net
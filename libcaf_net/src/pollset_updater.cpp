@@ -56,6 +56,9 @@ bool pollset_updater::handle_read_event() {
           case shutdown_code:
             parent_->shutdown();
             break;
+          case dispatch_code:
+            parent_->run_dispatched();
+            break;
           default:
             CAF_LOG_ERROR("opcode not recognized: " << CAF_ARG(opcode));
             break;
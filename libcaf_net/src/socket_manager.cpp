@@ -43,6 +43,24 @@ bool socket_manager::mask_del(operation flag) noexcept {
   return true;
 }
 
+socket_manager::event_target_ptr socket_manager::make_event_target() {
+  if (event_target_ == nullptr)
+    event_target_ = std::make_shared<event_target>(
+      event_target{parent_, handle_});
+  return event_target_;
+}
+
+void socket_manager::post(const event_target_ptr& target, manager_callback f) {
+  CAF_ASSERT(target != nullptr);
+  // The multiplexer looks up the manager in its own thread, where it holds a
+  // strong reference to the manager.
+  auto g = [target, f{std::move(f)}](socket_manager& mgr) mutable {
+    if (mgr.event_target_ == target)
+      (*f)(mgr);
+  };
+  target->mpx->dispatch(target->handle, std::move(g));
+}
+
 void socket_manager::register_reading() {
   if ((mask() & operation::read) == operation::read)
     return;
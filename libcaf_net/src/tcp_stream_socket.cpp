@@ -4,8 +4,12 @@
 
 #include "caf/net/tcp_stream_socket.hpp"
 
+#include <cerrno>
+
+#include "caf/config.hpp"
 #include "caf/detail/net_syscall.hpp"
 #include "caf/detail/sockaddr_members.hpp"
+#include "caf/detail/socket_sys_aliases.hpp"
 #include "caf/detail/socket_sys_includes.hpp"
 #include "caf/expected.hpp"
 #include "caf/ipv4_address.hpp"
@@ -20,7 +24,7 @@ namespace caf::net {
 namespace {
 
 template <int Family>
-bool ip_connect(stream_socket fd, std::string host, uint16_t port) {
+int ip_connect(stream_socket fd, std::string host, uint16_t port) {
   CAF_LOG_TRACE("Family =" << (Family == AF_INET ? "AF_INET" : "AF_INET6")
                            << CAF_ARG(fd.id) << CAF_ARG(host) << CAF_ARG(port));
   static_assert(Family == AF_INET || Family == AF_INET6, "invalid family");
@@ -33,13 +37,25 @@ bool ip_connect(stream_socket fd, std::string host, uint16_t port) {
   detail::family_of(sa) = Family;
   detail::port_of(sa) = htons(port);
   using sa_ptr = const sockaddr*;
-  return ::connect(fd.id, reinterpret_cast<sa_ptr>(&sa), sizeof(sa)) == 0;
+  return ::connect(fd.id, reinterpret_cast<sa_ptr>(&sa), sizeof(sa));
 }
 
-} // namespace
+int ip_connect(stream_socket fd, const ip_endpoint& node) {
+  if (node.address().embeds_v4())
+    return ip_connect<AF_INET>(fd, to_string(node.address().embedded_v4()),
+                               node.port());
+  return ip_connect<AF_INET6>(fd, to_string(node.address()), node.port());
+}
 
-expected<tcp_stream_socket> make_connected_tcp_stream_socket(ip_endpoint node) {
-  CAF_LOG_DEBUG("tcp connect to: " << to_string(node));
+bool last_connect_in_progress() {
+#ifdef CAF_WINDOWS
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EINPROGRESS;
+#endif
+}
+
+expected<tcp_stream_socket> make_tcp_stream_socket(const ip_endpoint& node) {
   auto proto = node.address().embeds_v4() ? AF_INET : AF_INET6;
   int socktype = SOCK_STREAM;
 #ifdef SOCK_CLOEXEC
@@ -47,23 +63,56 @@ expected<tcp_stream_socket> make_connected_tcp_stream_socket(ip_endpoint node) {
 #endif
   CAF_NET_SYSCALL("socket", fd, ==, -1, ::socket(proto, socktype, 0));
   tcp_stream_socket sock{fd};
-  if (auto err = child_process_inherit(sock, false))
+  if (auto err = child_process_inherit(sock, false)) {
+    close(sock);
     return err;
-  auto sguard = make_socket_guard(sock);
-  if (proto == AF_INET6) {
-    if (ip_connect<AF_INET6>(sock, to_string(node.address()), node.port())) {
-      CAF_LOG_INFO("successfully connected to (IPv6):" << to_string(node));
-      return sguard.release();
-    }
-  } else if (ip_connect<AF_INET>(sock, to_string(node.address().embedded_v4()),
-                                 node.port())) {
-    CAF_LOG_INFO("successfully connected to (IPv4):" << to_string(node));
+  }
+  return sock;
+}
+
+} // namespace
+
+expected<tcp_stream_socket> make_connected_tcp_stream_socket(ip_endpoint node) {
+  CAF_LOG_DEBUG("tcp connect to: " << to_string(node));
+  auto sock = make_tcp_stream_socket(node);
+  if (!sock)
+    return sock.error();
+  auto sguard = make_socket_guard(*sock);
+  if (ip_connect(*sock, node) == 0) {
+    CAF_LOG_INFO("successfully connected to:" << to_string(node));
     return sguard.release();
   }
   CAF_LOG_WARNING("could not connect to: " << to_string(node));
   return make_error(sec::cannot_connect_to_node);
 }
 
+expected<tcp_stream_socket>
+make_connecting_tcp_stream_socket(ip_endpoint node) {
+  CAF_LOG_DEBUG("nonblocking tcp connect to: " << to_string(node));
+  auto sock = make_tcp_stream_socket(node);
+  if (!sock)
+    return sock.error();
+  auto sguard = make_socket_guard(*sock);
+  if (auto err = nonblocking(*sock, true))
+    return err;
+  if (ip_connect(*sock, node) == 0 || last_connect_in_progress())
+    return sguard.release();
+  CAF_LOG_WARNING("could not connect to: " << to_string(node));
+  return make_error(sec::cannot_connect_to_node);
+}
+
+error connect_result(tcp_stream_socket x) {
+  int code = 0;
+  socket_size_type len = sizeof(code);
+  CAF_NET_SYSCALL("getsockopt", res, !=, 0,
+                  getsockopt(x.id, SOL_SOCKET, SO_ERROR,
+                             reinterpret_cast<getsockopt_ptr>(&code), &len));
+  if (code != 0)
+    return make_error(sec::cannot_connect_to_node, "connect failed with code",
+                      code);
+  return none;
+}
+
 expected<tcp_stream_socket>
 make_connected_tcp_stream_socket(const uri::authority_type& node) {
   auto port = node.port;
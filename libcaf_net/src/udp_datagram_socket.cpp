@@ -4,6 +4,10 @@
 
 #include "caf/net/udp_datagram_socket.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
 #include "caf/byte.hpp"
 #include "caf/byte_buffer.hpp"
 #include "caf/detail/convert_ip_endpoint.hpp"
@@ -11,11 +15,17 @@
 #include "caf/detail/socket_sys_aliases.hpp"
 #include "caf/detail/socket_sys_includes.hpp"
 #include "caf/expected.hpp"
+#include "caf/ip_address.hpp"
 #include "caf/ip_endpoint.hpp"
+#include "caf/ipv4_address.hpp"
 #include "caf/logger.hpp"
 #include "caf/net/socket_guard.hpp"
 #include "caf/span.hpp"
 
+#ifdef CAF_LINUX
+#  include <netinet/udp.h>
+#endif // CAF_LINUX
+
 namespace caf::net {
 
 #ifdef CAF_WINDOWS
@@ -71,6 +81,127 @@ make_udp_datagram_socket(ip_endpoint ep, bool reuse_addr) {
   return std::make_pair(sguard.release(), ntohs(port));
 }
 
+namespace {
+
+#ifdef CAF_WINDOWS
+using ipv4_multicast_option = DWORD;
+#else
+using ipv4_multicast_option = unsigned char;
+#endif
+
+bool is_multicast(const ip_address& x) {
+  const auto& bytes = x.bytes();
+  // IPv4 multicast addresses are in 224.0.0.0/4, IPv6 addresses in ff00::/8.
+  if (x.embeds_v4())
+    return (static_cast<uint8_t>(bytes[12]) & 0xF0) == 0xE0;
+  return static_cast<uint8_t>(bytes[0]) == 0xFF;
+}
+
+// Returns the address family of the local endpoint of `x`.
+int socket_family(udp_datagram_socket x) {
+  sockaddr_storage addr = {};
+  socklen_t len = sizeof(addr);
+  if (getsockname(x.id, reinterpret_cast<sockaddr*>(&addr), &len) != 0)
+    return AF_UNSPEC;
+  return addr.ss_family;
+}
+
+// Returns whether `x` is an IPv6 socket that also sends to IPv4 addresses,
+// i.e., to IPv4-mapped IPv6 addresses. The kernel applies the IPv4 multicast
+// options to these datagrams.
+bool is_dual_stack(udp_datagram_socket x) {
+  int v6only = 1;
+  socklen_t len = sizeof(v6only);
+  if (getsockopt(x.id, IPPROTO_IPV6, IPV6_V6ONLY,
+                 reinterpret_cast<getsockopt_ptr>(&v6only), &len)
+      != 0)
+    return false;
+  return v6only == 0;
+}
+
+error update_multicast_membership(udp_datagram_socket x,
+                                  const ip_address& group,
+                                  uint32_t interface_index, bool join) {
+  if (group.embeds_v4()) {
+    ip_mreq mreq;
+    memset(&mreq, 0, sizeof(mreq));
+    mreq.imr_multiaddr.s_addr = group.embedded_v4().bits();
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    auto opt = join ? IP_ADD_MEMBERSHIP : IP_DROP_MEMBERSHIP;
+    CAF_NET_SYSCALL("setsockopt", res, !=, 0,
+                    setsockopt(x.id, IPPROTO_IP, opt,
+                               reinterpret_cast<setsockopt_ptr>(&mreq),
+                               static_cast<socket_size_type>(sizeof(mreq))));
+  } else {
+    ipv6_mreq mreq;
+    memset(&mreq, 0, sizeof(mreq));
+    memcpy(&mreq.ipv6mr_multiaddr, group.bytes().data(), group.bytes().size());
+    mreq.ipv6mr_interface = interface_index;
+    auto opt = join ? IPV6_JOIN_GROUP : IPV6_LEAVE_GROUP;
+    CAF_NET_SYSCALL("setsockopt", res, !=, 0,
+                    setsockopt(x.id, IPPROTO_IPV6, opt,
+                               reinterpret_cast<setsockopt_ptr>(&mreq),
+                               static_cast<socket_size_type>(sizeof(mreq))));
+  }
+  return none;
+}
+
+} // namespace
+
+error join_multicast_group(udp_datagram_socket x, const ip_address& group,
+                           uint32_t interface_index) {
+  CAF_LOG_TRACE(CAF_ARG(x) << CAF_ARG(group) << CAF_ARG(interface_index));
+  if (!is_multicast(group))
+    return make_error(sec::invalid_argument, "not a multicast address");
+  return update_multicast_membership(x, group, interface_index, true);
+}
+
+error leave_multicast_group(udp_datagram_socket x, const ip_address& group,
+                            uint32_t interface_index) {
+  CAF_LOG_TRACE(CAF_ARG(x) << CAF_ARG(group) << CAF_ARG(interface_index));
+  if (!is_multicast(group))
+    return make_error(sec::invalid_argument, "not a multicast address");
+  return update_multicast_membership(x, group, interface_index, false);
+}
+
+error multicast_ttl(udp_datagram_socket x, uint8_t hops) {
+  CAF_LOG_TRACE(CAF_ARG(x) << CAF_ARG(hops));
+  if (socket_family(x) == AF_INET6) {
+    int value = hops;
+    CAF_NET_SYSCALL("setsockopt", res, !=, 0,
+                    setsockopt(x.id, IPPROTO_IPV6, IPV6_MULTICAST_HOPS,
+                               reinterpret_cast<setsockopt_ptr>(&value),
+                               static_cast<socket_size_type>(sizeof(value))));
+    if (!is_dual_stack(x))
+      return none;
+  }
+  ipv4_multicast_option value = hops;
+  CAF_NET_SYSCALL("setsockopt", res, !=, 0,
+                  setsockopt(x.id, IPPROTO_IP, IP_MULTICAST_TTL,
+                             reinterpret_cast<setsockopt_ptr>(&value),
+                             static_cast<socket_size_type>(sizeof(value))));
+  return none;
+}
+
+error multicast_loopback(udp_datagram_socket x, bool new_value) {
+  CAF_LOG_TRACE(CAF_ARG(x) << CAF_ARG(new_value));
+  if (socket_family(x) == AF_INET6) {
+    unsigned value = new_value ? 1 : 0;
+    CAF_NET_SYSCALL("setsockopt", res, !=, 0,
+                    setsockopt(x.id, IPPROTO_IPV6, IPV6_MULTICAST_LOOP,
+                               reinterpret_cast<setsockopt_ptr>(&value),
+                               static_cast<socket_size_type>(sizeof(value))));
+    if (!is_dual_stack(x))
+      return none;
+  }
+  ipv4_multicast_option value = new_value ? 1 : 0;
+  CAF_NET_SYSCALL("setsockopt", res, !=, 0,
+                  setsockopt(x.id, IPPROTO_IP, IP_MULTICAST_LOOP,
+                             reinterpret_cast<setsockopt_ptr>(&value),
+                             static_cast<socket_size_type>(sizeof(value))));
+  return none;
+}
+
 variant<std::pair<size_t, ip_endpoint>, sec> read(udp_datagram_socket x,
                                                   span<byte> buf) {
   sockaddr_storage addr = {};
@@ -165,6 +296,210 @@ variant<size_t, sec> write(udp_datagram_socket x, span<byte_buffer*> bufs,
 
 #endif // CAF_WINDOWS
 
+#ifdef CAF_LINUX
+
+variant<size_t, sec> read_batch(udp_datagram_socket x,
+                                span<udp_datagram_slot> slots) {
+  auto n = std::min(slots.size(), max_udp_batch_size);
+  if (n == 0)
+    return size_t{0};
+  mmsghdr msgs[max_udp_batch_size];
+  iovec iovs[max_udp_batch_size];
+  sockaddr_storage addrs[max_udp_batch_size];
+  // Receives the segment size if the kernel coalesced datagrams (GRO).
+  alignas(cmsghdr) char ctrl[max_udp_batch_size][CMSG_SPACE(sizeof(int))];
+  for (size_t i = 0; i < n; ++i) {
+    iovs[i] = iovec{slots[i].buf.data(), slots[i].buf.size()};
+    memset(&msgs[i], 0, sizeof(mmsghdr));
+    auto& hdr = msgs[i].msg_hdr;
+    hdr.msg_name = &addrs[i];
+    hdr.msg_namelen = sizeof(sockaddr_storage);
+    hdr.msg_iov = &iovs[i];
+    hdr.msg_iovlen = 1;
+    hdr.msg_control = ctrl[i];
+    hdr.msg_controllen = sizeof(ctrl[i]);
+  }
+  auto res = recvmmsg(x.id, msgs, static_cast<unsigned>(n), 0, nullptr);
+  auto ret = check_udp_datagram_socket_io_res(res);
+  auto num_msgs = get_if<size_t>(&ret);
+  if (num_msgs == nullptr)
+    return ret;
+  // Moves valid datagrams to the front, since dropping a datagram from an
+  // unsupported address must not discard the other datagrams of the batch.
+  size_t valid = 0;
+  for (size_t i = 0; i < *num_msgs; ++i) {
+    auto& slot = slots[i];
+    slot.size = msgs[i].msg_len;
+    slot.segment_size = 0;
+#  ifdef UDP_GRO
+    auto& hdr = msgs[i].msg_hdr;
+    for (auto cm = CMSG_FIRSTHDR(&hdr); cm != nullptr;
+         cm = CMSG_NXTHDR(&hdr, cm)) {
+      if (cm->cmsg_level == IPPROTO_UDP && cm->cmsg_type == UDP_GRO) {
+        int seg = 0;
+        memcpy(&seg, CMSG_DATA(cm), sizeof(seg));
+        slot.segment_size = static_cast<size_t>(seg);
+      }
+    }
+#  endif // UDP_GRO
+    CAF_LOG_WARNING_IF((msgs[i].msg_hdr.msg_flags & MSG_TRUNC) != 0,
+                       "recvmmsg cut of message, only received "
+                         << CAF_ARG2("bytes", slot.size));
+    if (auto err = detail::convert(addrs[i], slot.ep)) {
+      CAF_LOG_WARNING("drop datagram from unsupported address:" << err);
+      continue;
+    }
+    if (valid != i)
+      std::swap(slots[valid], slot);
+    ++valid;
+  }
+  return valid;
+}
+
+variant<size_t, sec> write_batch(udp_datagram_socket x,
+                                 span<const udp_datagram_view> datagrams) {
+  auto n = std::min(datagrams.size(), max_udp_batch_size);
+  if (n == 0)
+    return size_t{0};
+  mmsghdr msgs[max_udp_batch_size];
+  iovec iovs[max_udp_batch_size][10];
+  sockaddr_storage addrs[max_udp_batch_size];
+  auto convert = [](byte_buffer* buf) {
+    return iovec{buf->data(), buf->size()};
+  };
+  for (size_t i = 0; i < n; ++i) {
+    auto& dgram = datagrams[i];
+    CAF_ASSERT(dgram.bufs.size() < 10);
+    std::transform(dgram.bufs.begin(), dgram.bufs.end(), std::begin(iovs[i]),
+                   convert);
+    memset(&addrs[i], 0, sizeof(sockaddr_storage));
+    detail::convert(dgram.ep, addrs[i]);
+    memset(&msgs[i], 0, sizeof(mmsghdr));
+    auto& hdr = msgs[i].msg_hdr;
+    hdr.msg_name = &addrs[i];
+    hdr.msg_namelen = dgram.ep.address().embeds_v4() ? sizeof(sockaddr_in)
+                                                     : sizeof(sockaddr_in6);
+    hdr.msg_iov = iovs[i];
+    hdr.msg_iovlen = dgram.bufs.size();
+  }
+  auto res = sendmmsg(x.id, msgs, static_cast<unsigned>(n), 0);
+  return check_udp_datagram_socket_io_res(res);
+}
+
+udp_offload_support enable_udp_offload(udp_datagram_socket x) {
+  udp_offload_support result;
+#  ifdef UDP_SEGMENT
+  // Kernels without GSO (before 4.18) reject the option.
+  int gso_size = 0;
+  socklen_t len = sizeof(gso_size);
+  result.gso = getsockopt(x.id, IPPROTO_UDP, UDP_SEGMENT, &gso_size, &len)
+               == 0;
+#  endif // UDP_SEGMENT
+#  ifdef UDP_GRO
+  // Kernels without GRO for UDP sockets (before 5.0) reject the option.
+  int on = 1;
+  result.gro = setsockopt(x.id, IPPROTO_UDP, UDP_GRO, &on, sizeof(on)) == 0;
+#  endif // UDP_GRO
+  CAF_LOG_DEBUG(CAF_ARG(x.id) << CAF_ARG2("gso", result.gso)
+                              << CAF_ARG2("gro", result.gro));
+  return result;
+}
+
+#  ifdef UDP_SEGMENT
+
+variant<size_t, sec> write_segmented(udp_datagram_socket x,
+                                     span<byte_buffer*> bufs,
+                                     size_t segment_size, ip_endpoint ep) {
+  CAF_ASSERT(bufs.size() <= max_udp_gso_buffers);
+  CAF_ASSERT(segment_size > 0 && segment_size <= max_udp_gso_bytes);
+  iovec iovs[max_udp_gso_buffers];
+  std::transform(bufs.begin(), bufs.end(), std::begin(iovs),
+                 [](byte_buffer* buf) {
+                   return iovec{buf->data(), buf->size()};
+                 });
+  sockaddr_storage addr = {};
+  detail::convert(ep, addr);
+  alignas(cmsghdr) char ctrl[CMSG_SPACE(sizeof(uint16_t))] = {};
+  msghdr message = {};
+  memset(&message, 0, sizeof(msghdr));
+  message.msg_name = &addr;
+  message.msg_namelen = ep.address().embeds_v4() ? sizeof(sockaddr_in)
+                                                 : sizeof(sockaddr_in6);
+  message.msg_iov = iovs;
+  message.msg_iovlen = bufs.size();
+  message.msg_control = ctrl;
+  message.msg_controllen = sizeof(ctrl);
+  auto cm = CMSG_FIRSTHDR(&message);
+  cm->cmsg_level = IPPROTO_UDP;
+  cm->cmsg_type = UDP_SEGMENT;
+  cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+  auto seg = static_cast<uint16_t>(segment_size);
+  memcpy(CMSG_DATA(cm), &seg, sizeof(seg));
+  auto res = sendmsg(x.id, &message, 0);
+  return check_udp_datagram_socket_io_res(res);
+}
+
+#  else // UDP_SEGMENT
+
+variant<size_t, sec> write_segmented(udp_datagram_socket, span<byte_buffer*>,
+                                     size_t, ip_endpoint) {
+  return sec::feature_disabled;
+}
+
+#  endif // UDP_SEGMENT
+
+#else // CAF_LINUX
+
+// Other platforms lack batched system calls. Hence, we fall back to one
+// system call per datagram.
+
+variant<size_t, sec> read_batch(udp_datagram_socket x,
+                                span<udp_datagram_slot> slots) {
+  auto n = std::min(slots.size(), max_udp_batch_size);
+  size_t received = 0;
+  for (; received < n; ++received) {
+    auto& slot = slots[received];
+    auto ret = read(x, slot.buf);
+    if (auto res = get_if<std::pair<size_t, ip_endpoint>>(&ret)) {
+      slot.size = std::min(res->first, slot.buf.size());
+      slot.segment_size = 0;
+      slot.ep = res->second;
+    } else if (received == 0) {
+      return get<sec>(ret);
+    } else {
+      break;
+    }
+  }
+  return received;
+}
+
+variant<size_t, sec> write_batch(udp_datagram_socket x,
+                                 span<const udp_datagram_view> datagrams) {
+  auto n = std::min(datagrams.size(), max_udp_batch_size);
+  size_t sent = 0;
+  for (; sent < n; ++sent) {
+    auto& dgram = datagrams[sent];
+    auto ret = write(x, dgram.bufs, dgram.ep);
+    if (holds_alternative<sec>(ret)) {
+      if (sent == 0)
+        return ret;
+      break;
+    }
+  }
+  return sent;
+}
+
+udp_offload_support enable_udp_offload(udp_datagram_socket) {
+  return {};
+}
+
+variant<size_t, sec> write_segmented(udp_datagram_socket, span<byte_buffer*>,
+                                     size_t, ip_endpoint) {
+  return sec::feature_disabled;
+}
+
+#endif // CAF_LINUX
+
 variant<size_t, sec>
 check_udp_datagram_socket_io_res(std::make_signed<size_t>::type res) {
   if (res < 0) {
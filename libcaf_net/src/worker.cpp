@@ -14,8 +14,13 @@ namespace caf::net::basp {
 
 // -- constructors, destructors, and assignment operators ----------------------
 
-worker::worker(hub_type& hub, message_queue& queue, proxy_registry& proxies)
-  : hub_(&hub), queue_(&queue), proxies_(&proxies), system_(&proxies.system()) {
+worker::worker(hub_type& hub, message_queue& queue, proxy_registry& proxies,
+               flow_control* fc)
+  : hub_(&hub),
+    queue_(&queue),
+    proxies_(&proxies),
+    system_(&proxies.system()),
+    flow_control_(fc) {
   CAF_IGNORE_UNUSED(pad_);
 }
 
@@ -26,11 +31,12 @@ worker::~worker() {
 // -- management ---------------------------------------------------------------
 
 void worker::launch(const node_id& last_hop, const basp::header& hdr,
-                    span<const byte> payload) {
+                    span<const byte> payload, compact_envelope envelope) {
   msg_id_ = queue_->new_id();
   last_hop_ = last_hop;
   memcpy(&hdr_, &hdr, sizeof(basp::header));
   payload_.assign(payload.begin(), payload.end());
+  envelope_ = std::move(envelope);
   ref();
   system_->scheduler().enqueue(this);
 }
@@ -11,10 +11,14 @@
 #include <vector>
 
 #include "caf/byte_buffer.hpp"
+#include "caf/detail/lz4.hpp"
+#include "caf/detail/network_order.hpp"
 #include "caf/forwarding_actor_proxy.hpp"
+#include "caf/net/basp/compact_envelope.hpp"
 #include "caf/net/basp/connection_state.hpp"
 #include "caf/net/basp/constants.hpp"
 #include "caf/net/basp/ec.hpp"
+#include "caf/net/endpoint_manager_queue.hpp"
 #include "caf/net/middleman.hpp"
 #include "caf/net/packet_writer.hpp"
 #include "caf/none.hpp"
@@ -29,9 +33,16 @@ using namespace caf::net;
 
 namespace {
 
+constexpr auto heartbeat_interval = timespan{std::chrono::seconds(10)};
+
+constexpr auto connection_timeout = timespan{std::chrono::seconds(60)};
+
 struct config : actor_system_config {
   config() {
     net::middleman::add_module_options(*this);
+    put(content, "caf.middleman.heartbeat-interval", heartbeat_interval);
+    put(content, "caf.middleman.connection-timeout", connection_timeout);
+    put(content, "caf.middleman.max-pending-messages", 64);
   }
 };
 
@@ -60,9 +71,18 @@ struct fixture : test_coordinator_fixture<config>,
   }
 
   void handle_handshake() {
+    handle_handshake_payload(
+      to_buf(mars, basp::application::default_app_ids()));
+  }
+
+  void handle_handshake(const std::vector<std::string>& features) {
+    handle_handshake_payload(
+      to_buf(mars, basp::application::default_app_ids(), features));
+  }
+
+  void handle_handshake_payload(const byte_buffer& payload) {
     CAF_CHECK_EQUAL(app.state(),
                     basp::connection_state::await_handshake_header);
-    auto payload = to_buf(mars, basp::application::default_app_ids());
     set_input(basp::header{basp::message_type::handshake,
                            static_cast<uint32_t>(payload.size()),
                            basp::version});
@@ -81,9 +101,10 @@ struct fixture : test_coordinator_fixture<config>,
       CAF_FAIL("invalid handshake header");
     node_id nid;
     std::vector<std::string> app_ids;
+    std::vector<std::string> features;
     binary_deserializer source{sys, output};
     source.skip(basp::header_size);
-    if (auto err = source(nid, app_ids))
+    if (auto err = source(nid, app_ids, features))
       CAF_FAIL("unable to deserialize payload: " << err);
     if (source.remaining() > 0)
       CAF_FAIL("trailing bytes after reading payload");
@@ -239,6 +260,204 @@ CAF_TEST(actor message) {
   expect((std::string), from(_).to(self).with("hello world!"));
 }
 
+CAF_TEST(the threshold selects between inline and worker deserialization) {
+  handle_handshake();
+  consume_handshake();
+  sys.registry().put(self->id(), self);
+  CAF_REQUIRE_EQUAL(self->mailbox().size(), 0u);
+  auto mock = [this](const std::string& str) {
+    MOCK(basp::message_type::actor_message, make_message_id().integer_value(),
+         mars, actor_id{42}, self->id(), std::vector<strong_actor_ptr>{},
+         make_message(str));
+  };
+  CAF_MESSAGE("the I/O thread deserializes payloads up to the threshold");
+  mock("hello");
+  CAF_CHECK_EQUAL(self->mailbox().size(), 2u);
+  expect((monitor_atom, strong_actor_ptr), from(_).to(self));
+  expect((std::string), from(_).to(self).with("hello"));
+  CAF_MESSAGE("workers deserialize payloads above the threshold");
+  auto threshold = basp::application::default_inline_deserialization_threshold;
+  std::string large(threshold * 2, 'a');
+  mock(large);
+  CAF_CHECK_EQUAL(self->mailbox().size(), 0u);
+  sched.run();
+  expect((std::string), from(_).to(self).with(large));
+}
+
+CAF_TEST(compact actor message) {
+  handle_handshake({to_string(basp::application::compact_envelopes_feature)});
+  consume_handshake();
+  sys.registry().put(self->id(), self);
+  CAF_REQUIRE_EQUAL(self->mailbox().size(), 0u);
+  basp::node_table nodes;
+  byte_buffer payload;
+  binary_serializer sink{sys, payload};
+  if (!basp::write_compact_envelope(sink, nodes, mars, 42, self->id(), false)
+      || !sink.apply(make_message("hello world!")))
+    CAF_FAIL("failed to serialize data: " << sink.get_error());
+  set_input(basp::header{basp::message_type::compact_actor_message,
+                         static_cast<uint32_t>(payload.size()),
+                         make_message_id().integer_value()});
+  REQUIRE_OK(app.handle_data(*this, input));
+  REQUIRE_OK(app.handle_data(*this, payload));
+  expect((monitor_atom, strong_actor_ptr), from(_).to(self));
+  expect((std::string), from(_).to(self).with("hello world!"));
+}
+
+CAF_TEST(message batch) {
+  handle_handshake({to_string(basp::application::message_batches_feature)});
+  consume_handshake();
+  sys.registry().put(self->id(), self);
+  CAF_REQUIRE_EQUAL(self->mailbox().size(), 0u);
+  byte_buffer payload;
+  for (auto str : {"hello", "world"}) {
+    auto msg_payload = to_buf(mars, actor_id{42}, self->id(),
+                              std::vector<strong_actor_ptr>{},
+                              make_message(std::string{str}));
+    auto hdr = to_bytes(basp::header{basp::message_type::actor_message,
+                                     static_cast<uint32_t>(msg_payload.size()),
+                                     make_message_id().integer_value()});
+    payload.insert(payload.end(), hdr.begin(), hdr.end());
+    payload.insert(payload.end(), msg_payload.begin(), msg_payload.end());
+  }
+  set_input(basp::header{basp::message_type::message_batch,
+                         static_cast<uint32_t>(payload.size()), 2});
+  REQUIRE_OK(app.handle_data(*this, input));
+  REQUIRE_OK(app.handle_data(*this, payload));
+  expect((monitor_atom, strong_actor_ptr), from(_).to(self));
+  expect((std::string), from(_).to(self).with("hello"));
+  expect((std::string), from(_).to(self).with("world"));
+}
+
+CAF_TEST(message batch with trailing bytes) {
+  handle_handshake({to_string(basp::application::message_batches_feature)});
+  consume_handshake();
+  auto msg_payload = to_buf(mars, actor_id{42}, self->id(),
+                            std::vector<strong_actor_ptr>{},
+                            make_message("hello"));
+  auto hdr = to_bytes(basp::header{basp::message_type::actor_message,
+                                   static_cast<uint32_t>(msg_payload.size()),
+                                   make_message_id().integer_value()});
+  byte_buffer payload{hdr.begin(), hdr.end()};
+  payload.insert(payload.end(), msg_payload.begin(), msg_payload.end());
+  payload.emplace_back(byte{0});
+  set_input(basp::header{basp::message_type::message_batch,
+                         static_cast<uint32_t>(payload.size()), 1});
+  REQUIRE_OK(app.handle_data(*this, input));
+  CAF_CHECK_EQUAL(app.handle_data(*this, payload), basp::ec::invalid_payload);
+}
+
+CAF_TEST(optional features require support on both sides) {
+  handle_handshake();
+  consume_handshake();
+  CAF_CHECK(!app.compact_envelopes());
+  CAF_CHECK(!app.message_batches());
+  CAF_CHECK(!app.compression());
+}
+
+CAF_TEST(peers must not send compact actor messages without agreeing) {
+  handle_handshake();
+  consume_handshake();
+  CAF_REQUIRE(!app.compact_envelopes());
+  basp::node_table nodes;
+  byte_buffer payload;
+  binary_serializer sink{sys, payload};
+  if (!basp::write_compact_envelope(sink, nodes, mars, 42, self->id(), false)
+      || !sink.apply(make_message("hello world!")))
+    CAF_FAIL("failed to serialize data: " << sink.get_error());
+  set_input(basp::header{basp::message_type::compact_actor_message,
+                         static_cast<uint32_t>(payload.size()),
+                         make_message_id().integer_value()});
+  REQUIRE_OK(app.handle_data(*this, input));
+  CAF_CHECK_EQUAL(app.handle_data(*this, payload), basp::ec::unimplemented);
+}
+
+CAF_TEST(compressed actor message) {
+  handle_handshake({to_string(basp::application::compression_feature)});
+  consume_handshake();
+  sys.registry().put(self->id(), self);
+  CAF_REQUIRE_EQUAL(self->mailbox().size(), 0u);
+  std::string str(1000, 'a');
+  auto plain = to_buf(mars, actor_id{42}, self->id(),
+                      std::vector<strong_actor_ptr>{}, make_message(str));
+  byte_buffer payload;
+  payload.push_back(static_cast<byte>(basp::message_type::actor_message));
+  auto u32_size = detail::to_network_order(static_cast<uint32_t>(plain.size()));
+  auto size_bytes = as_bytes(make_span(&u32_size, 1));
+  payload.insert(payload.end(), size_bytes.begin(), size_bytes.end());
+  detail::lz4::compress({}, plain, payload);
+  set_input(basp::header{basp::message_type::compressed_message,
+                         static_cast<uint32_t>(payload.size()),
+                         make_message_id().integer_value()});
+  REQUIRE_OK(app.handle_data(*this, input));
+  REQUIRE_OK(app.handle_data(*this, payload));
+  expect((monitor_atom, strong_actor_ptr), from(_).to(self));
+  expect((std::string), from(_).to(self).with(str));
+}
+
+CAF_TEST(compressed messages must not claim more than the max ratio) {
+  handle_handshake({to_string(basp::application::compression_feature)});
+  consume_handshake();
+  byte_buffer payload;
+  payload.push_back(static_cast<byte>(basp::message_type::actor_message));
+  auto u32_size = detail::to_network_order(uint32_t{INT32_MAX});
+  auto size_bytes = as_bytes(make_span(&u32_size, 1));
+  payload.insert(payload.end(), size_bytes.begin(), size_bytes.end());
+  for (auto x : {0x1F, 0x61, 0x01, 0x00, 0x00})
+    payload.push_back(static_cast<byte>(x));
+  set_input(basp::header{basp::message_type::compressed_message,
+                         static_cast<uint32_t>(payload.size()),
+                         make_message_id().integer_value()});
+  REQUIRE_OK(app.handle_data(*this, input));
+  CAF_CHECK_EQUAL(app.handle_data(*this, payload), basp::ec::invalid_payload);
+}
+
+CAF_TEST(compression for large outgoing messages) {
+  handle_handshake({to_string(basp::application::compression_feature)});
+  consume_handshake();
+  CAF_REQUIRE(app.compression());
+  auto dst = proxies.get_or_put(mars, 42);
+  auto elem = make_mailbox_element(self->ctrl(), make_message_id(), {},
+                                   make_message(std::string(1000, 'a')));
+  using message_type = endpoint_manager_queue::message;
+  REQUIRE_OK(app.write_message(
+    *this, std::make_unique<message_type>(std::move(elem), dst)));
+  auto hdr = basp::header::from_bytes(output);
+  CAF_CHECK_EQUAL(hdr.type, basp::message_type::compressed_message);
+  CAF_CHECK_EQUAL(hdr.payload_len, output.size() - basp::header_size);
+  CAF_CHECK_LESS(hdr.payload_len, 1000u);
+  CAF_CHECK_EQUAL(static_cast<uint8_t>(output[basp::header_size]),
+                  static_cast<uint8_t>(basp::message_type::actor_message));
+}
+
+CAF_TEST(compact envelopes for outgoing messages) {
+  handle_handshake({to_string(basp::application::compact_envelopes_feature)});
+  consume_handshake();
+  CAF_REQUIRE(app.compact_envelopes());
+  auto dst = proxies.get_or_put(mars, 42);
+  auto elem = make_mailbox_element(self->ctrl(), make_message_id(), {},
+                                   make_message("hello world!"));
+  using message_type = endpoint_manager_queue::message;
+  REQUIRE_OK(app.write_message(
+    *this, std::make_unique<message_type>(std::move(elem), dst)));
+  auto hdr = basp::header::from_bytes(output);
+  CAF_CHECK_EQUAL(hdr.type, basp::message_type::compact_actor_message);
+  CAF_CHECK_EQUAL(hdr.payload_len, output.size() - basp::header_size);
+  basp::node_table nodes;
+  basp::compact_envelope envelope;
+  binary_deserializer source{sys, output};
+  source.skip(basp::header_size);
+  CAF_REQUIRE(basp::read_compact_envelope(source, nodes, envelope));
+  CAF_CHECK_EQUAL(envelope.source_node, sys.node());
+  CAF_CHECK_EQUAL(envelope.source_id, self->id());
+  CAF_CHECK_EQUAL(envelope.dest_id, 42u);
+  CAF_CHECK(!envelope.has_stages);
+  message content;
+  CAF_REQUIRE(source.apply(content));
+  CAF_CHECK_EQUAL(source.remaining(), 0u);
+  CAF_CHECK_EQUAL(to_string(content), R"_(message("hello world!"))_");
+}
+
 CAF_TEST(resolve request without result) {
   handle_handshake();
   consume_handshake();
@@ -325,4 +544,88 @@ CAF_TEST(heartbeat message) {
   CAF_CHECK_EQUAL(app.state(), basp::connection_state::await_header);
 }
 
+CAF_TEST(down batch) {
+  handle_handshake({to_string(basp::application::control_batches_feature)});
+  consume_handshake();
+  CAF_REQUIRE(app.control_batches());
+  auto p1 = proxies.get_or_put(mars, 42);
+  auto p2 = proxies.get_or_put(mars, 43);
+  CAF_CHECK_EQUAL(proxies.count_proxies(mars), 2u);
+  std::vector<std::pair<actor_id, error>> downs;
+  downs.emplace_back(42, exit_reason::normal);
+  downs.emplace_back(43, exit_reason::kill);
+  MOCK(basp::message_type::down_batch, 2u, downs);
+  CAF_CHECK_EQUAL(proxies.count_proxies(mars), 0u);
+}
+
+CAF_TEST(monitor batch for unknown actors) {
+  handle_handshake({to_string(basp::application::control_batches_feature)});
+  consume_handshake();
+  std::vector<actor_id> ids{42, 43};
+  MOCK(basp::message_type::monitor_batch, 2u, ids);
+  for (auto id : ids) {
+    if (output.size() < basp::header_size)
+      CAF_FAIL("expected a down message for actor " << id);
+    auto hdr = basp::header::from_bytes(output);
+    CAF_CHECK_EQUAL(hdr.type, basp::message_type::down_message);
+    CAF_CHECK_EQUAL(hdr.operation_data, static_cast<uint64_t>(id));
+    output.erase(output.begin(),
+                 output.begin() + basp::header_size + hdr.payload_len);
+  }
+  CAF_CHECK(output.empty());
+}
+
+CAF_TEST(heartbeats on idle connections) {
+  handle_handshake();
+  consume_handshake();
+  auto tick = [this] {
+    app.timeout(*this, to_string(basp::application::heartbeat_tag), 0);
+  };
+  tick();
+  CAF_REQUIRE_EQUAL(output.size(), basp::header_size);
+  CAF_CHECK_EQUAL(basp::header::from_bytes(output).type,
+                  basp::message_type::heartbeat);
+  output.clear();
+  CAF_MESSAGE("the application sends no heartbeat after regular messages");
+  app.resolve(*this, "foo/bar", self);
+  output.clear();
+  tick();
+  CAF_CHECK(output.empty());
+}
+
+CAF_TEST(connection timeout) {
+  handle_handshake();
+  consume_handshake();
+  auto proxy = proxies.get_or_put(mars, 42);
+  CAF_CHECK_EQUAL(proxies.count_proxies(mars), 1u);
+  auto tick = [this] {
+    app.timeout(*this, to_string(basp::application::heartbeat_tag), 0);
+  };
+  // The handshake counts as inbound traffic during the first interval.
+  auto max_idle_ticks = connection_timeout / heartbeat_interval;
+  for (auto i = 0; i < max_idle_ticks; ++i)
+    tick();
+  CAF_CHECK_EQUAL(proxies.count_proxies(mars), 1u);
+  CAF_MESSAGE("the application drops all proxies after the timeout");
+  tick();
+  CAF_CHECK_EQUAL(proxies.count_proxies(mars), 0u);
+}
+
+CAF_TEST(paused connections do not time out) {
+  handle_handshake();
+  consume_handshake();
+  auto proxy = proxies.get_or_put(mars, 42);
+  auto fc = app.inbound_flow_control();
+  CAF_REQUIRE(fc != nullptr);
+  for (size_t i = 0; i < fc->high_watermark(); ++i)
+    fc->delivered();
+  CAF_REQUIRE(fc->pause());
+  // We do not read from the socket while paused, i.e., a silent peer is not
+  // necessarily dead.
+  auto max_idle_ticks = connection_timeout / heartbeat_interval;
+  for (auto i = 0; i < 2 * max_idle_ticks; ++i)
+    app.timeout(*this, to_string(basp::application::heartbeat_tag), 0);
+  CAF_CHECK_EQUAL(proxies.count_proxies(mars), 1u);
+}
+
 CAF_TEST_FIXTURE_SCOPE_END()
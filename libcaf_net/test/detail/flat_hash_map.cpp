@@ -0,0 +1,87 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#define CAF_SUITE detail.flat_hash_map
+
+#include "caf/detail/flat_hash_map.hpp"
+
+#include "caf/test/dsl.hpp"
+
+#include <map>
+#include <random>
+
+using namespace caf;
+
+namespace {
+
+using map_type = detail::flat_hash_map<uint64_t, int>;
+
+/// Maps all keys to the same slot to test collision handling.
+struct constant_hash {
+  size_t operator()(uint64_t) const noexcept {
+    return 0;
+  }
+};
+
+} // namespace
+
+CAF_TEST(maps store and find values) {
+  map_type uut;
+  CAF_CHECK(uut.empty());
+  CAF_CHECK(uut.find(1) == nullptr);
+  CAF_CHECK(uut.emplace(1, 10).second);
+  CAF_CHECK(uut.emplace(2, 20).second);
+  CAF_CHECK(!uut.emplace(1, 11).second);
+  CAF_CHECK_EQUAL(uut.size(), 2u);
+  CAF_CHECK_EQUAL(*uut.find(1), 10);
+  CAF_CHECK_EQUAL(*uut.find(2), 20);
+  CAF_CHECK(!uut.contains(3));
+}
+
+CAF_TEST(maps grow while keeping their entries) {
+  map_type uut;
+  for (uint64_t i = 0; i < 1000; ++i)
+    uut.emplace(i, static_cast<int>(i));
+  CAF_CHECK_EQUAL(uut.size(), 1000u);
+  CAF_CHECK_GREATER(uut.capacity() * 3, uut.size() * 4);
+  for (uint64_t i = 0; i < 1000; ++i)
+    if (auto ptr = uut.find(i); ptr == nullptr || *ptr != static_cast<int>(i))
+      CAF_FAIL("lost entry " << i);
+}
+
+CAF_TEST(erasing entries keeps colliding keys reachable) {
+  detail::flat_hash_map<uint64_t, int, constant_hash> uut;
+  for (uint64_t i = 0; i < 8; ++i)
+    uut.emplace(i, static_cast<int>(i));
+  CAF_CHECK(uut.erase(3));
+  CAF_CHECK(!uut.erase(3));
+  CAF_CHECK(uut.erase(0));
+  CAF_CHECK_EQUAL(uut.size(), 6u);
+  for (uint64_t i : {1, 2, 4, 5, 6, 7})
+    CAF_CHECK_EQUAL(*uut.find(i), static_cast<int>(i));
+  CAF_CHECK(uut.find(0) == nullptr);
+  CAF_CHECK(uut.find(3) == nullptr);
+}
+
+CAF_TEST(maps behave like std::map under random operations) {
+  map_type uut;
+  std::map<uint64_t, int> ref;
+  std::minstd_rand rng{42};
+  for (int i = 0; i < 10'000; ++i) {
+    auto key = static_cast<uint64_t>(rng() % 256);
+    if (rng() % 3 == 0) {
+      CAF_CHECK_EQUAL(uut.erase(key), ref.erase(key) == 1);
+    } else {
+      auto inserted = ref.emplace(key, i).second;
+      CAF_CHECK_EQUAL(uut.emplace(key, i).second, inserted);
+    }
+  }
+  CAF_CHECK_EQUAL(uut.size(), ref.size());
+  for (auto& [key, val] : ref)
+    if (auto ptr = uut.find(key); ptr == nullptr || *ptr != val)
+      CAF_FAIL("mismatch for key " << key);
+  size_t visited = 0;
+  uut.for_each([&](uint64_t, int) { ++visited; });
+  CAF_CHECK_EQUAL(visited, ref.size());
+}
@@ -0,0 +1,130 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#define CAF_SUITE detail.lz4
+
+#include "caf/detail/lz4.hpp"
+
+#include "caf/test/dsl.hpp"
+
+#include "caf/byte.hpp"
+#include "caf/span.hpp"
+#include "caf/string_view.hpp"
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+using namespace caf;
+
+namespace {
+
+struct fixture {
+  using impl = detail::lz4;
+
+  std::vector<byte> bytes(string_view str) {
+    auto xs = as_bytes(make_span(str));
+    return {xs.begin(), xs.end()};
+  }
+
+  std::vector<byte> bytes(std::initializer_list<uint8_t> xs) {
+    std::vector<byte> result;
+    for (auto x : xs)
+      result.emplace_back(static_cast<byte>(x));
+    return result;
+  }
+
+  std::vector<byte> repeat(string_view str, size_t n) {
+    std::vector<byte> result;
+    for (size_t i = 0; i < n; ++i) {
+      auto xs = as_bytes(make_span(str));
+      result.insert(result.end(), xs.begin(), xs.end());
+    }
+    return result;
+  }
+
+  // Compresses `input` and checks whether decompressing restores `input`.
+  // Returns the size of the compressed block.
+  size_t roundtrip(const std::vector<byte>& dict,
+                   const std::vector<byte>& input) {
+    std::vector<byte> block;
+    impl::compress(dict, input, block);
+    std::vector<byte> output;
+    CAF_CHECK(impl::decompress(dict, block, input.size(), output));
+    CAF_CHECK_EQUAL(output, input);
+    return block.size();
+  }
+};
+
+} // namespace
+
+CAF_TEST_FIXTURE_SCOPE(lz4_tests, fixture)
+
+CAF_TEST(inputs without repetitions result in literals only) {
+  CAF_CHECK_EQUAL(roundtrip({}, {}), 1u);
+  CAF_CHECK_EQUAL(roundtrip({}, bytes("abc")), 4u);
+  std::vector<byte> block;
+  impl::compress({}, bytes("abc"), block);
+  CAF_CHECK_EQUAL(block, bytes({0x30, 'a', 'b', 'c'}));
+}
+
+CAF_TEST(repetitive inputs shrink) {
+  auto input = repeat("hello world! ", 100);
+  CAF_CHECK_LESS(roundtrip({}, input), input.size() / 10);
+  std::vector<byte> zeros(100000, byte{0});
+  CAF_CHECK_LESS(roundtrip({}, zeros), zeros.size() / 100);
+}
+
+CAF_TEST(matches may refer to the dictionary) {
+  auto input = bytes("caf::net::basp::message_type::actor_message from mars");
+  auto without_dict = roundtrip({}, input);
+  auto with_dict = roundtrip(input, input);
+  CAF_CHECK_LESS(with_dict, without_dict / 4);
+}
+
+CAF_TEST(decompressing requires the same dictionary) {
+  auto dict = repeat("hello world! ", 10);
+  auto input = bytes("hello world! hello world! hello world!");
+  std::vector<byte> block;
+  impl::compress(dict, input, block);
+  std::vector<byte> output;
+  CAF_CHECK(!impl::decompress({}, block, input.size(), output));
+}
+
+CAF_TEST(decompressing rejects malformed blocks) {
+  std::vector<byte> output;
+  CAF_MESSAGE("literals exceed the input");
+  CAF_CHECK(!impl::decompress({}, bytes({0x50, 'a'}), 5, output));
+  CAF_MESSAGE("offset of zero");
+  output.clear();
+  CAF_CHECK(!impl::decompress({}, bytes({0x10, 'a', 0, 0}), 5, output));
+  CAF_MESSAGE("offset exceeds the produced output");
+  output.clear();
+  CAF_CHECK(!impl::decompress({}, bytes({0x10, 'a', 2, 0}), 5, output));
+  CAF_MESSAGE("output exceeds the expected size");
+  output.clear();
+  CAF_CHECK(!impl::decompress({}, bytes({0x10, 'a', 1, 0}), 4, output));
+  CAF_MESSAGE("output falls short of the expected size");
+  output.clear();
+  CAF_CHECK(!impl::decompress({}, bytes({0x10, 'a', 1, 0}), 6, output));
+  CAF_MESSAGE("valid block");
+  output.clear();
+  CAF_CHECK(impl::decompress({}, bytes({0x10, 'a', 1, 0}), 5, output));
+  CAF_CHECK_EQUAL(output, bytes("aaaaa"));
+}
+
+CAF_TEST(decompressing rejects sizes beyond the maximum ratio) {
+  CAF_MESSAGE("highly repetitive input stays within the bound");
+  std::vector<byte> zeros(1024 * 1024);
+  auto block_size = roundtrip({}, zeros);
+  CAF_CHECK_LESS_OR_EQUAL(zeros.size(), impl::decompress_bound(block_size));
+  CAF_MESSAGE("a few Bytes cannot claim a huge output");
+  std::vector<byte> output;
+  auto block = bytes({0x1F, 'a', 1, 0, 255, 255, 255, 255, 255, 0});
+  CAF_CHECK(!impl::decompress({}, block, INT32_MAX, output));
+  CAF_CHECK_EQUAL(output.capacity(), 0u);
+}
+
+CAF_TEST_FIXTURE_SCOPE_END()
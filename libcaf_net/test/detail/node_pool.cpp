@@ -0,0 +1,67 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#define CAF_SUITE detail.node_pool
+
+#include "caf/detail/node_pool.hpp"
+
+#include "caf/test/dsl.hpp"
+
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace caf;
+
+namespace {
+
+using pool = detail::node_pool<48>;
+
+/// Releases its block when the thread exits.
+struct block_holder {
+  void* ptr = nullptr;
+
+  ~block_holder() {
+    if (ptr != nullptr)
+      pool::deallocate(ptr);
+  }
+};
+
+} // namespace
+
+CAF_TEST(the pool reuses blocks released by the same thread) {
+  auto ptr = pool::allocate();
+  pool::deallocate(ptr);
+  CAF_CHECK_EQUAL(pool::allocate(), ptr);
+  pool::deallocate(ptr);
+}
+
+CAF_TEST(the pool passes released blocks on to other threads) {
+  std::vector<void*> blocks;
+  for (size_t i = 0; i < pool::batch_size; ++i)
+    blocks.emplace_back(pool::allocate());
+  std::set<void*> released{blocks.begin(), blocks.end()};
+  // Release a full batch on another thread, which moves it to the stash.
+  std::thread{[&] {
+    for (auto ptr : blocks)
+      pool::deallocate(ptr);
+  }}.join();
+  // This thread has no released blocks left and takes the batch instead.
+  for (size_t i = 0; i < pool::batch_size; ++i) {
+    auto ptr = pool::allocate();
+    CAF_CHECK(released.count(ptr) == 1);
+    blocks[i] = ptr;
+  }
+  for (auto ptr : blocks)
+    pool::deallocate(ptr);
+}
+
+CAF_TEST(thread-local objects may release blocks after the cache is gone) {
+  std::thread{[] {
+    // Constructing the holder before the cache destroys it after the cache.
+    static thread_local block_holder holder;
+    holder.ptr = pool::allocate();
+    pool::deallocate(pool::allocate());
+  }}.join();
+}
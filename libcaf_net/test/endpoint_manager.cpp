@@ -16,6 +16,7 @@
 #include "caf/make_actor.hpp"
 #include "caf/net/actor_proxy_impl.hpp"
 #include "caf/net/make_endpoint_manager.hpp"
+#include "caf/net/endpoint_manager_queue.hpp"
 #include "caf/net/multiplexer.hpp"
 #include "caf/net/stream_socket.hpp"
 #include "caf/node_id.hpp"
@@ -32,8 +33,21 @@ string_view hello_manager{"hello manager!"};
 
 string_view hello_test{"hello test!"};
 
-struct fixture : test_coordinator_fixture<>, host_fixture {
-  fixture() {
+struct config : actor_system_config {
+  config() {
+    set("caf.middleman.max-queued-messages", 2);
+  }
+};
+
+struct drop_oldest_config : config {
+  drop_oldest_config() {
+    set("caf.middleman.overflow-strategy", "drop_oldest");
+  }
+};
+
+template <class Config>
+struct basic_fixture : test_coordinator_fixture<Config>, host_fixture {
+  basic_fixture() {
     mpx = std::make_shared<multiplexer>();
     mpx->set_thread_id();
     if (auto err = mpx->init())
@@ -49,6 +63,10 @@ struct fixture : test_coordinator_fixture<>, host_fixture {
   multiplexer_ptr mpx;
 };
 
+using fixture = basic_fixture<config>;
+
+using drop_oldest_fixture = basic_fixture<drop_oldest_config>;
+
 class dummy_application {
   // nop
 };
@@ -212,4 +230,84 @@ CAF_TEST(resolve and proxy communication) {
     CAF_ERROR("expected a string, got: " << to_string(msg));
 }
 
+CAF_TEST(the manager rejects messages that exceed the queue capacity) {
+  auto buf = std::make_shared<byte_buffer>();
+  auto sockets = unbox(make_stream_socket_pair());
+  auto guard = detail::make_scope_guard([&] { close(sockets.second); });
+  auto mgr = make_endpoint_manager(mpx, sys,
+                                   dummy_transport{sockets.first, buf});
+  auto send = [&](int value) {
+    mgr->enqueue(make_mailbox_element(nullptr, make_message_id(), {},
+                                      make_message(value)),
+                 self->ctrl());
+  };
+  send(1);
+  send(2);
+  CAF_CHECK_EQUAL(mgr->queued_messages(), 2u);
+  send(3);
+  CAF_CHECK_EQUAL(mgr->queued_messages(), 2u);
+  auto first = mgr->next_message();
+  CAF_REQUIRE(first != nullptr);
+  CAF_CHECK_EQUAL(first->msg->content().get_as<int>(0), 1);
+  CAF_CHECK_EQUAL(mgr->queued_messages(), 1u);
+}
+
+CAF_TEST(urgent messages overtake regular messages) {
+  auto buf = std::make_shared<byte_buffer>();
+  auto sockets = unbox(make_stream_socket_pair());
+  auto guard = detail::make_scope_guard([&] { close(sockets.second); });
+  auto mgr = make_endpoint_manager(mpx, sys,
+                                   dummy_transport{sockets.first, buf});
+  auto send = [&](int value, message_priority prio) {
+    mgr->enqueue(make_mailbox_element(nullptr, make_message_id(prio), {},
+                                      make_message(value)),
+                 self->ctrl());
+  };
+  send(1, message_priority::normal);
+  send(2, message_priority::high);
+  auto next_value = [&] {
+    auto ptr = mgr->next_message();
+    if (ptr == nullptr)
+      CAF_FAIL("expected another message");
+    return ptr->msg->content().get_as<int>(0);
+  };
+  CAF_CHECK_EQUAL(next_value(), 2);
+  CAF_CHECK_EQUAL(next_value(), 1);
+}
+
+CAF_TEST(size hints cover the content of variable-length types) {
+  auto hint = [&](message content) {
+    endpoint_manager_queue::message x{
+      make_mailbox_element(nullptr, make_message_id(), {}, std::move(content)),
+      self->ctrl()};
+    return x.size_hint;
+  };
+  CAF_CHECK_GREATER_OR_EQUAL(hint(make_message(std::string(1000, 'a'))),
+                             1000u);
+  auto nested = make_message(std::string(1000, 'a'));
+  CAF_CHECK_GREATER_OR_EQUAL(hint(make_message(nested)), 1000u);
+  CAF_CHECK_LESS(hint(make_message(42)), 100u);
+}
+
+CAF_TEST_FIXTURE_SCOPE_END()
+
+CAF_TEST_FIXTURE_SCOPE(drop_oldest_tests, drop_oldest_fixture)
+
+CAF_TEST(drop_oldest caps the queue at twice its capacity) {
+  auto buf = std::make_shared<byte_buffer>();
+  auto sockets = unbox(make_stream_socket_pair());
+  auto guard = detail::make_scope_guard([&] { close(sockets.second); });
+  auto mgr = make_endpoint_manager(mpx, sys,
+                                   dummy_transport{sockets.first, buf});
+  for (int value = 1; value <= 10; ++value)
+    mgr->enqueue(make_mailbox_element(nullptr, make_message_id(), {},
+                                      make_message(value)),
+                 self->ctrl());
+  CAF_CHECK_EQUAL(mgr->queued_messages(), 4u);
+  auto next = mgr->next_message();
+  CAF_REQUIRE(next != nullptr);
+  CAF_CHECK_EQUAL(next->msg->content().get_as<int>(0), 2);
+  CAF_CHECK_EQUAL(mgr->queued_messages(), 2u);
+}
+
 CAF_TEST_FIXTURE_SCOPE_END()
@@ -165,6 +165,46 @@ CAF_TEST(send and receive) {
   mpx.shutdown();
 }
 
+CAF_TEST(dispatch reaches only managed sockets) {
+  CAF_REQUIRE_EQUAL(mpx.init(), none);
+  auto sockets = unbox(make_stream_socket_pair());
+  size_t calls = 0;
+  auto f = [&calls](socket_manager&) { ++calls; };
+  { // Lifetime scope of alice.
+    auto alice = make_counted<dummy_manager>(manager_count, sockets.first,
+                                             &mpx);
+    alice->register_reading();
+    mpx.dispatch(sockets.first, f);
+    mpx.dispatch(sockets.second, f);
+    exhaust();
+    CAF_CHECK_EQUAL(calls, 1u);
+  }
+  close(sockets.second);
+  mpx.shutdown();
+}
+
+CAF_TEST(event targets reach their manager only while it exists) {
+  CAF_REQUIRE_EQUAL(mpx.init(), none);
+  auto sockets = unbox(make_stream_socket_pair());
+  size_t calls = 0;
+  auto f = [&calls](socket_manager&) { ++calls; };
+  auto alice = make_counted<dummy_manager>(manager_count, sockets.first, &mpx);
+  alice->register_reading();
+  auto target = alice->make_event_target();
+  CAF_CHECK_EQUAL(alice->make_event_target(), target);
+  socket_manager::post(target, f);
+  exhaust();
+  CAF_CHECK_EQUAL(calls, 1u);
+  // Alice reads EOF and leaves the multiplexer.
+  close(sockets.second);
+  exhaust();
+  CAF_CHECK_EQUAL(mpx.num_socket_managers(), 1u);
+  socket_manager::post(target, f);
+  exhaust();
+  CAF_CHECK_EQUAL(calls, 1u);
+  mpx.shutdown();
+}
+
 CAF_TEST(shutdown) {
   std::mutex m;
   std::condition_variable cv;
@@ -9,6 +9,8 @@
 #include "caf/net/test/host_fixture.hpp"
 #include "caf/test/dsl.hpp"
 
+#include <chrono>
+#include <future>
 #include <string>
 #include <thread>
 
@@ -134,13 +136,33 @@ CAF_TEST(connect) {
   auto port = unbox(local_port(acc_guard.socket()));
   auto uri_str = std::string("tcp://localhost:") + std::to_string(port);
   CAF_MESSAGE("connecting to " << CAF_ARG(uri_str));
-  CAF_CHECK(earth.mm.connect(*make_uri(uri_str)));
+  // Connecting blocks the caller until the multiplexer established the
+  // connection. Hence, we drive the multiplexer from this thread.
+  auto res = std::async(std::launch::async, [&] {
+    return earth.mm.connect(*make_uri(uri_str));
+  });
+  while (res.wait_for(std::chrono::milliseconds(1))
+         != std::future_status::ready)
+    handle_io_event();
+  CAF_CHECK(res.get());
   auto sock = unbox(accept(acc_guard.socket()));
   auto sock_guard = make_socket_guard(sock);
   handle_io_event();
   CAF_CHECK_EQUAL(earth.mpx->num_socket_managers(), 3);
 }
 
+CAF_TEST(the backend keeps the first connection to a peer) {
+  auto sockets = unbox(make_stream_socket_pair());
+  auto earth_be = reinterpret_cast<net::backend::tcp*>(earth.mm.backend("tcp"));
+  auto first = earth_be->emplace(mars.id(), sockets.first);
+  CAF_REQUIRE(first);
+  auto more_sockets = unbox(make_stream_socket_pair());
+  auto guard = make_socket_guard(more_sockets.second);
+  CAF_CHECK(!earth_be->emplace(mars.id(), more_sockets.first));
+  CAF_CHECK_EQUAL(earth_be->peer(mars.id()), *first);
+  close(sockets.second);
+}
+
 CAF_TEST(publish) {
   auto dummy = earth.sys.spawn(dummy_actor);
   auto path = "dummy"s;
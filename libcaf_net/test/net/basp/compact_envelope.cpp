@@ -0,0 +1,128 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#define CAF_SUITE net.basp.compact_envelope
+
+#include "caf/net/basp/compact_envelope.hpp"
+
+#include "caf/test/dsl.hpp"
+
+#include <limits>
+#include <string>
+
+#include "caf/binary_deserializer.hpp"
+#include "caf/binary_serializer.hpp"
+#include "caf/byte_buffer.hpp"
+#include "caf/uri.hpp"
+
+using namespace caf;
+using namespace caf::net;
+
+namespace {
+
+struct fixture {
+  fixture() {
+    mars = make_node_id(unbox(make_uri("tcp://mars")));
+  }
+
+  size_t write(const node_id& src_node, actor_id src_id, actor_id dst_id,
+               bool has_stages = false) {
+    byte_buffer tmp;
+    binary_serializer sink{nullptr, tmp};
+    if (!basp::write_compact_envelope(sink, outgoing, src_node, src_id, dst_id,
+                                      has_stages))
+      CAF_FAIL("failed to write envelope: " << sink.get_error());
+    buf.insert(buf.end(), tmp.begin(), tmp.end());
+    return tmp.size();
+  }
+
+  basp::compact_envelope read() {
+    binary_deserializer source{nullptr, make_span(buf).subspan(offset)};
+    basp::compact_envelope result;
+    if (!basp::read_compact_envelope(source, incoming, result))
+      CAF_FAIL("failed to read envelope: " << source.get_error());
+    offset += result.size;
+    return result;
+  }
+
+  node_id mars;
+  basp::node_table outgoing;
+  basp::node_table incoming;
+  byte_buffer buf;
+  size_t offset = 0;
+};
+
+} // namespace
+
+CAF_TEST_FIXTURE_SCOPE(compact_envelope_tests, fixture)
+
+CAF_TEST(varints use one Byte per seven bits) {
+  std::vector<uint64_t> inputs{0, 1, 127, 128, 16383, 16384,
+                               std::numeric_limits<uint64_t>::max()};
+  std::vector<size_t> sizes{1, 1, 1, 2, 2, 3, 10};
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    byte_buffer tmp;
+    binary_serializer sink{nullptr, tmp};
+    CAF_CHECK(basp::write_varint(sink, inputs[i]));
+    CAF_CHECK_EQUAL(tmp.size(), sizes[i]);
+    binary_deserializer source{nullptr, tmp};
+    uint64_t x = 0;
+    CAF_CHECK(basp::read_varint(source, x));
+    CAF_CHECK_EQUAL(x, inputs[i]);
+    CAF_CHECK_EQUAL(source.remaining(), 0u);
+  }
+}
+
+CAF_TEST(the first envelope from a node contains a node literal) {
+  auto literal_size = write(mars, 42, 7);
+  auto compact_size = write(mars, 42, 7);
+  CAF_CHECK_EQUAL(compact_size, 4u);
+  CAF_CHECK(compact_size < literal_size);
+  for (int i = 0; i < 2; ++i) {
+    auto x = read();
+    CAF_CHECK_EQUAL(x.source_node, mars);
+    CAF_CHECK_EQUAL(x.source_id, 42u);
+    CAF_CHECK_EQUAL(x.dest_id, 7u);
+    CAF_CHECK(!x.has_stages);
+  }
+  CAF_CHECK_EQUAL(offset, buf.size());
+}
+
+CAF_TEST(anonymous messages omit the sender) {
+  CAF_CHECK_EQUAL(write(node_id{}, 0, 7, true), 2u);
+  auto x = read();
+  CAF_CHECK_EQUAL(x.source_node, node_id{});
+  CAF_CHECK_EQUAL(x.source_id, 0u);
+  CAF_CHECK_EQUAL(x.dest_id, 7u);
+  CAF_CHECK(x.has_stages);
+}
+
+CAF_TEST(both sides evict node IDs in the same order) {
+  write(mars, 1, 1);
+  CAF_CHECK_EQUAL(outgoing.find(mars), 0u);
+  for (size_t i = 0; i < basp::node_table::max_size; ++i) {
+    auto str = "tcp://node-" + std::to_string(i);
+    write(make_node_id(unbox(make_uri(str))), 1, 1);
+  }
+  CAF_CHECK_EQUAL(outgoing.find(mars), basp::node_table::max_size);
+  write(mars, 1, 1);
+  CAF_CHECK_EQUAL(outgoing.find(mars), 1u);
+  for (size_t i = 0; i < basp::node_table::max_size + 2; ++i)
+    read();
+  CAF_CHECK_EQUAL(offset, buf.size());
+  CAF_CHECK_EQUAL(incoming.find(mars), 1u);
+}
+
+CAF_TEST(unknown slots are an error) {
+  basp::node_table other;
+  write(mars, 42, 7);
+  write(mars, 42, 7);
+  binary_deserializer source{nullptr, buf};
+  basp::compact_envelope x;
+  CAF_CHECK(basp::read_compact_envelope(source, other, x));
+  basp::node_table empty;
+  CAF_CHECK(!basp::read_compact_envelope(source, empty, x));
+}
+
+CAF_TEST_FIXTURE_SCOPE_END()
@@ -0,0 +1,131 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#define CAF_SUITE net.basp.content_cache
+
+#include "caf/net/basp/content_cache.hpp"
+
+#include "caf/test/dsl.hpp"
+
+#include <string>
+
+#include "caf/binary_serializer.hpp"
+#include "caf/byte_buffer.hpp"
+#include "caf/message.hpp"
+
+using namespace caf;
+using namespace caf::net;
+
+namespace {
+
+struct fixture : test_coordinator_fixture<> {
+  byte_buffer serialize(const message& msg) {
+    byte_buffer result;
+    binary_serializer sink{sys, result};
+    if (!sink.apply(msg))
+      CAF_FAIL("failed to serialize message: " << sink.get_error());
+    return result;
+  }
+
+  byte_buffer serialize_with_cache(const message& msg) {
+    byte_buffer result;
+    if (auto err = cache.serialize(sys, msg, result))
+      CAF_FAIL("failed to serialize message: " << err);
+    return result;
+  }
+
+  basp::content_cache cache{4, 1};
+};
+
+} // namespace
+
+CAF_TEST_FIXTURE_SCOPE(content_cache_tests, fixture)
+
+CAF_TEST(the cache ignores messages without copies) {
+  auto msg = make_message(std::string{"hello world"}, 42);
+  auto expected = serialize(msg);
+  CAF_CHECK_EQUAL(serialize_with_cache(msg), expected);
+  CAF_CHECK_EQUAL(cache.size(), 0u);
+}
+
+CAF_TEST(the cache stores the content of shared messages once) {
+  auto msg = make_message(std::string{"hello world"}, 42);
+  auto copy = msg;
+  auto expected = serialize(msg);
+  CAF_CHECK_EQUAL(serialize_with_cache(msg), expected);
+  CAF_CHECK_EQUAL(serialize_with_cache(copy), expected);
+  CAF_CHECK_EQUAL(cache.size(), 1u);
+}
+
+CAF_TEST(the cache appends to existing buffers) {
+  auto msg = make_message(std::string{"hello world"}, 42);
+  auto copy = msg;
+  byte_buffer buf{byte{1}, byte{2}, byte{3}};
+  CAF_CHECK_EQUAL(cache.serialize(sys, msg, buf), none);
+  auto expected = byte_buffer{byte{1}, byte{2}, byte{3}};
+  auto content = serialize(msg);
+  expected.insert(expected.end(), content.begin(), content.end());
+  CAF_CHECK_EQUAL(buf, expected);
+}
+
+CAF_TEST(the cache drops messages once all other copies are gone) {
+  {
+    auto msg = make_message(std::string{"hello world"});
+    auto copy = msg;
+    serialize_with_cache(msg);
+    CAF_CHECK_EQUAL(cache.size(), 1u);
+  }
+  auto msg = make_message(std::string{"hello again"});
+  auto copy = msg;
+  serialize_with_cache(msg);
+  CAF_CHECK_EQUAL(cache.size(), 1u);
+}
+
+CAF_TEST(the cache evicts the oldest entry when full) {
+  std::vector<message> messages;
+  for (int i = 0; i < 5; ++i)
+    messages.emplace_back(make_message(i));
+  for (auto& msg : messages) {
+    auto copy = msg;
+    serialize_with_cache(copy);
+  }
+  CAF_CHECK_EQUAL(cache.size(), 4u);
+}
+
+CAF_TEST(the cache drops expired entries on lookups) {
+  auto msg = make_message(std::string{"hello world"});
+  auto copy = msg;
+  {
+    auto tmp = make_message(std::string{"hello again"});
+    auto tmp_copy = tmp;
+    serialize_with_cache(tmp);
+    serialize_with_cache(msg);
+    CAF_CHECK_EQUAL(cache.size(), 2u);
+  }
+  CAF_MESSAGE("a cache hit drops the expired entry");
+  serialize_with_cache(msg);
+  CAF_CHECK_EQUAL(cache.size(), 1u);
+}
+
+CAF_TEST(sharded caches serve messages from all shards) {
+  basp::content_cache sharded{64, 8};
+  std::vector<message> messages;
+  std::vector<byte_buffer> expected;
+  for (int i = 0; i < 32; ++i) {
+    messages.emplace_back(make_message(i));
+    expected.emplace_back(serialize(messages.back()));
+  }
+  std::vector<message> copies = messages;
+  for (int round = 0; round < 2; ++round) {
+    for (size_t i = 0; i < messages.size(); ++i) {
+      byte_buffer buf;
+      CAF_CHECK_EQUAL(sharded.serialize(sys, messages[i], buf), none);
+      CAF_CHECK_EQUAL(buf, expected[i]);
+    }
+  }
+  CAF_CHECK_LESS_OR_EQUAL(sharded.size(), 32u);
+  CAF_CHECK_GREATER(sharded.size(), 0u);
+}
+
+CAF_TEST_FIXTURE_SCOPE_END()
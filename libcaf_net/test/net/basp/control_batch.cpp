@@ -0,0 +1,146 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#define CAF_SUITE net.basp.control_batch
+
+#include "caf/net/basp/control_batch.hpp"
+
+#include "caf/test/dsl.hpp"
+
+#include <vector>
+
+#include "caf/binary_deserializer.hpp"
+#include "caf/byte_buffer.hpp"
+#include "caf/net/basp/constants.hpp"
+#include "caf/net/basp/ec.hpp"
+#include "caf/net/basp/message_type.hpp"
+#include "caf/net/packet_writer.hpp"
+#include "caf/span.hpp"
+
+using namespace caf;
+using namespace caf::net;
+
+namespace {
+
+struct packet {
+  basp::header hdr;
+  byte_buffer payload;
+};
+
+class collector : public packet_writer {
+public:
+  byte_buffer next_header_buffer() override {
+    return {};
+  }
+
+  byte_buffer next_payload_buffer() override {
+    return {};
+  }
+
+  std::vector<packet> packets;
+
+protected:
+  void write_impl(span<byte_buffer*> buffers) override {
+    CAF_REQUIRE(!buffers.empty());
+    auto& x = packets.emplace_back();
+    x.hdr = basp::header::from_bytes(*buffers[0]);
+    for (auto buf : buffers.subspan(1))
+      x.payload.insert(x.payload.end(), buf->begin(), buf->end());
+  }
+};
+
+struct fixture : test_coordinator_fixture<> {
+  basp::control_batch batch;
+
+  collector writer;
+};
+
+} // namespace
+
+CAF_TEST_FIXTURE_SCOPE(control_batch_tests, fixture)
+
+CAF_TEST(only the first pending message requires a flush) {
+  CAF_CHECK(batch.empty());
+  CAF_CHECK(batch.add_monitor(1));
+  CAF_CHECK(!batch.add_monitor(2));
+  CAF_CHECK(!batch.add_down(3, sec::runtime_error));
+  CAF_CHECK_EQUAL(batch.size(), 3u);
+  batch.flush(sys, writer, true);
+  CAF_CHECK(batch.empty());
+  CAF_CHECK(batch.add_down(4, sec::runtime_error));
+}
+
+CAF_TEST(flushing without batches writes one packet per message) {
+  batch.add_monitor(1);
+  batch.add_monitor(2);
+  batch.add_down(3, sec::runtime_error);
+  CAF_CHECK_EQUAL(batch.flush(sys, writer, false), 3u);
+  CAF_REQUIRE_EQUAL(writer.packets.size(), 3u);
+  CAF_CHECK_EQUAL(writer.packets[0].hdr.type,
+                  basp::message_type::monitor_message);
+  CAF_CHECK_EQUAL(writer.packets[0].hdr.operation_data, 1u);
+  CAF_CHECK_EQUAL(writer.packets[1].hdr.operation_data, 2u);
+  auto& down = writer.packets[2];
+  CAF_CHECK_EQUAL(down.hdr.type, basp::message_type::down_message);
+  CAF_CHECK_EQUAL(down.hdr.operation_data, 3u);
+  CAF_CHECK_EQUAL(down.hdr.payload_len, down.payload.size());
+  error reason;
+  binary_deserializer source{sys, down.payload};
+  CAF_CHECK(source.apply_objects(reason));
+  CAF_CHECK_EQUAL(reason, sec::runtime_error);
+}
+
+CAF_TEST(flushing with batches combines messages of the same kind) {
+  batch.add_monitor(1);
+  batch.add_monitor(2);
+  batch.add_down(3, sec::runtime_error);
+  batch.add_down(4, sec::request_timeout);
+  CAF_CHECK_EQUAL(batch.flush(sys, writer, true), 2u);
+  CAF_REQUIRE_EQUAL(writer.packets.size(), 2u);
+  auto& monitors = writer.packets[0];
+  CAF_CHECK_EQUAL(monitors.hdr.type, basp::message_type::monitor_batch);
+  std::vector<actor_id> ids;
+  CAF_CHECK_EQUAL(basp::control_batch::read_monitors(nullptr, monitors.hdr,
+                                                     monitors.payload, ids),
+                  none);
+  CAF_CHECK_EQUAL(ids, std::vector<actor_id>({1, 2}));
+  auto& downs = writer.packets[1];
+  CAF_CHECK_EQUAL(downs.hdr.type, basp::message_type::down_batch);
+  basp::control_batch::down_list xs;
+  CAF_CHECK_EQUAL(basp::control_batch::read_downs(nullptr, downs.hdr,
+                                                  downs.payload, xs),
+                  none);
+  CAF_REQUIRE_EQUAL(xs.size(), 2u);
+  CAF_CHECK_EQUAL(xs[0].first, 3u);
+  CAF_CHECK_EQUAL(xs[0].second, sec::runtime_error);
+  CAF_CHECK_EQUAL(xs[1].first, 4u);
+  CAF_CHECK_EQUAL(xs[1].second, sec::request_timeout);
+}
+
+CAF_TEST(single messages never use batches) {
+  batch.add_monitor(1);
+  batch.add_down(2, sec::runtime_error);
+  CAF_CHECK_EQUAL(batch.flush(sys, writer, true), 2u);
+  CAF_REQUIRE_EQUAL(writer.packets.size(), 2u);
+  CAF_CHECK_EQUAL(writer.packets[0].hdr.type,
+                  basp::message_type::monitor_message);
+  CAF_CHECK_EQUAL(writer.packets[1].hdr.type,
+                  basp::message_type::down_message);
+  CAF_CHECK_EQUAL(batch.flush(sys, writer, true), 0u);
+}
+
+CAF_TEST(decoding rejects batches with a wrong message count) {
+  batch.add_monitor(1);
+  batch.add_monitor(2);
+  batch.flush(sys, writer, true);
+  CAF_REQUIRE_EQUAL(writer.packets.size(), 1u);
+  auto hdr = writer.packets[0].hdr;
+  hdr.operation_data = 3;
+  std::vector<actor_id> ids;
+  CAF_CHECK_EQUAL(basp::control_batch::read_monitors(
+                    nullptr, hdr, writer.packets[0].payload, ids),
+                  basp::ec::invalid_payload);
+}
+
+CAF_TEST_FIXTURE_SCOPE_END()
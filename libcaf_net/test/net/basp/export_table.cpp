@@ -0,0 +1,74 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#define CAF_SUITE net.basp.export_table
+
+#include "caf/net/basp/export_table.hpp"
+
+#include "caf/test/dsl.hpp"
+
+#include <vector>
+
+#include "caf/actor_registry.hpp"
+
+using namespace caf;
+using namespace caf::net;
+
+namespace {
+
+behavior dummy_impl() {
+  return {
+    [](int) {
+      // nop
+    },
+  };
+}
+
+struct fixture : test_coordinator_fixture<> {
+  strong_actor_ptr spawn_dummy() {
+    auto hdl = sys.spawn(dummy_impl);
+    run();
+    return actor_cast<strong_actor_ptr>(hdl);
+  }
+
+  basp::export_table exports;
+};
+
+} // namespace
+
+CAF_TEST_FIXTURE_SCOPE(export_table_tests, fixture)
+
+CAF_TEST(the table puts each actor into the registry once) {
+  auto ptr = spawn_dummy();
+  CAF_CHECK_EQUAL(sys.registry().get(ptr->id()), nullptr);
+  CAF_CHECK(exports.add(sys.registry(), ptr));
+  CAF_CHECK(exports.contains(ptr->id()));
+  CAF_CHECK_EQUAL(sys.registry().get(ptr->id()), ptr);
+  sys.registry().erase(ptr->id());
+  CAF_CHECK(!exports.add(sys.registry(), ptr));
+  CAF_CHECK_EQUAL(sys.registry().get(ptr->id()), nullptr);
+  CAF_CHECK_EQUAL(exports.size(), 1u);
+}
+
+CAF_TEST(the table prunes entries of terminated actors) {
+  std::vector<strong_actor_ptr> dead;
+  for (size_t i = 0; i < basp::export_table::prune_threshold - 1; ++i) {
+    auto ptr = spawn_dummy();
+    exports.add(sys.registry(), ptr);
+    dead.emplace_back(std::move(ptr));
+  }
+  for (auto& ptr : dead) {
+    anon_send_exit(actor_cast<actor>(ptr), exit_reason::kill);
+    sys.registry().erase(ptr->id());
+  }
+  run();
+  dead.clear();
+  CAF_CHECK_EQUAL(exports.size(), basp::export_table::prune_threshold - 1);
+  auto alive = spawn_dummy();
+  exports.add(sys.registry(), alive);
+  CAF_CHECK_EQUAL(exports.size(), 1u);
+  CAF_CHECK(exports.contains(alive->id()));
+}
+
+CAF_TEST_FIXTURE_SCOPE_END()
@@ -0,0 +1,71 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#define CAF_SUITE net.basp.features
+
+#include "caf/net/basp/features.hpp"
+
+#include "caf/test/dsl.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace caf;
+using namespace caf::net;
+
+namespace {
+
+using string_list = std::vector<std::string>;
+
+basp::features all_features() {
+  basp::features result;
+  result.compact_envelopes = true;
+  result.message_batches = true;
+  result.control_batches = true;
+  result.compression = true;
+  return result;
+}
+
+} // namespace
+
+CAF_TEST(the handshake lists only enabled features) {
+  CAF_CHECK_EQUAL(basp::to_names(basp::features{}), string_list{});
+  basp::features xs;
+  xs.compact_envelopes = true;
+  xs.compression = true;
+  CAF_CHECK_EQUAL(basp::to_names(xs),
+                  string_list({"compact-envelopes", "lz4-compression"}));
+  CAF_CHECK_EQUAL(basp::to_names(all_features()),
+                  string_list({"compact-envelopes", "message-batches",
+                               "control-batches", "lz4-compression"}));
+}
+
+CAF_TEST(peers agree on features that both sides announce) {
+  auto local = all_features();
+  local.compression = false;
+  auto agreed = basp::negotiate(local, {"lz4-compression", "compact-envelopes",
+                                        "control-batches", "teleportation"});
+  CAF_CHECK(agreed.compact_envelopes);
+  CAF_CHECK(!agreed.message_batches);
+  CAF_CHECK(agreed.control_batches);
+  CAF_CHECK(!agreed.compression);
+  CAF_CHECK_EQUAL(basp::to_names(basp::negotiate(local, {})), string_list{});
+}
+
+CAF_TEST(peers may only send message types of agreed features) {
+  using basp::message_type;
+  basp::features nothing;
+  for (auto x : {message_type::actor_message, message_type::resolve_request,
+                 message_type::resolve_response, message_type::monitor_message,
+                 message_type::down_message, message_type::heartbeat})
+    CAF_CHECK(basp::permits(nothing, x));
+  for (auto x : {message_type::compact_actor_message,
+                 message_type::message_batch, message_type::monitor_batch,
+                 message_type::down_batch, message_type::compressed_message})
+    CAF_CHECK(!basp::permits(nothing, x));
+  auto agreed = basp::negotiate(all_features(), {"compact-envelopes"});
+  CAF_CHECK(basp::permits(agreed, message_type::compact_actor_message));
+  CAF_CHECK(!basp::permits(agreed, message_type::message_batch));
+  CAF_CHECK(!basp::permits(agreed, message_type::compressed_message));
+}
@@ -0,0 +1,127 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#define CAF_SUITE net.basp.flow_control
+
+#include "caf/net/basp/flow_control.hpp"
+
+#include "caf/test/dsl.hpp"
+
+#include <vector>
+
+#include "caf/mailbox_element.hpp"
+#include "caf/message.hpp"
+#include "caf/no_stages.hpp"
+
+using namespace caf;
+using namespace caf::net;
+
+namespace {
+
+struct fixture {
+  fixture() {
+    auto f = [this] { ++resumed; };
+    fc.reset(new basp::flow_control(
+               basp::flow_control::resume_callback{
+                 make_type_erased_callback(f)},
+               4, 2),
+             false);
+  }
+
+  void deliver(size_t num) {
+    for (size_t i = 0; i < num; ++i)
+      elements.emplace_back(fc->make_element(nullptr, make_message_id(),
+                                             no_stages, make_message(i)));
+  }
+
+  void process(size_t num) {
+    for (size_t i = 0; i < num; ++i)
+      elements.erase(elements.begin());
+  }
+
+  size_t resumed = 0;
+
+  basp::flow_control_ptr fc;
+
+  std::vector<mailbox_element_ptr> elements;
+};
+
+} // namespace
+
+CAF_TEST_FIXTURE_SCOPE(flow_control_tests, fixture)
+
+CAF_TEST(tracked elements count as pending until destroyed) {
+  deliver(3);
+  CAF_CHECK_EQUAL(fc->pending(), 3u);
+  process(2);
+  CAF_CHECK_EQUAL(fc->pending(), 1u);
+  process(1);
+  CAF_CHECK_EQUAL(fc->pending(), 0u);
+}
+
+CAF_TEST(the application pauses at the high watermark) {
+  deliver(3);
+  CAF_CHECK(!fc->pause());
+  CAF_CHECK(!fc->paused());
+  deliver(1);
+  CAF_CHECK(fc->pause());
+  CAF_CHECK(fc->paused());
+}
+
+CAF_TEST(the flow control resumes at the low watermark) {
+  deliver(5);
+  CAF_REQUIRE(fc->pause());
+  process(2);
+  CAF_CHECK(fc->paused());
+  process(1);
+  CAF_CHECK(!fc->paused());
+  CAF_CHECK_EQUAL(fc->pending(), 2u);
+}
+
+CAF_TEST(the flow control calls the resume callback once per pause) {
+  deliver(4);
+  CAF_REQUIRE(fc->pause());
+  process(2);
+  CAF_CHECK_EQUAL(resumed, 1u);
+  process(2);
+  CAF_CHECK_EQUAL(resumed, 1u);
+  CAF_MESSAGE("processing without pausing first never resumes");
+  deliver(4);
+  process(4);
+  CAF_CHECK_EQUAL(resumed, 1u);
+}
+
+CAF_TEST(detached flow controls no longer call the resume callback) {
+  deliver(4);
+  CAF_REQUIRE(fc->pause());
+  fc->detach();
+  process(4);
+  CAF_CHECK(!fc->paused());
+  CAF_CHECK_EQUAL(resumed, 0u);
+}
+
+CAF_TEST(flow controls without callback resume silently) {
+  basp::flow_control_ptr silent{new basp::flow_control(nullptr, 2, 1), false};
+  auto x = silent->make_element(nullptr, make_message_id(), no_stages,
+                                make_message(1));
+  auto y = silent->make_element(nullptr, make_message_id(), no_stages,
+                                make_message(2));
+  CAF_REQUIRE(silent->pause());
+  x.reset();
+  CAF_CHECK(!silent->paused());
+}
+
+CAF_TEST(untracked elements bypass the flow control) {
+  auto ptr = basp::make_tracked_mailbox_element(nullptr, nullptr,
+                                                make_message_id(), no_stages,
+                                                make_message(42));
+  CAF_CHECK(ptr != nullptr);
+  auto tracked = basp::make_tracked_mailbox_element(fc.get(), nullptr,
+                                                    make_message_id(),
+                                                    no_stages,
+                                                    make_message(42));
+  CAF_CHECK_EQUAL(fc->pending(), 1u);
+}
+
+CAF_TEST_FIXTURE_SCOPE_END()
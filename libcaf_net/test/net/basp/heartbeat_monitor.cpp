@@ -0,0 +1,60 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#define CAF_SUITE net.basp.heartbeat_monitor
+
+#include "caf/net/basp/heartbeat_monitor.hpp"
+
+#include "caf/test/dsl.hpp"
+
+using namespace caf;
+using namespace caf::net;
+using namespace std::literals::chrono_literals;
+
+namespace {
+
+using action = basp::heartbeat_monitor::action;
+
+} // namespace
+
+CAF_TEST(a zero interval disables heartbeats) {
+  basp::heartbeat_monitor disabled{timespan{0}, timespan{1s}};
+  CAF_CHECK(!disabled.enabled());
+  CAF_CHECK_EQUAL(disabled.max_idle_ticks(), 0u);
+  CAF_CHECK(!basp::heartbeat_monitor{}.enabled());
+}
+
+CAF_TEST(the connection timeout rounds up to full intervals) {
+  CAF_CHECK_EQUAL(basp::heartbeat_monitor(1s, 3s).max_idle_ticks(), 3u);
+  CAF_CHECK_EQUAL(basp::heartbeat_monitor(2s, 3s).max_idle_ticks(), 2u);
+  CAF_CHECK_EQUAL(basp::heartbeat_monitor(2s, 1s).max_idle_ticks(), 1u);
+  CAF_CHECK_EQUAL(basp::heartbeat_monitor(1s, timespan{0}).max_idle_ticks(),
+                  0u);
+}
+
+CAF_TEST(outbound traffic replaces heartbeats) {
+  basp::heartbeat_monitor hbm{1s, timespan{0}};
+  CAF_CHECK(hbm.tick(false) == action::send_heartbeat);
+  hbm.sent();
+  CAF_CHECK(hbm.tick(false) == action::none);
+  CAF_CHECK(hbm.tick(false) == action::send_heartbeat);
+}
+
+CAF_TEST(inbound traffic resets the connection timeout) {
+  basp::heartbeat_monitor hbm{1s, 3s};
+  CAF_CHECK(hbm.tick(false) != action::disconnect);
+  CAF_CHECK(hbm.tick(false) != action::disconnect);
+  hbm.received();
+  CAF_CHECK(hbm.tick(false) != action::disconnect);
+  CAF_CHECK(hbm.tick(false) != action::disconnect);
+  CAF_CHECK(hbm.tick(false) != action::disconnect);
+  CAF_CHECK(hbm.tick(false) == action::disconnect);
+}
+
+CAF_TEST(paused connections never time out) {
+  basp::heartbeat_monitor hbm{1s, 1s};
+  for (int i = 0; i < 5; ++i)
+    CAF_CHECK(hbm.tick(true) == action::send_heartbeat);
+  CAF_CHECK(hbm.tick(false) == action::disconnect);
+}
@@ -0,0 +1,105 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#define CAF_SUITE net.basp.message_batch
+
+#include "caf/net/basp/message_batch.hpp"
+
+#include "caf/test/dsl.hpp"
+
+#include <vector>
+
+#include "caf/byte_buffer.hpp"
+#include "caf/net/basp/constants.hpp"
+
+using namespace caf;
+using namespace caf::net;
+
+namespace {
+
+struct fixture {
+  /// Appends a message with `size` payload Bytes to `batch`.
+  void append(basp::batch_writer& batch, size_t size, uint64_t id) {
+    auto& buf = batch.begin(size);
+    buf.insert(buf.end(), size, static_cast<byte>(id));
+    batch.commit(basp::message_type::actor_message, id);
+  }
+
+  byte_buffer buf;
+
+  std::vector<basp::batched_message> messages;
+};
+
+} // namespace
+
+CAF_TEST_FIXTURE_SCOPE(message_batch_tests, fixture)
+
+CAF_TEST(batches prefix each message with its header) {
+  basp::batch_writer batch{buf, 10, 0};
+  append(batch, 3, 1);
+  append(batch, 0, 2);
+  append(batch, 5, 3);
+  CAF_CHECK_EQUAL(batch.size(), 3u);
+  CAF_CHECK_EQUAL(buf.size(), 3 * basp::header_size + 8);
+  CAF_REQUIRE(basp::read_batch(buf, 3, messages));
+  CAF_REQUIRE_EQUAL(messages.size(), 3u);
+  for (uint64_t id = 1; id <= 3; ++id) {
+    auto& x = messages[id - 1];
+    CAF_CHECK_EQUAL(x.hdr.type, basp::message_type::actor_message);
+    CAF_CHECK_EQUAL(x.hdr.operation_data, id);
+    CAF_CHECK_EQUAL(x.hdr.payload_len, x.payload.size());
+    for (auto b : x.payload)
+      CAF_CHECK_EQUAL(b, static_cast<byte>(id));
+  }
+}
+
+CAF_TEST(rolling back removes only the current message) {
+  basp::batch_writer batch{buf, 10, 0};
+  append(batch, 4, 1);
+  auto& tmp = batch.begin();
+  tmp.insert(tmp.end(), 100, byte{0});
+  batch.rollback();
+  append(batch, 2, 2);
+  CAF_CHECK_EQUAL(batch.size(), 2u);
+  CAF_REQUIRE(basp::read_batch(buf, 2, messages));
+  CAF_CHECK_EQUAL(messages[0].hdr.operation_data, 1u);
+  CAF_CHECK_EQUAL(messages[1].hdr.operation_data, 2u);
+}
+
+CAF_TEST(batches are full after reaching the message limit) {
+  basp::batch_writer batch{buf, 2, 0};
+  append(batch, 1000, 1);
+  CAF_CHECK(!batch.full());
+  append(batch, 1000, 2);
+  CAF_CHECK(batch.full());
+}
+
+CAF_TEST(batches are full after reaching the byte limit) {
+  basp::batch_writer batch{buf, 100, 80};
+  append(batch, 20, 1);
+  CAF_CHECK(!batch.full());
+  append(batch, 20, 2);
+  CAF_CHECK(!batch.full());
+  // The last message may exceed the limit, since we cannot know its size in
+  // advance.
+  append(batch, 20, 3);
+  CAF_CHECK(batch.full());
+  CAF_CHECK_EQUAL(batch.size(), 3u);
+}
+
+CAF_TEST(reading rejects malformed batches) {
+  basp::batch_writer batch{buf, 10, 0};
+  append(batch, 3, 1);
+  append(batch, 3, 2);
+  CAF_CHECK(!basp::read_batch(buf, 1, messages));
+  CAF_CHECK(!basp::read_batch(buf, 3, messages));
+  CAF_CHECK(!basp::read_batch(make_span(buf).subspan(0, buf.size() - 1), 2,
+                              messages));
+  auto tmp = buf;
+  tmp[0] = static_cast<byte>(basp::message_type::heartbeat);
+  CAF_CHECK(!basp::read_batch(tmp, 2, messages));
+  CAF_CHECK(basp::read_batch(buf, 2, messages));
+}
+
+CAF_TEST_FIXTURE_SCOPE_END()
@@ -0,0 +1,156 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#define CAF_SUITE net.basp.message_dispatcher
+
+#include "caf/net/basp/message_dispatcher.hpp"
+
+#include "caf/test/dsl.hpp"
+
+#include <string>
+#include <vector>
+
+#include "caf/actor_proxy.hpp"
+#include "caf/binary_deserializer.hpp"
+#include "caf/binary_serializer.hpp"
+#include "caf/byte_buffer.hpp"
+#include "caf/make_actor.hpp"
+#include "caf/proxy_registry.hpp"
+#include "caf/scoped_execution_unit.hpp"
+
+using namespace caf;
+using namespace caf::net;
+
+namespace {
+
+constexpr size_t threshold = 64;
+
+class dummy_proxy : public actor_proxy {
+public:
+  explicit dummy_proxy(actor_config& cfg) : actor_proxy(cfg) {
+    // nop
+  }
+
+  bool enqueue(mailbox_element_ptr, execution_unit*) override {
+    return false;
+  }
+
+  void kill_proxy(execution_unit* ctx, error rsn) override {
+    cleanup(std::move(rsn), ctx);
+  }
+};
+
+class dummy_backend : public proxy_registry::backend {
+public:
+  explicit dummy_backend(actor_system& sys) : sys_(sys) {
+    // nop
+  }
+
+  strong_actor_ptr make_proxy(node_id nid, actor_id aid) override {
+    actor_config cfg;
+    return make_actor<dummy_proxy, strong_actor_ptr>(aid, nid, &sys_, cfg);
+  }
+
+  void set_last_hop(node_id*) override {
+    // nop
+  }
+
+private:
+  actor_system& sys_;
+};
+
+struct fixture : test_coordinator_fixture<> {
+  fixture()
+    : backend(sys),
+      proxies(sys, backend),
+      ctx(&sys),
+      dispatcher(proxies, 1, threshold) {
+    ctx.proxy_registry_ptr(&proxies);
+    sys.registry().put(self->id(), self);
+  }
+
+  ~fixture() {
+    sys.registry().erase(self->id());
+  }
+
+  /// Serializes an anonymous actor message with `str` as content for `self`.
+  byte_buffer make_payload(const std::string& str) {
+    byte_buffer result;
+    binary_serializer sink{sys, result};
+    if (!sink.apply_objects(node_id{}, actor_id{0}, self->id(),
+                            std::vector<strong_actor_ptr>{},
+                            make_message(str)))
+      CAF_FAIL("failed to serialize payload: " << sink.get_error());
+    return result;
+  }
+
+  bool dispatch(const std::string& str) {
+    auto payload = make_payload(str);
+    basp::header hdr{basp::message_type::actor_message,
+                     static_cast<uint32_t>(payload.size()),
+                     make_message_id().integer_value()};
+    return dispatcher.dispatch(&ctx, hdr, payload);
+  }
+
+  dummy_backend backend;
+
+  proxy_registry proxies;
+
+  scoped_execution_unit ctx;
+
+  basp::message_dispatcher dispatcher;
+};
+
+} // namespace
+
+CAF_TEST_FIXTURE_SCOPE(message_dispatcher_tests, fixture)
+
+CAF_TEST(the I/O thread deserializes payloads up to the threshold) {
+  CAF_CHECK(dispatch("hello"));
+  CAF_CHECK_EQUAL(self->mailbox().size(), 1u);
+  expect((std::string), from(_).to(self).with("hello"));
+}
+
+CAF_TEST(workers deserialize payloads above the threshold) {
+  std::string large(threshold * 2, 'a');
+  CAF_CHECK(!dispatch(large));
+  CAF_CHECK_EQUAL(self->mailbox().size(), 0u);
+  sched.run();
+  expect((std::string), from(_).to(self).with(large));
+}
+
+CAF_TEST(large payloads fall back to the I/O thread if all workers are busy) {
+  std::string first(threshold * 2, 'a');
+  std::string second(threshold * 2, 'b');
+  CAF_CHECK(!dispatch(first));
+  CAF_CHECK(dispatch(second));
+  // The queue holds back the second message until the worker delivered the
+  // first one.
+  CAF_CHECK_EQUAL(self->mailbox().size(), 0u);
+  sched.run();
+  expect((std::string), from(_).to(self).with(first));
+  expect((std::string), from(_).to(self).with(second));
+}
+
+CAF_TEST(the dispatcher uses pre-decoded compact envelopes) {
+  basp::node_table outgoing;
+  basp::node_table incoming;
+  byte_buffer payload;
+  binary_serializer sink{sys, payload};
+  if (!basp::write_compact_envelope(sink, outgoing, node_id{}, 0, self->id(),
+                                    false)
+      || !sink.apply(make_message("hello")))
+    CAF_FAIL("failed to serialize payload: " << sink.get_error());
+  basp::compact_envelope envelope;
+  binary_deserializer source{sys, payload};
+  if (!basp::read_compact_envelope(source, incoming, envelope))
+    CAF_FAIL("failed to read envelope: " << source.get_error());
+  basp::header hdr{basp::message_type::compact_actor_message,
+                   static_cast<uint32_t>(payload.size()),
+                   make_message_id().integer_value()};
+  CAF_CHECK(dispatcher.dispatch(&ctx, hdr, payload, std::move(envelope)));
+  expect((std::string), from(_).to(self).with("hello"));
+}
+
+CAF_TEST_FIXTURE_SCOPE_END()
@@ -50,16 +50,15 @@ struct fixture : test_coordinator_fixture<> {
 CAF_TEST_FIXTURE_SCOPE(message_queue_tests, fixture)
 
 CAF_TEST(default construction) {
-  CAF_CHECK_EQUAL(queue.next_id, 0u);
-  CAF_CHECK_EQUAL(queue.next_undelivered, 0u);
-  CAF_CHECK_EQUAL(queue.pending.size(), 0u);
+  CAF_CHECK_EQUAL(queue.next_id.load(), 0u);
+  CAF_CHECK_EQUAL(queue.next_undelivered.load(), 0u);
 }
 
 CAF_TEST(ascending IDs) {
   CAF_CHECK_EQUAL(queue.new_id(), 0u);
   CAF_CHECK_EQUAL(queue.new_id(), 1u);
   CAF_CHECK_EQUAL(queue.new_id(), 2u);
-  CAF_CHECK_EQUAL(queue.next_undelivered, 0u);
+  CAF_CHECK_EQUAL(queue.next_undelivered.load(), 0u);
 }
 
 CAF_TEST(push order 0 - 1 - 2) {
@@ -140,4 +139,33 @@ CAF_TEST(dropping) {
   expect((ok_atom, int), from(self).to(testee).with(_, 2));
 }
 
+CAF_TEST(the queue reuses slots after delivering messages) {
+  constexpr auto n = static_cast<int>(net::basp::message_queue::window_size);
+  acquire_ids(static_cast<size_t>(n * 3));
+  for (int offset = 0; offset < n * 3; offset += n) {
+    for (int id = offset + n - 1; id >= offset; --id)
+      push(id);
+    for (int id = offset; id < offset + n; ++id)
+      expect((ok_atom, int), from(self).to(testee).with(_, id));
+  }
+  CAF_CHECK_EQUAL(queue.next_undelivered.load(), static_cast<uint64_t>(n * 3));
+}
+
+CAF_TEST(producers beyond the window never block) {
+  constexpr auto n = static_cast<int>(net::basp::message_queue::window_size);
+  acquire_ids(static_cast<size_t>(n * 2 + 1));
+  // These IDs run too far ahead and take the slow path.
+  push(n * 2);
+  push(n);
+  disallow((ok_atom, int), from(self).to(testee));
+  for (int id = n - 1; id >= 0; --id)
+    push(id);
+  for (int id = n + 1; id < n * 2; ++id)
+    push(id);
+  for (int id = 0; id <= n * 2; ++id)
+    expect((ok_atom, int), from(self).to(testee).with(_, id));
+  CAF_CHECK_EQUAL(queue.next_undelivered.load(),
+                  static_cast<uint64_t>(n * 2 + 1));
+}
+
 CAF_TEST_FIXTURE_SCOPE_END()
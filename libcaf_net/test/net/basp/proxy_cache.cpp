@@ -0,0 +1,99 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#define CAF_SUITE net.basp.proxy_cache
+
+#include "caf/net/basp/proxy_cache.hpp"
+
+#include "caf/test/dsl.hpp"
+
+#include "caf/actor_proxy.hpp"
+#include "caf/make_actor.hpp"
+#include "caf/proxy_registry.hpp"
+#include "caf/uri.hpp"
+
+using namespace caf;
+using namespace caf::net;
+
+namespace {
+
+class dummy_proxy : public actor_proxy {
+public:
+  explicit dummy_proxy(actor_config& cfg) : actor_proxy(cfg) {
+    // nop
+  }
+
+  bool enqueue(mailbox_element_ptr, execution_unit*) override {
+    return false;
+  }
+
+  void kill_proxy(execution_unit* ctx, error rsn) override {
+    cleanup(std::move(rsn), ctx);
+  }
+};
+
+class dummy_backend : public proxy_registry::backend {
+public:
+  explicit dummy_backend(actor_system& sys) : sys_(sys) {
+    // nop
+  }
+
+  strong_actor_ptr make_proxy(node_id nid, actor_id aid) override {
+    actor_config cfg;
+    return make_actor<dummy_proxy, strong_actor_ptr>(aid, nid, &sys_, cfg);
+  }
+
+  void set_last_hop(node_id*) override {
+    // nop
+  }
+
+private:
+  actor_system& sys_;
+};
+
+struct fixture : test_coordinator_fixture<> {
+  fixture() : backend(sys), proxies(sys, backend) {
+    nid = make_node_id(unbox(make_uri("test:node")));
+  }
+
+  dummy_backend backend;
+
+  proxy_registry proxies;
+
+  basp::proxy_cache cache;
+
+  node_id nid;
+};
+
+} // namespace
+
+CAF_TEST_FIXTURE_SCOPE(proxy_cache_tests, fixture)
+
+CAF_TEST(the cache answers repeated lookups without the registry) {
+  auto p1 = cache.get_or_put(proxies, nid, 42);
+  auto p2 = cache.get_or_put(proxies, nid, 42);
+  CAF_CHECK_NOT_EQUAL(p1, nullptr);
+  CAF_CHECK_EQUAL(p1, p2);
+  CAF_CHECK_EQUAL(cache.hits(), 1u);
+  CAF_CHECK_EQUAL(cache.misses(), 1u);
+  CAF_CHECK_EQUAL(proxies.count_proxies(nid), 1u);
+}
+
+CAF_TEST(the cache never returns killed proxies) {
+  auto p1 = cache.get_or_put(proxies, nid, 42);
+  proxies.erase(nid, 42);
+  auto p2 = cache.get_or_put(proxies, nid, 42);
+  CAF_CHECK_NOT_EQUAL(p1, p2);
+  CAF_CHECK_EQUAL(cache.hits(), 0u);
+  CAF_CHECK_EQUAL(cache.misses(), 2u);
+}
+
+CAF_TEST(clearing the cache forces lookups in the registry) {
+  cache.get_or_put(proxies, nid, 42);
+  cache.clear();
+  cache.get_or_put(proxies, nid, 42);
+  CAF_CHECK_EQUAL(cache.misses(), 2u);
+}
+
+CAF_TEST_FIXTURE_SCOPE_END()
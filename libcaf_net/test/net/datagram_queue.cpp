@@ -0,0 +1,112 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#define CAF_SUITE net.datagram_queue
+
+#include "caf/net/datagram_queue.hpp"
+
+#include "caf/test/dsl.hpp"
+
+#include "caf/ipv4_address.hpp"
+
+using namespace caf;
+using namespace caf::net;
+
+namespace {
+
+struct fixture {
+  fixture() : queue(4) {
+    ep = ip_endpoint{make_ipv4_address(127, 0, 0, 1), 1234};
+  }
+
+  /// Pushes a datagram with a header and a payload buffer, filled with `x`.
+  void push(uint8_t x) {
+    auto hdr = queue.next_buffer();
+    auto payload = queue.next_buffer();
+    hdr.assign(4, static_cast<byte>(x));
+    payload.assign(100, static_cast<byte>(x));
+    byte_buffer* bufs[] = {&hdr, &payload};
+    queue.push(ep, make_span(bufs, 2));
+  }
+
+  /// Returns the first byte of the first datagram.
+  uint8_t front_tag() {
+    return static_cast<uint8_t>(queue.front().buffers()[0]->front());
+  }
+
+  datagram_queue queue;
+
+  ip_endpoint ep;
+};
+
+} // namespace
+
+CAF_TEST_FIXTURE_SCOPE(datagram_queue_tests, fixture)
+
+CAF_TEST(queues store datagrams in FIFO order) {
+  CAF_CHECK(queue.empty());
+  push(1);
+  push(2);
+  CAF_CHECK_EQUAL(queue.size(), 2u);
+  CAF_CHECK_EQUAL(queue.front().receiver(), ep);
+  CAF_CHECK_EQUAL(queue.front().size(), 104u);
+  CAF_CHECK_EQUAL(queue.front().num_buffers(), 2u);
+  CAF_CHECK_EQUAL(static_cast<uint8_t>(queue[1].buffers()[1]->front()), 2u);
+  CAF_CHECK_EQUAL(front_tag(), 1u);
+  queue.pop();
+  CAF_CHECK_EQUAL(front_tag(), 2u);
+  queue.pop();
+  CAF_CHECK(queue.empty());
+}
+
+CAF_TEST(popping datagrams returns their buffers to the pool) {
+  push(1);
+  auto data = queue.front().buffers()[1]->data();
+  queue.pop();
+  CAF_CHECK_EQUAL(queue.pooled(), 2u);
+  // The pool hands out the most recently returned buffer first.
+  auto buf = queue.next_buffer();
+  CAF_CHECK(buf.empty());
+  CAF_CHECK_GREATER_OR_EQUAL(buf.capacity(), 100u);
+  CAF_CHECK(buf.data() == data);
+}
+
+CAF_TEST(queues keep their order when wrapping around and growing) {
+  CAF_CHECK_EQUAL(queue.capacity(), 4u);
+  push(1);
+  push(2);
+  push(3);
+  queue.pop();
+  queue.pop();
+  // Wrap around: slots 2, 3, 0 and 1 hold datagrams 3 to 6.
+  for (uint8_t x = 4; x <= 6; ++x)
+    push(x);
+  CAF_CHECK_EQUAL(queue.capacity(), 4u);
+  // Grow: the ring doubles its capacity.
+  push(7);
+  CAF_CHECK_EQUAL(queue.capacity(), 8u);
+  CAF_CHECK_EQUAL(queue.size(), 5u);
+  for (uint8_t x = 3; x <= 7; ++x) {
+    CAF_CHECK_EQUAL(front_tag(), x);
+    queue.pop();
+  }
+  CAF_CHECK(queue.empty());
+}
+
+CAF_TEST(the pool has a bounded size) {
+  for (uint8_t x = 0; x < 4; ++x)
+    push(x);
+  // Add buffers that did not come from the pool.
+  byte_buffer extra[4];
+  for (auto& buf : extra)
+    buf.resize(10);
+  while (!queue.empty())
+    queue.pop();
+  byte_buffer* bufs[] = {&extra[0], &extra[1], &extra[2], &extra[3]};
+  queue.push(ep, make_span(bufs, 4));
+  queue.pop();
+  CAF_CHECK_EQUAL(queue.pooled(), 8u);
+}
+
+CAF_TEST_FIXTURE_SCOPE_END()
@@ -0,0 +1,238 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#define CAF_SUITE net.datagram_transport
+
+#include "caf/net/datagram_transport.hpp"
+
+#include "caf/net/test/host_fixture.hpp"
+#include "caf/test/dsl.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "caf/actor_system.hpp"
+#include "caf/byte_buffer.hpp"
+#include "caf/ip_endpoint.hpp"
+#include "caf/net/ip.hpp"
+#include "caf/net/socket.hpp"
+#include "caf/node_id.hpp"
+
+using namespace caf;
+using namespace caf::net;
+
+namespace {
+
+constexpr size_t datagram_size = 100;
+
+using byte_buffer_list = std::vector<byte_buffer>;
+
+using byte_buffer_list_ptr = std::shared_ptr<byte_buffer_list>;
+
+/// Stands in for the `endpoint_manager`, which requires a multiplexer.
+class dummy_manager {
+public:
+  explicit dummy_manager(actor_system& sys) : sys_(sys) {
+    // nop
+  }
+
+  actor_system& system() {
+    return sys_;
+  }
+
+  void register_writing() {
+    ++write_registrations;
+  }
+
+  endpoint_manager_queue::message_ptr next_message() {
+    return nullptr;
+  }
+
+  size_t write_registrations = 0;
+
+private:
+  actor_system& sys_;
+};
+
+/// Writes `num_outgoing` datagrams on startup, each filled with its index,
+/// and collects all received datagrams.
+class dummy_application {
+public:
+  static constexpr bool handshake_free = true;
+
+  dummy_application(size_t num_outgoing, byte_buffer_list_ptr received)
+    : num_outgoing_(num_outgoing), received_(std::move(received)) {
+    // nop
+  }
+
+  template <class Parent>
+  error init(Parent& parent) {
+    for (size_t i = 0; i < num_outgoing_; ++i) {
+      auto buf = parent.next_payload_buffer();
+      buf.insert(buf.end(), datagram_size, static_cast<byte>(i));
+      parent.write_packet(buf);
+    }
+    return none;
+  }
+
+  template <class Parent>
+  error write_message(Parent&,
+                      std::unique_ptr<endpoint_manager_queue::message>) {
+    return none;
+  }
+
+  template <class Parent>
+  error handle_data(Parent&, span<const byte> data) {
+    received_->emplace_back(data.begin(), data.end());
+    return none;
+  }
+
+  template <class Parent>
+  void resolve(Parent&, string_view, const actor&) {
+    // nop
+  }
+
+  template <class Parent>
+  void new_proxy(Parent&, actor_id) {
+    // nop
+  }
+
+  template <class Parent>
+  void local_actor_down(Parent&, actor_id, error) {
+    // nop
+  }
+
+  template <class Parent>
+  void timeout(Parent&, std::string, uint64_t) {
+    // nop
+  }
+
+  void handle_error(sec code) {
+    CAF_FAIL("handle_error called: " << code);
+  }
+
+private:
+  size_t num_outgoing_;
+
+  byte_buffer_list_ptr received_;
+};
+
+class dummy_application_factory {
+public:
+  using application_type = dummy_application;
+
+  dummy_application_factory(size_t num_outgoing, byte_buffer_list_ptr received)
+    : num_outgoing_(num_outgoing), received_(std::move(received)) {
+    // nop
+  }
+
+  dummy_application make() {
+    return dummy_application{num_outgoing_, received_};
+  }
+
+private:
+  size_t num_outgoing_;
+
+  byte_buffer_list_ptr received_;
+};
+
+using transport_type = datagram_transport<dummy_application_factory,
+                                          dummy_manager>;
+
+struct fixture : test_coordinator_fixture<>, host_fixture {
+  fixture()
+    : mgr(sys),
+      replies(std::make_shared<byte_buffer_list>()),
+      received(std::make_shared<byte_buffer_list>()) {
+    auto addresses = ip::local_addresses("localhost");
+    CAF_REQUIRE(!addresses.empty());
+    ep = ip_endpoint(*addresses.begin(), 0);
+    auto send_pair = unbox(make_udp_datagram_socket(ep));
+    send_socket = send_pair.first;
+    auto receive_pair = unbox(make_udp_datagram_socket(ep));
+    receive_socket = receive_pair.first;
+    ep.port(receive_pair.second);
+    for (auto x : {send_socket, receive_socket})
+      if (auto err = nonblocking(x, true))
+        CAF_FAIL("nonblocking returned an error: " << err);
+  }
+
+  ~fixture() {
+    close(send_socket);
+    close(receive_socket);
+  }
+
+  /// Calls `handle_read_event` on `receiver` until it received `num`
+  /// datagrams or gives up after too many attempts.
+  void receive(transport_type& receiver, size_t num) {
+    for (size_t attempt = 0; attempt < 1000 && received->size() < num;
+         ++attempt)
+      CAF_REQUIRE(receiver.handle_read_event(mgr));
+  }
+
+  dummy_manager mgr;
+
+  /// Collects datagrams that reach the sender.
+  byte_buffer_list_ptr replies;
+
+  /// Collects datagrams that reach the receiver.
+  byte_buffer_list_ptr received;
+
+  ip_endpoint ep;
+
+  udp_datagram_socket send_socket;
+
+  udp_datagram_socket receive_socket;
+};
+
+} // namespace
+
+CAF_TEST_FIXTURE_SCOPE(datagram_transport_tests, fixture)
+
+CAF_TEST(transports exchange batches of datagrams over loopback) {
+  // Sending more datagrams than fit into a single batch exercises GSO (if
+  // available) as well as batched and repeated writes.
+  constexpr size_t num_datagrams = 3 * defaults::middleman::datagram_batch_size
+                                   + 5;
+  transport_type sender{send_socket,
+                        dummy_application_factory{num_datagrams, replies}};
+  transport_type receiver{receive_socket,
+                          dummy_application_factory{0, received}};
+  CAF_REQUIRE_EQUAL(sender.init(mgr), none);
+  CAF_REQUIRE_EQUAL(receiver.init(mgr), none);
+  CAF_REQUIRE_EQUAL(sender.add_new_worker(node_id{}, ep), none);
+  CAF_CHECK_EQUAL(mgr.write_registrations, 1u);
+  for (size_t i = 0; i < 100 && sender.handle_write_event(mgr); ++i)
+    ; // Repeat until the sender has no more datagrams.
+  CAF_CHECK(!sender.handle_write_event(mgr));
+  receive(receiver, num_datagrams);
+  CAF_REQUIRE_EQUAL(received->size(), num_datagrams);
+  CAF_CHECK(replies->empty());
+  auto& xs = *received;
+  std::sort(xs.begin(), xs.end(), [](const auto& x, const auto& y) {
+    return x.front() < y.front();
+  });
+  for (size_t i = 0; i < num_datagrams; ++i) {
+    CAF_CHECK_EQUAL(xs[i].size(), datagram_size);
+    CAF_CHECK_EQUAL(static_cast<size_t>(xs[i].front()), i);
+  }
+}
+
+CAF_TEST(transports recycle the buffers of sent datagrams) {
+  transport_type sender{send_socket, dummy_application_factory{4, replies}};
+  transport_type receiver{receive_socket,
+                          dummy_application_factory{0, received}};
+  CAF_REQUIRE_EQUAL(sender.init(mgr), none);
+  CAF_REQUIRE_EQUAL(receiver.init(mgr), none);
+  CAF_REQUIRE_EQUAL(sender.add_new_worker(node_id{}, ep), none);
+  CAF_CHECK(!sender.handle_write_event(mgr));
+  auto buf = sender.next_payload_buffer();
+  CAF_CHECK(buf.empty());
+  CAF_CHECK_GREATER_OR_EQUAL(buf.capacity(), datagram_size);
+  receive(receiver, 4);
+  CAF_CHECK_EQUAL(received->size(), 4u);
+}
+
+CAF_TEST_FIXTURE_SCOPE_END()
@@ -0,0 +1,88 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#define CAF_SUITE net.endpoint_manager_queue
+
+#include "caf/net/endpoint_manager_queue.hpp"
+
+#include "caf/test/dsl.hpp"
+
+#include <vector>
+
+using namespace caf;
+using namespace caf::net;
+
+namespace {
+
+struct fixture : test_coordinator_fixture<> {
+  fixture() : queue(unit, unit, unit, unit) {
+    // nop
+  }
+
+  void push(int value, message_priority prio) {
+    auto elem = make_mailbox_element(nullptr, make_message_id(prio), {},
+                                     make_message(value));
+    queue.push_back(
+      new endpoint_manager_queue::message(std::move(elem), self->ctrl()));
+  }
+
+  /// Drains the queue and returns the values of all messages in the order of
+  /// the selector.
+  std::vector<int> drain(endpoint_manager_queue::lane_selector& lanes) {
+    std::vector<int> result;
+    while (auto ptr = lanes.next(queue))
+      result.emplace_back(ptr->msg->content().get_as<int>(0));
+    return result;
+  }
+
+  endpoint_manager_queue::policy::queue_type queue;
+};
+
+} // namespace
+
+CAF_TEST_FIXTURE_SCOPE(endpoint_manager_queue_tests, fixture)
+
+CAF_TEST(messages get their lane from their priority) {
+  auto make = [&](message_priority prio) {
+    return endpoint_manager_queue::message{
+      make_mailbox_element(nullptr, make_message_id(prio), {},
+                           make_message(1)),
+      self->ctrl()};
+  };
+  using element_type = endpoint_manager_queue::element_type;
+  CAF_CHECK(make(message_priority::high).tag() == element_type::urgent_message);
+  CAF_CHECK(make(message_priority::normal).tag() == element_type::message);
+}
+
+CAF_TEST(urgent messages overtake regular messages) {
+  endpoint_manager_queue::lane_selector lanes{4};
+  push(1, message_priority::normal);
+  push(2, message_priority::high);
+  push(3, message_priority::normal);
+  push(4, message_priority::high);
+  CAF_CHECK_EQUAL(drain(lanes), std::vector<int>({2, 4, 1, 3}));
+}
+
+CAF_TEST(the urgent weight bounds the urgent streak) {
+  endpoint_manager_queue::lane_selector lanes{2};
+  for (int i = 1; i <= 5; ++i)
+    push(i, message_priority::high);
+  push(10, message_priority::normal);
+  push(11, message_priority::normal);
+  CAF_CHECK_EQUAL(drain(lanes), std::vector<int>({1, 2, 10, 3, 4, 11, 5}));
+}
+
+CAF_TEST(an empty regular lane never delays urgent messages) {
+  endpoint_manager_queue::lane_selector lanes{1};
+  for (int i = 1; i <= 3; ++i)
+    push(i, message_priority::high);
+  CAF_CHECK_EQUAL(drain(lanes), std::vector<int>({1, 2, 3}));
+}
+
+CAF_TEST(an empty queue yields no message) {
+  endpoint_manager_queue::lane_selector lanes{4};
+  CAF_CHECK(lanes.next(queue) == nullptr);
+}
+
+CAF_TEST_FIXTURE_SCOPE_END()
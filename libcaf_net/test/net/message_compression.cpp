@@ -0,0 +1,235 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#define CAF_SUITE net.message_compression
+
+#include "caf/net/message_compression.hpp"
+
+#include "net-test.hpp"
+
+#include <string>
+#include <vector>
+
+#include "caf/byte.hpp"
+#include "caf/byte_buffer.hpp"
+#include "caf/byte_span.hpp"
+#include "caf/net/length_prefix_framing.hpp"
+#include "caf/settings.hpp"
+#include "caf/span.hpp"
+#include "caf/tag/message_oriented.hpp"
+
+using namespace caf;
+using namespace std::literals;
+
+namespace {
+
+using string_list = std::vector<std::string>;
+
+struct app {
+  using input_tag = tag::message_oriented;
+
+  template <class LowerLayerPtr>
+  caf::error init(net::socket_manager*, LowerLayerPtr, const settings&) {
+    return none;
+  }
+
+  template <class LowerLayerPtr>
+  bool prepare_send(LowerLayerPtr down) {
+    for (auto& str : outbox) {
+      down->begin_message();
+      auto& buf = down->message_buffer();
+      auto bytes = as_bytes(make_span(str));
+      buf.insert(buf.end(), bytes.begin(), bytes.end());
+      if (!down->end_message())
+        return false;
+    }
+    outbox.clear();
+    return true;
+  }
+
+  template <class LowerLayerPtr>
+  bool done_sending(LowerLayerPtr) {
+    return true;
+  }
+
+  template <class LowerLayerPtr>
+  void abort(LowerLayerPtr, const error&) {
+    // nop
+  }
+
+  template <class LowerLayerPtr>
+  ptrdiff_t consume(LowerLayerPtr, byte_span buf) {
+    auto str_buf = reinterpret_cast<char*>(buf.data());
+    inputs.emplace_back(std::string{str_buf, buf.size()});
+    return static_cast<ptrdiff_t>(buf.size());
+  }
+
+  string_list outbox;
+
+  string_list inputs;
+};
+
+using stack_type = mock_stream_transport<
+  net::length_prefix_framing<net::message_compression<app>>>;
+
+auto& compression_of(stack_type& x) {
+  return x.upper_layer.upper_layer();
+}
+
+auto& app_of(stack_type& x) {
+  return compression_of(x).upper_layer();
+}
+
+// Sends `str` and returns how many Bytes the stack wrote to its output.
+size_t send(stack_type& x, std::string str) {
+  auto before = x.output.size();
+  app_of(x).outbox.emplace_back(std::move(str));
+  CHECK(x.upper_layer.prepare_send(&x));
+  return x.output.size() - before;
+}
+
+void transfer(stack_type& from, stack_type& to) {
+  to.input.insert(to.input.end(), from.output.begin(), from.output.end());
+  from.output.clear();
+  CHECK_GE(to.handle_input(), 0);
+}
+
+std::string repeat(string_view str, size_t n) {
+  std::string result;
+  for (size_t i = 0; i < n; ++i)
+    result.insert(result.end(), str.begin(), str.end());
+  return result;
+}
+
+// Size of the length prefix plus the flags Byte of uncompressed messages.
+constexpr size_t raw_overhead = 5;
+
+} // namespace
+
+SCENARIO("message compression shrinks large messages") {
+  GIVEN("two connected stacks that accept compression") {
+    stack_type a;
+    stack_type b;
+    CHECK_EQ(a.init(), error{});
+    CHECK_EQ(b.init(), error{});
+    transfer(a, b);
+    transfer(b, a);
+    CHECK(compression_of(a).peer_accepts_compression());
+    CHECK(compression_of(b).peer_accepts_compression());
+    WHEN("sending a large message with a repetitive pattern") {
+      auto msg = repeat("hello world! ", 100);
+      auto written = send(a, msg);
+      transfer(a, b);
+      THEN("the receiver obtains the original message from fewer Bytes") {
+        CHECK_LT(written, msg.size());
+        CHECK_EQ(app_of(b).inputs, string_list({msg}));
+      }
+    }
+    WHEN("sending small messages that repeat previous messages") {
+      auto msg = "caf::net::basp::message_type::actor_message from mars"s;
+      auto first = send(a, msg);
+      auto second = send(a, msg);
+      transfer(a, b);
+      THEN("the dictionary allows the layer to compress small messages") {
+        CHECK_EQ(first, msg.size() + raw_overhead);
+        CHECK_LT(second, first / 2);
+        CHECK_EQ(app_of(b).inputs, string_list({msg, msg}));
+      }
+    }
+  }
+}
+
+SCENARIO("message compression requires consent of the receiver") {
+  GIVEN("two connected stacks with compression disabled on one side") {
+    stack_type a;
+    stack_type b;
+    settings cfg;
+    put(cfg, "caf.middleman.compression.enable", false);
+    CHECK_EQ(a.init(), error{});
+    CHECK_EQ(b.init(cfg), error{});
+    transfer(a, b);
+    transfer(b, a);
+    WHEN("sending a large message with a repetitive pattern to either side") {
+      auto msg = repeat("hello world! ", 100);
+      auto written_by_a = send(a, msg);
+      auto written_by_b = send(b, msg);
+      transfer(a, b);
+      transfer(b, a);
+      THEN("both sides send the message uncompressed") {
+        CHECK_EQ(written_by_a, msg.size() + raw_overhead);
+        CHECK_EQ(written_by_b, msg.size() + raw_overhead);
+        CHECK_EQ(app_of(a).inputs, string_list({msg}));
+        CHECK_EQ(app_of(b).inputs, string_list({msg}));
+      }
+    }
+  }
+  GIVEN("a stack that did not receive the hello of its peer yet") {
+    stack_type a;
+    stack_type b;
+    CHECK_EQ(a.init(), error{});
+    CHECK_EQ(b.init(), error{});
+    WHEN("sending a large message with a repetitive pattern") {
+      auto msg = repeat("hello world! ", 100);
+      auto written = send(a, msg);
+      transfer(a, b);
+      THEN("the stack sends the message uncompressed") {
+        CHECK_EQ(written, msg.size() + raw_overhead);
+        CHECK_EQ(app_of(b).inputs, string_list({msg}));
+      }
+    }
+  }
+}
+
+SCENARIO("message compression rejects malformed input") {
+  GIVEN("a stack that received the hello of its peer") {
+    stack_type a;
+    stack_type b;
+    CHECK_EQ(a.init(), error{});
+    CHECK_EQ(b.init(), error{});
+    transfer(a, b);
+    transfer(b, a);
+    WHEN("receiving a compressed message that claims a wrong size") {
+      auto msg = repeat("hello world! ", 100);
+      send(a, msg);
+      // Patch the plaintext size that follows the length prefix and flags.
+      a.output[8] = static_cast<byte>(static_cast<uint8_t>(a.output[8]) + 1);
+      b.input.insert(b.input.end(), a.output.begin(), a.output.end());
+      THEN("the receiver aborts") {
+        CHECK_EQ(b.handle_input(), -1);
+        CHECK(app_of(b).inputs.empty());
+      }
+    }
+    WHEN("receiving a few Bytes that claim a huge plaintext") {
+      // Length prefix, flags, plaintext size, and a match with length Bytes.
+      auto frame = std::vector<uint8_t>{0,    0,    0,    10,   0x01,
+                                        0x7F, 0xFF, 0xFF, 0xFF, 0x1F,
+                                        'a',  1,    0,    0};
+      for (auto x : frame)
+        b.input.push_back(static_cast<byte>(x));
+      THEN("the receiver aborts without allocating the claimed size") {
+        CHECK_EQ(b.handle_input(), -1);
+        CHECK(app_of(b).inputs.empty());
+      }
+    }
+  }
+  GIVEN("a stack with a maximum message size") {
+    stack_type a;
+    stack_type b;
+    settings cfg;
+    put(cfg, "caf.middleman.compression.max-message-size", size_t{1000});
+    CHECK_EQ(a.init(), error{});
+    CHECK_EQ(b.init(cfg), error{});
+    transfer(a, b);
+    transfer(b, a);
+    WHEN("receiving a compressed message that exceeds the maximum") {
+      auto msg = repeat("hello world! ", 100);
+      send(a, msg);
+      b.input.insert(b.input.end(), a.output.begin(), a.output.end());
+      THEN("the receiver aborts") {
+        CHECK_EQ(b.handle_input(), -1);
+        CHECK(app_of(b).inputs.empty());
+      }
+    }
+  }
+}
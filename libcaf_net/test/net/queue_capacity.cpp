@@ -0,0 +1,100 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#define CAF_SUITE net.queue_capacity
+
+#include "caf/net/queue_capacity.hpp"
+
+#include "caf/test/dsl.hpp"
+
+#include "caf/mailbox_element.hpp"
+
+using namespace caf;
+using namespace caf::net;
+
+namespace {
+
+behavior dummy_impl() {
+  return {
+    [](int) {
+      // nop
+    },
+  };
+}
+
+struct fixture : test_coordinator_fixture<> {
+  fixture() {
+    receiver = sys.spawn(dummy_impl);
+    run();
+  }
+
+  endpoint_manager_queue::message make_msg(strong_actor_ptr sender,
+                                           message_id mid) {
+    return {make_mailbox_element(std::move(sender), mid, {}, make_message(42)),
+            actor_cast<strong_actor_ptr>(receiver)};
+  }
+
+  actor receiver;
+};
+
+} // namespace
+
+CAF_TEST_FIXTURE_SCOPE(queue_capacity_tests, fixture)
+
+CAF_TEST(the capacity limits the number of messages) {
+  queue_capacity uut{2, 0, overflow_strategy::drop_newest};
+  CAF_CHECK(uut.try_add(100));
+  CAF_CHECK(uut.try_add(100));
+  CAF_CHECK(!uut.try_add(1));
+  CAF_CHECK_EQUAL(uut.messages(), 2u);
+  CAF_CHECK_EQUAL(uut.bytes(), 200u);
+  uut.remove(100);
+  CAF_CHECK(!uut.must_drop_oldest());
+  CAF_CHECK(uut.try_add(1));
+}
+
+CAF_TEST(the capacity limits the number of bytes) {
+  queue_capacity uut{0, 100, overflow_strategy::notify_sender};
+  CAF_CHECK(uut.try_add(60));
+  CAF_CHECK(!uut.try_add(60));
+  CAF_CHECK(uut.try_add(40));
+  CAF_CHECK_EQUAL(uut.messages(), 2u);
+}
+
+CAF_TEST(drop_oldest accepts twice the capacity until dropping messages) {
+  queue_capacity uut{2, 0, overflow_strategy::drop_oldest};
+  for (int i = 0; i < 4; ++i)
+    CAF_CHECK(uut.try_add(1));
+  CAF_CHECK(!uut.try_add(1));
+  uut.remove(1);
+  CAF_CHECK(uut.must_drop_oldest());
+  uut.remove(1);
+  CAF_CHECK(!uut.must_drop_oldest());
+}
+
+CAF_TEST(rejected requests receive an error response) {
+  queue_capacity uut{1, 0, overflow_strategy::notify_sender};
+  uut.reject(make_msg(actor_cast<strong_actor_ptr>(self), make_message_id(42)));
+  expect((error), from(_).to(self).with(sec::unavailable_or_would_block));
+}
+
+CAF_TEST(drop_newest silently discards asynchronous messages) {
+  queue_capacity uut{1, 0, overflow_strategy::drop_newest};
+  uut.reject(make_msg(actor_cast<strong_actor_ptr>(self), make_message_id()));
+  CAF_CHECK(self->mailbox().empty());
+}
+
+CAF_TEST(notify_sender signals backpressure without killing the sender) {
+  queue_capacity uut{1, 0, overflow_strategy::notify_sender};
+  auto sender = sys.spawn(dummy_impl);
+  run();
+  uut.reject(make_msg(actor_cast<strong_actor_ptr>(sender), make_message_id()));
+  expect((sec, actor_addr),
+         from(_).to(sender).with(sec::unavailable_or_would_block,
+                                 receiver.address()));
+  self->send(sender, 1);
+  expect((int), from(self).to(sender).with(1));
+}
+
+CAF_TEST_FIXTURE_SCOPE_END()
@@ -0,0 +1,263 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#define CAF_SUITE net.reliability_layer
+
+#include "caf/net/reliability_layer.hpp"
+
+#include "caf/test/dsl.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+using namespace caf;
+using namespace caf::net;
+using namespace std::literals::chrono_literals;
+
+namespace {
+
+using time_point = reliable_session::time_point;
+
+byte_buffer make_bytes(size_t size) {
+  byte_buffer result;
+  result.reserve(size);
+  for (size_t i = 0; i < size; ++i)
+    result.emplace_back(static_cast<byte>(i % 251));
+  return result;
+}
+
+/// Allows the test to advance time manually.
+struct manual_clock {
+  static time_point now() {
+    return current;
+  }
+
+  static inline time_point current = time_point{} + 1h;
+};
+
+/// Records the timeouts of a layer.
+struct dummy_manager {
+  struct pending_timeout {
+    time_point when;
+    std::string tag;
+    uint64_t id;
+  };
+
+  void set_timeout(timespan delay, std::string tag, uint64_t id) {
+    timeouts.emplace_back(
+      pending_timeout{manual_clock::now() + delay, std::move(tag), id});
+  }
+
+  std::vector<pending_timeout> timeouts;
+};
+
+struct dummy_transport {
+  void set_timeout(uint64_t, int) {
+    // nop
+  }
+};
+
+/// Stands in for the `transport_worker` and collects outgoing datagrams.
+struct dummy_parent {
+  void write_packet(byte_buffer& buf) {
+    outbox.emplace_back(buf);
+  }
+
+  dummy_manager& manager() {
+    return mgr;
+  }
+
+  dummy_transport& transport() {
+    return trans;
+  }
+
+  int id() const noexcept {
+    return 0;
+  }
+
+  std::vector<byte_buffer> outbox;
+
+  dummy_manager mgr;
+
+  dummy_transport trans;
+};
+
+/// Sends `output` on startup and collects all received bytes.
+struct stream_app {
+  template <class Parent>
+  error init(Parent& parent) {
+    parent.transport().configure_read(receive_policy::up_to(512));
+    if (!output.empty()) {
+      auto buf = parent.next_payload_buffer();
+      buf.insert(buf.end(), output.begin(), output.end());
+      parent.write_packet(buf);
+    }
+    return none;
+  }
+
+  template <class Parent>
+  error handle_data(Parent&, span<const byte> bytes) {
+    input.insert(input.end(), bytes.begin(), bytes.end());
+    return none;
+  }
+
+  /// Writes a packet with a 30-byte header and a 50-byte payload.
+  template <class Parent>
+  error write_message(Parent& parent,
+                      std::unique_ptr<endpoint_manager_queue::message>) {
+    auto hdr = parent.next_header_buffer();
+    auto payload = parent.next_payload_buffer();
+    capacities.emplace_back(hdr.capacity() + payload.capacity());
+    hdr.insert(hdr.end(), 30, byte{1});
+    payload.insert(payload.end(), 50, byte{2});
+    parent.write_packet(hdr, payload);
+    return none;
+  }
+
+  template <class Parent>
+  void timeout(Parent&, std::string, uint64_t) {
+    // nop
+  }
+
+  void handle_error(sec code) {
+    errors.emplace_back(code);
+  }
+
+  byte_buffer output;
+
+  byte_buffer input;
+
+  std::vector<sec> errors;
+
+  /// Stores the capacity of the buffers for each `write_message` call.
+  std::vector<size_t> capacities;
+};
+
+using layer_type = reliability_layer<stream_app, manual_clock>;
+
+/// Connects two layers over a simulated link that may drop or reorder the
+/// datagrams from `alice` to `bob`.
+struct fixture {
+  fixture()
+    : alice(stream_app{make_bytes(20'000), {}, {}}, 100),
+      bob(stream_app{}, 100) {
+    CAF_REQUIRE_EQUAL(alice.init(alice_parent), none);
+    CAF_REQUIRE_EQUAL(bob.init(bob_parent), none);
+  }
+
+  /// Delivers all pending datagrams once. Returns the number of datagrams
+  /// `alice` sent.
+  size_t exchange() {
+    std::vector<byte_buffer> out;
+    out.swap(alice_parent.outbox);
+    auto result = out.size();
+    if (reorder)
+      std::reverse(out.begin(), out.end());
+    manual_clock::current += latency;
+    for (auto& x : out)
+      if (!drop || !drop(x))
+        CAF_CHECK_EQUAL(bob.handle_data(bob_parent, x), none);
+    out.clear();
+    out.swap(bob_parent.outbox);
+    manual_clock::current += latency;
+    for (auto& x : out)
+      CAF_CHECK_EQUAL(alice.handle_data(alice_parent, x), none);
+    return result;
+  }
+
+  /// Skips ahead to the next timeout of `alice` and triggers it. Returns
+  /// `false` if `alice` has no pending timeout.
+  bool fire_next_timeout() {
+    auto& timeouts = alice_parent.mgr.timeouts;
+    if (timeouts.empty())
+      return false;
+    auto i = std::min_element(timeouts.begin(), timeouts.end(),
+                              [](const auto& x, const auto& y) {
+                                return x.when < y.when;
+                              });
+    auto x = std::move(*i);
+    timeouts.erase(i);
+    manual_clock::current = std::max(manual_clock::current, x.when);
+    alice.timeout(alice_parent, std::move(x.tag), x.id);
+    return true;
+  }
+
+  /// Exchanges datagrams until `alice` has no more data in flight or gives
+  /// up on `bob`.
+  void run() {
+    for (size_t round = 0; round < 10'000; ++round) {
+      if (alice.session().idle() || alice.failed())
+        return;
+      if (exchange() == 0 && !fire_next_timeout())
+        return;
+    }
+  }
+
+  dummy_parent alice_parent;
+
+  dummy_parent bob_parent;
+
+  layer_type alice;
+
+  layer_type bob;
+
+  timespan latency = 10ms;
+
+  std::function<bool(const byte_buffer&)> drop;
+
+  bool reorder = false;
+};
+
+} // namespace
+
+CAF_TEST_FIXTURE_SCOPE(reliability_layer_tests, fixture)
+
+CAF_TEST(layers deliver the byte stream over a lossy and reordering link) {
+  size_t count = 0;
+  drop = [&count](const byte_buffer&) { return ++count % 7 == 0; };
+  reorder = true;
+  run();
+  CAF_CHECK(alice.session().idle());
+  CAF_CHECK_EQUAL(bob.application().input, make_bytes(20'000));
+  CAF_CHECK_GREATER(alice.session().retransmissions(), 0u);
+  CAF_CHECK(alice.application().errors.empty());
+  CAF_CHECK(bob.application().errors.empty());
+}
+
+CAF_TEST(layers report a silent peer exactly once) {
+  drop = [](const byte_buffer&) { return true; };
+  run();
+  CAF_REQUIRE(alice.failed());
+  CAF_CHECK_EQUAL(alice.application().errors.size(), 1u);
+  // The layer neither sends nor re-arms its timer after tearing down.
+  alice_parent.outbox.clear();
+  while (fire_next_timeout())
+    ; // nop
+  alice.handle_error(sec::socket_disconnected);
+  CAF_CHECK(alice_parent.outbox.empty());
+  CAF_CHECK(alice_parent.mgr.timeouts.empty());
+  CAF_CHECK_EQUAL(alice.application().errors.size(), 1u);
+  CAF_CHECK_EQUAL(alice.application().errors.front(), sec::socket_disconnected);
+}
+
+CAF_TEST(layers send each packet as a whole and recycle its buffers) {
+  dummy_parent carol_parent;
+  layer_type carol{stream_app{}, 100};
+  CAF_REQUIRE_EQUAL(carol.init(carol_parent), none);
+  CAF_REQUIRE(carol_parent.outbox.empty());
+  CAF_CHECK_EQUAL(carol.write_message(carol_parent, nullptr), none);
+  if (CAF_CHECK_EQUAL(carol_parent.outbox.size(), 1u))
+    CAF_CHECK_EQUAL(carol_parent.outbox.front().size(),
+                    reliable_session::header_size + 80);
+  CAF_CHECK_EQUAL(carol.write_message(carol_parent, nullptr), none);
+  auto& capacities = carol.application().capacities;
+  if (CAF_CHECK_EQUAL(capacities.size(), 2u)) {
+    CAF_CHECK_EQUAL(capacities[0], 0u);
+    CAF_CHECK_GREATER_OR_EQUAL(capacities[1], 80u);
+  }
+}
+
+CAF_TEST_FIXTURE_SCOPE_END()
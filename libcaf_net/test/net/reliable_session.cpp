@@ -0,0 +1,196 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#define CAF_SUITE net.reliable_session
+
+#include "caf/net/reliable_session.hpp"
+
+#include "caf/test/dsl.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+
+using namespace caf;
+using namespace caf::net;
+using namespace std::literals::chrono_literals;
+
+namespace {
+
+using time_point = reliable_session::time_point;
+
+byte_buffer make_bytes(size_t size) {
+  byte_buffer result;
+  result.reserve(size);
+  for (size_t i = 0; i < size; ++i)
+    result.emplace_back(static_cast<byte>(i % 251));
+  return result;
+}
+
+/// Connects two sessions over a simulated link that may drop or reorder the
+/// datagrams from `alice` to `bob`.
+struct fixture {
+  fixture() : now(time_point{} + 1h) {
+    // nop
+  }
+
+  /// Sends everything `alice` and `bob` have to send once. Returns the number
+  /// of datagrams `alice` sent.
+  size_t exchange() {
+    std::vector<byte_buffer> out;
+    alice.poll(now, out);
+    auto result = out.size();
+    if (reorder)
+      std::reverse(out.begin(), out.end());
+    now += latency;
+    for (auto& x : out)
+      if (!drop || !drop(x))
+        CAF_CHECK_EQUAL(bob.handle_datagram(now, x), none);
+    out.clear();
+    bob.poll(now, out);
+    now += latency;
+    for (auto& x : out)
+      CAF_CHECK_EQUAL(alice.handle_datagram(now, x), none);
+    std::vector<reliable_session::delivery> delivered;
+    bob.drain(delivered);
+    for (auto& x : delivered) {
+      auto& buf = received[x.stream];
+      buf.insert(buf.end(), x.payload.begin(), x.payload.end());
+    }
+    return result;
+  }
+
+  /// Exchanges datagrams until `alice` has no more data in flight. Skips
+  /// ahead to the next retransmission timeout whenever `alice` is stuck.
+  void run() {
+    for (size_t round = 0; round < 10'000 && !alice.idle(); ++round)
+      if (exchange() == 0 && alice.in_flight() > 0)
+        now = std::max(now, alice.next_timeout());
+    CAF_CHECK(alice.idle());
+  }
+
+  reliable_session alice{100};
+
+  reliable_session bob{100};
+
+  time_point now;
+
+  timespan latency = 10ms;
+
+  std::function<bool(const byte_buffer&)> drop;
+
+  bool reorder = false;
+
+  std::map<reliable_session::stream_id, byte_buffer> received;
+};
+
+} // namespace
+
+CAF_TEST_FIXTURE_SCOPE(reliable_session_tests, fixture)
+
+CAF_TEST(sessions deliver data in order on a perfect link) {
+  auto data = make_bytes(10'000);
+  alice.send(0, data);
+  CAF_CHECK_EQUAL(alice.queued(), 100u);
+  run();
+  CAF_CHECK_EQUAL(received[0], data);
+  CAF_CHECK_EQUAL(alice.retransmissions(), 0u);
+  CAF_CHECK_GREATER(alice.congestion_window(),
+                    reliable_session::initial_window);
+}
+
+CAF_TEST(sessions estimate the round-trip time) {
+  latency = 25ms;
+  alice.send(0, make_bytes(10));
+  run();
+  CAF_CHECK_EQUAL(alice.smoothed_rtt(), timespan{50ms});
+  CAF_CHECK_EQUAL(alice.retransmission_timeout(), reliable_session::min_rto);
+}
+
+CAF_TEST(sessions restore the order of reordered segments) {
+  reorder = true;
+  auto data = make_bytes(10'000);
+  alice.send(0, data);
+  run();
+  CAF_CHECK_EQUAL(received[0], data);
+  CAF_CHECK_EQUAL(alice.retransmissions(), 0u);
+}
+
+CAF_TEST(sessions retransmit lost segments) {
+  size_t count = 0;
+  drop = [&count](const byte_buffer&) { return ++count % 7 == 0; };
+  reorder = true;
+  auto data = make_bytes(50'000);
+  alice.send(0, data);
+  run();
+  CAF_CHECK_EQUAL(received[0], data);
+  CAF_CHECK_GREATER(alice.retransmissions(), 0u);
+  CAF_CHECK_LESS(alice.slow_start_threshold(), reliable_session::max_window);
+  CAF_CHECK(!alice.failed());
+}
+
+CAF_TEST(a lost segment only blocks its own stream) {
+  size_t count = 0;
+  drop = [&count](const byte_buffer&) { return ++count == 1; };
+  alice.send(1, make_bytes(10));
+  alice.send(2, make_bytes(20));
+  exchange();
+  CAF_CHECK_EQUAL(received.count(1), 0u);
+  CAF_CHECK_EQUAL(received[2], make_bytes(20));
+  run();
+  CAF_CHECK_EQUAL(received[1], make_bytes(10));
+}
+
+CAF_TEST(timeouts collapse the congestion window and back off) {
+  drop = [](const byte_buffer&) { return true; };
+  alice.send(0, make_bytes(10));
+  exchange();
+  CAF_CHECK_EQUAL(alice.in_flight(), 1u);
+  CAF_CHECK_EQUAL(alice.next_timeout() - now,
+                  reliable_session::initial_rto - 2 * latency);
+  now = alice.next_timeout();
+  exchange();
+  CAF_CHECK_EQUAL(alice.retransmissions(), 1u);
+  CAF_CHECK_EQUAL(alice.congestion_window(), 1u);
+  CAF_CHECK_EQUAL(alice.retransmission_timeout(),
+                  2 * reliable_session::initial_rto);
+  for (size_t i = 2; i < reliable_session::max_retransmissions; ++i) {
+    now = alice.next_timeout();
+    exchange();
+  }
+  CAF_CHECK(!alice.failed());
+  now = alice.next_timeout();
+  exchange();
+  CAF_CHECK(alice.failed());
+}
+
+CAF_TEST(sessions reject segments beyond the window of their stream) {
+  alice.send(0, make_bytes(10));
+  std::vector<byte_buffer> out;
+  alice.poll(now, out);
+  CAF_REQUIRE_EQUAL(out.size(), 1u);
+  auto segment = out[0];
+  // Overwrite the stream sequence number at offset 12 (network byte order).
+  uint64_t stream_seq = reliable_session::max_window;
+  for (size_t i = 0; i < 8; ++i)
+    segment[19 - i] = static_cast<byte>((stream_seq >> (8 * i)) & 0xFF);
+  CAF_CHECK_NOT_EQUAL(bob.handle_datagram(now, segment), none);
+  std::vector<reliable_session::delivery> delivered;
+  bob.drain(delivered);
+  CAF_CHECK(delivered.empty());
+  CAF_MESSAGE("the session still accepts the original segment");
+  CAF_CHECK_EQUAL(bob.handle_datagram(now, out[0]), none);
+  bob.drain(delivered);
+  if (CAF_CHECK_EQUAL(delivered.size(), 1u))
+    CAF_CHECK_EQUAL(delivered[0].payload, make_bytes(10));
+}
+
+CAF_TEST(sessions reject malformed datagrams) {
+  CAF_CHECK_NOT_EQUAL(bob.handle_datagram(now, make_bytes(5)), none);
+  auto buf = make_bytes(reliable_session::header_size);
+  buf[0] = byte{42};
+  CAF_CHECK_NOT_EQUAL(bob.handle_datagram(now, buf), none);
+}
+
+CAF_TEST_FIXTURE_SCOPE_END()
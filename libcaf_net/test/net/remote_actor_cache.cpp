@@ -0,0 +1,127 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#define CAF_SUITE net.remote_actor_cache
+
+#include "caf/net/remote_actor_cache.hpp"
+
+#include "caf/test/dsl.hpp"
+
+#include <memory>
+
+#include "caf/actor_cast.hpp"
+#include "caf/event_based_actor.hpp"
+#include "caf/net/middleman.hpp"
+#include "caf/typed_actor.hpp"
+
+using namespace caf;
+using namespace caf::net;
+using namespace std::literals::chrono_literals;
+
+namespace {
+
+using int_actor = typed_actor<result<void>(int)>;
+
+behavior dummy_impl() {
+  return {
+    [](int) {
+      // nop
+    },
+  };
+}
+
+struct fixture : test_coordinator_fixture<> {
+  fixture() {
+    cache = std::make_shared<remote_actor_cache>(timespan{1s});
+    locator = unbox(make_uri("tcp://node:1234/name/foo"));
+    dummy = actor_cast<strong_actor_ptr>(sys.spawn(dummy_impl));
+  }
+
+  // Resolves `x` from the cache of `mm` and returns the error, if any.
+  template <class Handle>
+  error resolve(net::middleman& mm, const uri& x) {
+    error result;
+    mm.remote_actor_async<Handle>(x, [&result](expected<Handle> hdl) {
+      if (!hdl)
+        result = std::move(hdl.error());
+    });
+    return result;
+  }
+
+  std::shared_ptr<remote_actor_cache> cache;
+
+  uri locator;
+
+  strong_actor_ptr dummy;
+
+  remote_actor_cache::time_point t0;
+};
+
+} // namespace
+
+CAF_TEST_FIXTURE_SCOPE(remote_actor_cache_tests, fixture)
+
+CAF_TEST(the cache returns stored entries until they expire) {
+  cache->put(locator, dummy, {"foo"}, t0);
+  if (auto hit = cache->get(locator, t0 + 500ms)) {
+    CAF_CHECK_EQUAL(hit->proxy, dummy);
+    CAF_CHECK_EQUAL(hit->ifs.size(), 1u);
+  } else {
+    CAF_FAIL("expected a cache hit");
+  }
+  CAF_CHECK(!cache->get(locator, t0 + 1s));
+  CAF_CHECK_EQUAL(cache->size(), 0u);
+}
+
+CAF_TEST(the cache drops entries when their actor terminates) {
+  cache->put(locator, dummy, {}, t0);
+  CAF_CHECK_EQUAL(cache->size(), 1u);
+  anon_send_exit(actor_cast<actor>(dummy), exit_reason::kill);
+  run();
+  CAF_CHECK_EQUAL(cache->size(), 0u);
+}
+
+CAF_TEST(a ttl of zero disables the cache) {
+  auto disabled = std::make_shared<remote_actor_cache>(timespan{0});
+  CAF_CHECK(!disabled->enabled());
+  disabled->put(locator, dummy, {}, t0);
+  CAF_CHECK(!disabled->get(locator, t0));
+}
+
+CAF_TEST(the middleman checks the interface of cached proxies) {
+  net::middleman mm{sys};
+  auto typed_locator = unbox(make_uri("tcp://node:1234/name/typed"));
+  mm.remote_actors().put(typed_locator, dummy,
+                         sys.message_types(detail::type_list<int_actor>{}));
+  auto other_locator = unbox(make_uri("tcp://node:1234/name/other"));
+  mm.remote_actors().put(other_locator, dummy, {"other"});
+  CAF_CHECK_EQUAL(resolve<int_actor>(mm, typed_locator), none);
+  CAF_CHECK_EQUAL(resolve<actor>(mm, typed_locator), none);
+  CAF_CHECK_EQUAL(resolve<actor>(mm, other_locator), none);
+  CAF_CHECK_EQUAL(resolve<int_actor>(mm, other_locator),
+                  sec::unexpected_actor_messaging_interface);
+}
+
+CAF_TEST(the middleman accepts proxies without a reported interface) {
+  net::middleman mm{sys};
+  mm.remote_actors().put(locator, dummy, {});
+  CAF_CHECK_EQUAL(resolve<actor>(mm, locator), none);
+  CAF_CHECK_EQUAL(resolve<int_actor>(mm, locator), none);
+}
+
+CAF_TEST(the cache attaches one functor per proxy) {
+  auto other_locator = unbox(make_uri("tcp://node:1234/name/bar"));
+  for (int i = 0; i < 3; ++i) {
+    cache->put(locator, dummy, {}, t0);
+    cache->put(other_locator, dummy, {}, t0);
+  }
+  CAF_CHECK_EQUAL(cache->size(), 2u);
+  CAF_CHECK_EQUAL(cache->num_attached(), 1u);
+  anon_send_exit(actor_cast<actor>(dummy), exit_reason::kill);
+  run();
+  CAF_CHECK_EQUAL(cache->size(), 0u);
+  CAF_CHECK_EQUAL(cache->num_attached(), 0u);
+}
+
+CAF_TEST_FIXTURE_SCOPE_END()
@@ -0,0 +1,160 @@
+// This file is part of CAF, the C++ Actor Framework. See the file LICENSE in
+// the main distribution directory for license terms and copyright or visit
+// https://github.com/actor-framework/actor-framework/blob/master/LICENSE.
+
+#define CAF_SUITE net.resolver
+
+#include "caf/net/resolver.hpp"
+
+#include "caf/test/dsl.hpp"
+
+#include <atomic>
+#include <future>
+#include <memory>
+
+#include "caf/ipv4_address.hpp"
+
+using namespace caf;
+using namespace caf::net;
+using namespace std::literals::chrono_literals;
+
+namespace {
+
+struct fixture {
+  fixture() : localhost(make_ipv4_address(127, 0, 0, 1)), lookups(0) {
+    release_future = release.get_future().share();
+  }
+
+  /// Resolves "localhost" to 127.0.0.1 and everything else to nothing.
+  resolver::lookup_function stub() {
+    return [this](const std::string& host) {
+      ++lookups;
+      resolver::address_list result;
+      if (host == "localhost")
+        result.emplace_back(localhost);
+      return result;
+    };
+  }
+
+  /// Like `stub`, but waits for `release` before returning.
+  resolver::lookup_function blocking_stub() {
+    return [this, f{stub()}](const std::string& host) {
+      release_future.wait();
+      return f(host);
+    };
+  }
+
+  ip_address localhost;
+
+  std::atomic<size_t> lookups;
+
+  std::promise<void> release;
+
+  std::shared_future<void> release_future;
+};
+
+} // namespace
+
+CAF_TEST_FIXTURE_SCOPE(resolver_tests, fixture)
+
+CAF_TEST(the resolver caches results until they expire) {
+  resolver dns{stub(), 1s, 1s};
+  auto addrs = dns.resolve("localhost");
+  if (CAF_CHECK_EQUAL(addrs.size(), 1u))
+    CAF_CHECK_EQUAL(addrs.front(), localhost);
+  CAF_CHECK_EQUAL(dns.resolve("localhost"), addrs);
+  CAF_CHECK_EQUAL(lookups.load(), 1u);
+  auto later = resolver::clock_type::now() + 2s;
+  CAF_CHECK(!dns.cached("localhost", later));
+  CAF_CHECK_EQUAL(dns.size(), 0u);
+}
+
+CAF_TEST(the resolver caches failed lookups) {
+  resolver dns{stub(), 1s, 1s};
+  CAF_CHECK(dns.resolve("unknown").empty());
+  CAF_CHECK(dns.resolve("unknown").empty());
+  CAF_CHECK_EQUAL(lookups.load(), 1u);
+  if (auto hit = dns.cached("unknown"))
+    CAF_CHECK(hit->empty());
+  else
+    CAF_FAIL("expected a cache hit");
+}
+
+CAF_TEST(disabling the negative TTL disables caching failed lookups) {
+  resolver dns{stub(), 1s, timespan{0}};
+  CAF_CHECK(dns.resolve("unknown").empty());
+  CAF_CHECK(dns.resolve("unknown").empty());
+  CAF_CHECK_EQUAL(lookups.load(), 2u);
+}
+
+CAF_TEST(concurrent requests for the same host share one lookup) {
+  resolver dns{blocking_stub()};
+  dns.start();
+  std::promise<resolver::address_list> first;
+  std::promise<resolver::address_list> second;
+  dns.async_resolve("localhost", [&first](const resolver::address_list& xs) {
+    first.set_value(xs);
+  });
+  dns.async_resolve("localhost", [&second](const resolver::address_list& xs) {
+    second.set_value(xs);
+  });
+  release.set_value();
+  CAF_CHECK_EQUAL(first.get_future().get().size(), 1u);
+  CAF_CHECK_EQUAL(second.get_future().get().size(), 1u);
+  CAF_CHECK_EQUAL(lookups.load(), 1u);
+  dns.stop();
+}
+
+CAF_TEST(replacing the lookup function drops all cached results) {
+  resolver dns{stub()};
+  dns.resolve("localhost");
+  CAF_CHECK_EQUAL(dns.size(), 1u);
+  dns.set_lookup_function([](const std::string&) {
+    return resolver::address_list{};
+  });
+  CAF_CHECK_EQUAL(dns.size(), 0u);
+  CAF_CHECK(dns.resolve("localhost").empty());
+}
+
+CAF_TEST(lookups after stopping the resolver fail immediately) {
+  resolver dns{stub()};
+  dns.start();
+  CAF_CHECK_EQUAL(dns.resolve("localhost").size(), 1u);
+  dns.stop();
+  CAF_CHECK(dns.stopped());
+  CAF_CHECK(dns.resolve("localhost").empty());
+  CAF_CHECK(dns.resolve("other").empty());
+  CAF_CHECK_EQUAL(lookups.load(), 1u);
+}
+
+CAF_TEST(stopping the resolver does not wait for blocked lookups) {
+  auto gate = std::make_shared<std::promise<void>>();
+  auto entered = std::make_shared<std::promise<void>>();
+  auto done = std::make_shared<std::promise<void>>();
+  auto entered_future = entered->get_future();
+  auto done_future = done->get_future();
+  auto lookup = [gate_future{gate->get_future().share()}, entered,
+                 done](const std::string&) {
+    entered->set_value();
+    gate_future.wait();
+    done->set_value();
+    return resolver::address_list{};
+  };
+  {
+    resolver dns{lookup};
+    dns.start();
+    std::promise<size_t> result;
+    dns.async_resolve("localhost", [&result](const resolver::address_list& xs) {
+      result.set_value(xs.size());
+    });
+    entered_future.wait();
+    dns.stop();
+    CAF_CHECK(!dns.running());
+    CAF_CHECK_EQUAL(result.get_future().get(), 0u);
+  }
+  // The thread outlives the resolver and terminates once the lookup returns.
+  gate->set_value();
+  done_future.wait();
+}
+
+CAF_TEST_FIXTURE_SCOPE_END()
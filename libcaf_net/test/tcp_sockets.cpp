@@ -10,6 +10,9 @@
 #include "caf/net/test/host_fixture.hpp"
 #include "caf/test/dsl.hpp"
 
+#include "caf/ip_address.hpp"
+#include "caf/ip_endpoint.hpp"
+#include "caf/ipv4_address.hpp"
 #include "caf/net/socket_guard.hpp"
 
 using namespace caf;
@@ -62,4 +65,16 @@ CAF_TEST(tcp connect) {
   CAF_MESSAGE("connected");
 }
 
+CAF_TEST(nonblocking tcp connect) {
+  auto acceptor = unbox(make_tcp_accept_socket(auth, false));
+  auto port = unbox(local_port(acceptor));
+  auto acceptor_guard = make_socket_guard(acceptor);
+  ip_endpoint dst{ip_address{make_ipv4_address(127, 0, 0, 1)}, port};
+  auto conn = unbox(make_connecting_tcp_stream_socket(dst));
+  auto conn_guard = make_socket_guard(conn);
+  auto accepted = unbox(accept(acceptor));
+  auto accepted_guard = make_socket_guard(accepted);
+  CAF_CHECK_EQUAL(connect_result(conn), none);
+}
+
 CAF_TEST_FIXTURE_SCOPE_END()
@@ -41,6 +41,8 @@ struct dummy_actor : public monitorable_actor {
 
 class dummy_application {
 public:
+  static constexpr bool handshake_free = true;
+
   dummy_application(byte_buffer_ptr rec_buf, uint8_t id)
     : rec_buf_(std::move(rec_buf)),
       id_(id){
@@ -89,6 +91,11 @@ private:
   uint8_t id_;
 };
 
+/// Lacks the `handshake_free` flag, like `basp::application`.
+struct handshake_application {
+  // nop
+};
+
 struct dummy_application_factory {
 public:
   using application_type = dummy_application;
@@ -119,8 +126,8 @@ struct dummy_transport {
     // nop
   }
 
-  template <class IdType>
-  void write_packet(IdType, span<byte_buffer*> buffers) {
+  void write_packet(ip_endpoint id, span<byte_buffer*> buffers) {
+    last_receiver = id;
     for (auto buf : buffers)
       buf_->insert(buf_->end(), buf->begin(), buf->end());
   }
@@ -141,6 +148,8 @@ struct dummy_transport {
     return {};
   }
 
+  ip_endpoint last_receiver;
+
 private:
   actor_system& sys_;
   byte_buffer_ptr buf_;
@@ -277,6 +286,27 @@ CAF_TEST(handle_data) {
   CHECK_HANDLE_DATA(test_data.at(3));
 }
 
+CAF_TEST(bursts and alternating peers reach the right workers) {
+  // Exercises the cache for the most recent sender: repeated lookups hit the
+  // cache, switching peers must never return the previous worker.
+  for (auto i : {0, 0, 0, 1, 1, 0, 3, 3, 2, 0}) {
+    CHECK_HANDLE_DATA(test_data.at(i));
+  }
+}
+
+CAF_TEST(datagrams from unknown peers create new workers) {
+  testdata unknown{4, node_id{}, "[::1]:4242"_ep};
+  CAF_CHECK_EQUAL(dispatcher.handle_data(dummy, span<const byte>{},
+                                         unknown.ep),
+                  none);
+  // The new worker receives the datagram right after initializing.
+  CAF_CHECK_EQUAL(*buf, byte_buffer({byte{4}, byte{4}}));
+  buf->clear();
+  CHECK_HANDLE_DATA(test_data.at(0));
+  CHECK_HANDLE_DATA(unknown);
+  CHECK_HANDLE_DATA(unknown);
+}
+
 CAF_TEST(write_message write_packet) {
   CHECK_WRITE_MESSAGE(test_data.at(0));
   CHECK_WRITE_MESSAGE(test_data.at(1));
@@ -284,6 +314,23 @@ CAF_TEST(write_message write_packet) {
   CHECK_WRITE_MESSAGE(test_data.at(3));
 }
 
+CAF_TEST(only handshake-free applications qualify for group workers) {
+  static_assert(is_handshake_free_v<dummy_application>);
+  static_assert(!is_handshake_free_v<handshake_application>);
+}
+
+CAF_TEST(group workers send messages for their node to the group) {
+  testdata group{4, make_node_id("http:group"_u), "[ff02::1]:4242"_ep};
+  auto worker = dispatcher.add_group_worker(dummy, group.nid, group.ep);
+  CAF_REQUIRE(worker);
+  CAF_CHECK_EQUAL((*worker)->id(), group.ep);
+  buf->clear();
+  CHECK_WRITE_MESSAGE(group);
+  CAF_CHECK_EQUAL(dummy.last_receiver, group.ep);
+  CHECK_WRITE_MESSAGE(test_data.at(1));
+  CAF_CHECK_EQUAL(dummy.last_receiver, test_data.at(1).ep);
+}
+
 CAF_TEST(resolve) {
   // TODO think of a test for this
 }
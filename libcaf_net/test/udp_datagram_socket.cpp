@@ -12,11 +12,13 @@
 #include "caf/binary_serializer.hpp"
 #include "caf/byte_buffer.hpp"
 #include "caf/detail/net_syscall.hpp"
+#include "caf/detail/socket_sys_aliases.hpp"
 #include "caf/detail/socket_sys_includes.hpp"
 #include "caf/ip_address.hpp"
 #include "caf/ip_endpoint.hpp"
 #include "caf/ipv4_address.hpp"
 #include "caf/net/ip.hpp"
+#include "caf/net/socket_guard.hpp"
 
 using namespace caf;
 using namespace caf::net;
@@ -143,4 +145,153 @@ CAF_TEST(read / write using span<byte_buffer*>) {
   CAF_CHECK_EQUAL(received, hello_test);
 }
 
+CAF_TEST(read / write using batches) {
+  if (auto err = nonblocking(socket_cast<net::socket>(receive_socket), true))
+    CAF_FAIL("setting socket to nonblocking failed: " << err);
+  std::vector<udp_datagram_slot> slots(4);
+  for (auto& slot : slots)
+    slot.buf.resize(1024);
+  auto read_res = read_batch(receive_socket, make_span(slots));
+  if (CAF_CHECK(holds_alternative<sec>(read_res)))
+    CAF_CHECK(get<sec>(read_res) == sec::unavailable_or_would_block);
+  auto bytes = as_bytes(make_span(hello_test));
+  byte_buffer first(bytes.begin(), bytes.end());
+  byte_buffer second(bytes.begin(), bytes.begin() + 5);
+  byte_buffer* first_bufs[] = {&first};
+  byte_buffer* second_bufs[] = {&second};
+  udp_datagram_view views[] = {{make_span(first_bufs, 1), ep},
+                               {make_span(second_bufs, 1), ep}};
+  auto write_res = write_batch(send_socket,
+                               span<const udp_datagram_view>{views, 2});
+  if (CAF_CHECK(holds_alternative<size_t>(write_res)))
+    CAF_CHECK_EQUAL(get<size_t>(write_res), 2u);
+  size_t received = 0;
+  for (size_t attempt = 0; received < 2 && attempt < 100; ++attempt) {
+    auto res = read_batch(receive_socket,
+                          make_span(slots.data() + received,
+                                    slots.size() - received));
+    if (auto num_datagrams = get_if<size_t>(&res))
+      received += *num_datagrams;
+    else if (get<sec>(res) != sec::unavailable_or_would_block)
+      CAF_FAIL("read_batch failed: " << get<sec>(res));
+  }
+  CAF_REQUIRE_EQUAL(received, 2u);
+  CAF_CHECK_EQUAL(slots[0].size, hello_test.size());
+  CAF_CHECK_EQUAL(slots[1].size, 5u);
+  CAF_CHECK_EQUAL(slots[0].buf.size(), 1024u);
+  string_view received_str{reinterpret_cast<const char*>(slots[0].buf.data()),
+                           slots[0].size};
+  CAF_CHECK_EQUAL(received_str, hello_test);
+}
+
+CAF_TEST(read / write using segmentation offload) {
+  if (!enable_udp_offload(send_socket).gso) {
+    CAF_MESSAGE("the kernel lacks UDP_SEGMENT, skip test");
+    return;
+  }
+  enable_udp_offload(receive_socket);
+  if (auto err = nonblocking(socket_cast<net::socket>(receive_socket), true))
+    CAF_FAIL("setting socket to nonblocking failed: " << err);
+  // Three datagrams with 100 bytes each plus a shorter one with 50 bytes.
+  byte_buffer payload(350);
+  for (size_t i = 0; i < payload.size(); ++i)
+    payload[i] = static_cast<byte>(i / 100);
+  byte_buffer* bufs[] = {&payload};
+  auto write_res = write_segmented(send_socket, make_span(bufs, 1), 100, ep);
+  if (CAF_CHECK(holds_alternative<size_t>(write_res)))
+    CAF_CHECK_EQUAL(get<size_t>(write_res), payload.size());
+  // Depending on GRO support, we receive one coalesced buffer or four
+  // individual datagrams.
+  std::vector<udp_datagram_slot> slots(4);
+  for (auto& slot : slots)
+    slot.buf.resize(1024);
+  std::vector<byte_buffer> datagrams;
+  auto collect = [&datagrams](span<byte> bytes) {
+    datagrams.emplace_back(bytes.begin(), bytes.end());
+    return error{};
+  };
+  for (size_t attempt = 0; datagrams.size() < 4 && attempt < 100; ++attempt) {
+    auto res = read_batch(receive_socket, make_span(slots));
+    if (auto num_slots = get_if<size_t>(&res)) {
+      for (size_t i = 0; i < *num_slots; ++i)
+        for_each_datagram(slots[i], collect);
+    } else if (get<sec>(res) != sec::unavailable_or_would_block) {
+      CAF_FAIL("read_batch failed: " << get<sec>(res));
+    }
+  }
+  CAF_REQUIRE_EQUAL(datagrams.size(), 4u);
+  for (size_t i = 0; i < 3; ++i)
+    CAF_CHECK_EQUAL(datagrams[i], byte_buffer(100, static_cast<byte>(i)));
+  CAF_CHECK_EQUAL(datagrams[3], byte_buffer(50, static_cast<byte>(3)));
+}
+
+CAF_TEST(multicast groups deliver datagrams to all members) {
+  ip_address group{make_ipv4_address(239, 255, 42, 1)};
+  ip_endpoint any{ip_address{make_ipv4_address(0, 0, 0, 0)}, 0};
+  // Two members share the same port via SO_REUSEADDR.
+  auto first_pair = unbox(make_udp_datagram_socket(any, true));
+  auto first = make_socket_guard(first_pair.first);
+  any.port(first_pair.second);
+  auto second = make_socket_guard(
+    unbox(make_udp_datagram_socket(any, true)).first);
+  any.port(0);
+  auto sender = make_socket_guard(unbox(make_udp_datagram_socket(any)).first);
+  if (auto err = join_multicast_group(first.socket(), group)) {
+    CAF_MESSAGE("unable to join multicast group, skip test: " << err);
+    return;
+  }
+  CAF_CHECK_EQUAL(join_multicast_group(second.socket(), group), none);
+  CAF_CHECK_EQUAL(multicast_ttl(sender.socket(), 1), none);
+  CAF_CHECK_EQUAL(multicast_loopback(sender.socket(), true), none);
+  ip_endpoint group_ep{group, first_pair.second};
+  auto write_res = write(sender.socket(), as_bytes(make_span(hello_test)),
+                         group_ep);
+  if (!holds_alternative<size_t>(write_res)) {
+    CAF_MESSAGE("no route for multicast traffic, skip test");
+    return;
+  }
+  // A single write reaches both members.
+  for (auto member : {first.socket(), second.socket()}) {
+    buf.resize(1024);
+    CAF_CHECK_EQUAL(read_from_socket(member, buf), none);
+    string_view received{reinterpret_cast<const char*>(buf.data()),
+                         buf.size()};
+    CAF_CHECK_EQUAL(received, hello_test);
+  }
+  CAF_CHECK_EQUAL(leave_multicast_group(first.socket(), group), none);
+  ip_address unicast{make_ipv4_address(127, 0, 0, 1)};
+  CAF_CHECK_NOT_EQUAL(join_multicast_group(first.socket(), unicast), none);
+}
+
+CAF_TEST(dual-stack sockets apply multicast options to both families) {
+  ip_endpoint any{ip_address{}, 0};
+  auto res = make_udp_datagram_socket(any);
+  if (!res) {
+    CAF_MESSAGE("unable to create an IPv6 socket, skip test: " << res.error());
+    return;
+  }
+  auto sock = make_socket_guard(res->first);
+  auto get_option = [&](int level, int name) {
+    int value = 0;
+    socklen_t len = sizeof(value);
+    if (getsockopt(sock.socket().id, level, name,
+                   reinterpret_cast<getsockopt_ptr>(&value), &len)
+        != 0)
+      CAF_FAIL("getsockopt failed");
+    // IPv4 options may use a single Byte.
+    return len == 1 ? static_cast<int>(*reinterpret_cast<uint8_t*>(&value))
+                    : value;
+  };
+  CAF_CHECK_EQUAL(multicast_ttl(sock.socket(), 3), none);
+  CAF_CHECK_EQUAL(multicast_loopback(sock.socket(), false), none);
+  CAF_CHECK_EQUAL(get_option(IPPROTO_IPV6, IPV6_MULTICAST_HOPS), 3);
+  CAF_CHECK_EQUAL(get_option(IPPROTO_IPV6, IPV6_MULTICAST_LOOP), 0);
+  if (get_option(IPPROTO_IPV6, IPV6_V6ONLY) != 0) {
+    CAF_MESSAGE("socket only accepts IPv6 traffic, skip IPv4 options");
+    return;
+  }
+  CAF_CHECK_EQUAL(get_option(IPPROTO_IP, IP_MULTICAST_TTL), 3);
+  CAF_CHECK_EQUAL(get_option(IPPROTO_IP, IP_MULTICAST_LOOP), 0);
+}
+
 CAF_TEST_FIXTURE_SCOPE_END()